@@ -0,0 +1,102 @@
+#include "AdmissionControl.h"
+#include "Executor.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+TokenBucketTable::TokenBucketTable(uint32_t rate, uint32_t burst, size_t slotCount)
+    : ratePerSecond(rate), burstMilli(std::min<uint32_t>(std::max<uint32_t>(burst, 1), 16000) * 1000) {
+    size_t size = 1;
+    while (size < slotCount) size <<= 1;
+    slots.reset(new std::atomic<uint64_t>[size]);
+    for (size_t i = 0; i < size; ++i) slots[i].store(0, std::memory_order_relaxed);
+    mask = size - 1;
+}
+
+bool TokenBucketTable::tryTake(uint64_t keyHash, uint64_t nowMs, uint32_t& retryAfterMs) {
+    retryAfterMs = 0;
+    if (ratePerSecond == 0) return true; // rate 0 disables the limit
+    std::atomic<uint64_t>& slot = slots[keyHash & mask];
+    uint64_t old = slot.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t last = old == 0 ? nowMs : old >> BALANCE_BITS;
+        uint64_t balance = old == 0 ? burstMilli : old & BALANCE_MASK;
+        if (nowMs > last) {
+            uint64_t elapsed = nowMs - last;
+            uint64_t refill = elapsed >= burstMilli ? burstMilli : elapsed * ratePerSecond;
+            balance = std::min<uint64_t>(burstMilli, balance + refill);
+            last = nowMs;
+        }
+        if (balance < 1000) {
+            retryAfterMs = static_cast<uint32_t>((1000 - balance + ratePerSecond - 1) / ratePerSecond);
+            return false;
+        }
+        uint64_t next = (last << BALANCE_BITS) | (balance - 1000);
+        if (slot.compare_exchange_weak(old, next, std::memory_order_relaxed)) return true;
+    }
+}
+
+AdmissionControl::AdmissionControl(const Limits& configured)
+    : limits(configured),
+      users(configured.userRate, configured.userBurst),
+      ips(configured.ipRate, configured.ipBurst),
+      epoch(std::chrono::steady_clock::now()) {}
+
+AdmissionControl::RouteClass AdmissionControl::classify(std::string_view method, std::string_view path) {
+    if (path.substr(0, 6) == "/auth/") return RouteClass::AUTH;
+    if (method == "GET" || method == "HEAD") return RouteClass::POLL;
+    return RouteClass::WRITE;
+}
+
+std::string_view AdmissionControl::bearerToken(std::string_view authorization) {
+    if (authorization.substr(0, 7) != "Bearer ") return {};
+    authorization.remove_prefix(7);
+    while (!authorization.empty() && authorization.front() == ' ') authorization.remove_prefix(1);
+    return authorization;
+}
+
+AdmissionControl::Decision AdmissionControl::admit(RouteClass routeClass, std::string_view user,
+                                                   std::string_view clientIP) {
+    Decision decision;
+    size_t cls = static_cast<size_t>(routeClass);
+
+    // Shed polls first: they are cheap to retry and should not spend a token
+    if (routeClass == RouteClass::POLL && dbPool && limits.shedPollsAtDbQueue > 0 &&
+        dbPool->queueDepth() > limits.shedPollsAtDbQueue) {
+        overloadedCount.fetch_add(1, std::memory_order_relaxed);
+        decision.verdict = Verdict::OVERLOADED;
+        decision.retryAfterSeconds = 2;
+        return decision;
+    }
+
+    uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - epoch).count()) + 1;
+    uint32_t waitMs = 0;
+    std::hash<std::string_view> hash;
+    if ((!user.empty() && !users.tryTake(hash(user), nowMs, waitMs)) ||
+        (!clientIP.empty() && !ips.tryTake(hash(clientIP), nowMs, waitMs))) {
+        rateLimitedCount.fetch_add(1, std::memory_order_relaxed);
+        decision.verdict = Verdict::RATE_LIMITED;
+        decision.retryAfterSeconds = std::max<uint32_t>(1, (waitMs + 999) / 1000);
+        return decision;
+    }
+
+    size_t cap = limits.maxInFlight[cls];
+    if (cap > 0 && inFlight[cls].fetch_add(1, std::memory_order_relaxed) >= cap) {
+        inFlight[cls].fetch_sub(1, std::memory_order_relaxed);
+        overloadedCount.fetch_add(1, std::memory_order_relaxed);
+        decision.verdict = Verdict::OVERLOADED;
+        decision.retryAfterSeconds = 1;
+        return decision;
+    }
+    if (cap == 0) inFlight[cls].fetch_add(1, std::memory_order_relaxed);
+    return decision;
+}
+
+void AdmissionControl::release(RouteClass routeClass) {
+    inFlight[static_cast<size_t>(routeClass)].fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t AdmissionControl::inFlightCount(RouteClass routeClass) const {
+    return inFlight[static_cast<size_t>(routeClass)].load(std::memory_order_relaxed);
+}
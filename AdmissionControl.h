@@ -0,0 +1,99 @@
+#ifndef ADMISSIONCONTROL_H
+#define ADMISSIONCONTROL_H
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+class Executor;
+
+// Token buckets for many keys in a fixed table of atomic slots, indexed by
+// key hash. Each slot packs the last refill time (ms, high 40 bits) and the
+// balance in thousandths of a token (low 24 bits), so taking a token is one
+// compare-and-swap with no lock and no allocation. Keys that hash to the
+// same slot share a bucket; with the default table size that is rare and
+// only ever makes the limit stricter.
+class TokenBucketTable {
+private:
+    static constexpr uint64_t BALANCE_BITS = 24;
+    static constexpr uint64_t BALANCE_MASK = (uint64_t(1) << BALANCE_BITS) - 1;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots; // 0 = never used
+    size_t mask;
+    uint32_t ratePerSecond; // also thousandths of a token per ms
+    uint32_t burstMilli;
+
+public:
+    // `slots` is rounded up to a power of two; burst is capped at 16000 tokens
+    TokenBucketTable(uint32_t ratePerSecond, uint32_t burst, size_t slots = 65536);
+
+    // Takes one token from `keyHash`'s bucket at `nowMs` (must be > 0). On
+    // refusal, retryAfterMs is how long until a token is available.
+    bool tryTake(uint64_t keyHash, uint64_t nowMs, uint32_t& retryAfterMs);
+};
+
+// Admission decisions for the HTTP front door, checked before a request
+// reaches a handler:
+//  - per-user and per-IP token buckets (429)
+//  - a cap on in-flight requests per route class (503)
+//  - polls shed while the DB executor queue is deeper than a threshold (503)
+// Writes are never shed for queue depth here; respondAsync still refuses
+// them with 503 once the queue is actually full.
+class AdmissionControl {
+public:
+    enum class RouteClass { AUTH = 0, WRITE = 1, POLL = 2 };
+    static constexpr int ROUTE_CLASSES = 3;
+
+    enum class Verdict { ADMIT, RATE_LIMITED, OVERLOADED };
+
+    struct Limits {
+        uint32_t userRate = 10;  // tokens per second, per user
+        uint32_t userBurst = 20;
+        uint32_t ipRate = 200;   // per client address; loose, campus NATs share one
+        uint32_t ipBurst = 400;
+        std::array<size_t, ROUTE_CLASSES> maxInFlight{{32, 64, 256}}; // AUTH, WRITE, POLL
+        size_t shedPollsAtDbQueue = 256;
+    };
+
+    struct Decision {
+        Verdict verdict = Verdict::ADMIT;
+        uint32_t retryAfterSeconds = 0;
+    };
+
+private:
+    Limits limits;
+    TokenBucketTable users;
+    TokenBucketTable ips;
+    const Executor* dbPool = nullptr;
+    std::chrono::steady_clock::time_point epoch;
+    std::array<std::atomic<size_t>, ROUTE_CLASSES> inFlight{};
+    std::atomic<uint64_t> rateLimitedCount{0};
+    std::atomic<uint64_t> overloadedCount{0};
+
+public:
+    explicit AdmissionControl(const Limits& configured);
+
+    void setDbPool(const Executor* pool) { dbPool = pool; }
+
+    static RouteClass classify(std::string_view method, std::string_view path);
+    // The token of an "Authorization: Bearer <token>" header, else empty.
+    // Only a token the server has validated may be used as the user key.
+    static std::string_view bearerToken(std::string_view authorization);
+
+    // `user` must be a verified user ID (empty: per-IP limit only).
+    // An ADMIT decision holds an in-flight slot of `routeClass`; hand it back
+    // with release() when the response is complete
+    Decision admit(RouteClass routeClass, std::string_view user, std::string_view clientIP);
+    void release(RouteClass routeClass);
+
+    size_t inFlightCount(RouteClass routeClass) const;
+    uint64_t rateLimited() const { return rateLimitedCount.load(std::memory_order_relaxed); }
+    uint64_t overloaded() const { return overloadedCount.load(std::memory_order_relaxed); }
+};
+
+#endif // ADMISSIONCONTROL_H
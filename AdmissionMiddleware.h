@@ -0,0 +1,59 @@
+#ifndef ADMISSIONMIDDLEWARE_H
+#define ADMISSIONMIDDLEWARE_H
+
+#pragma once
+#include <memory>
+#include <string>
+#include "AdmissionControl.h"
+#include "AuthSys.h"
+#include "crow.h"
+
+// Runs AdmissionControl in front of every route. A refused request is
+// answered here with 429 (rate limited) or 503 (overloaded) and a
+// Retry-After, so the handler and the DB never see it. An admitted request
+// holds its route class's in-flight slot until the response completes, which
+// for respondAsync handlers is when the worker ends it. The slot is owned by
+// the request context, so it is also handed back if the connection goes
+// away without the response ever being ended.
+// Set `admission` and `auth` before app.run(); requests pass through while
+// `admission` is null, and only per-IP limits apply while `auth` is null.
+struct AdmissionMiddleware {
+    struct context {
+        std::shared_ptr<void> slot; // releases the in-flight slot when dropped
+    };
+
+    AdmissionControl* admission = nullptr;
+    AuthSystem* auth = nullptr; // resolves bearer tokens to users
+
+    void before_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!admission || req.method == "OPTIONS"_method) return;
+        std::string path = req.url;
+        if (path == "/" || path == "/metrics") return;
+
+        auto routeClass = AdmissionControl::classify(crow::method_name(req.method), path);
+        // Per-user limits key on the session the token belongs to; a missing,
+        // made-up or expired token gets the per-IP limit only
+        std::string userID;
+        std::string authorization = req.get_header_value("Authorization");
+        std::string_view token = AdmissionControl::bearerToken(authorization);
+        if (!token.empty() && auth) auth->validateSessionToken(std::string(token), userID);
+        auto decision = admission->admit(routeClass, userID, req.remote_ip_address);
+        if (decision.verdict == AdmissionControl::Verdict::ADMIT) {
+            AdmissionControl* control = admission;
+            ctx.slot = std::shared_ptr<void>(nullptr, [control, routeClass](void*) { control->release(routeClass); });
+            return;
+        }
+
+        bool limited = decision.verdict == AdmissionControl::Verdict::RATE_LIMITED;
+        res.code = limited ? 429 : 503;
+        res.set_header("Retry-After", std::to_string(decision.retryAfterSeconds));
+        res.body = limited ? "Too many requests, retry later" : "Server busy, retry shortly";
+        res.end();
+    }
+
+    void after_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        ctx.slot.reset();
+    }
+};
+
+#endif // ADMISSIONMIDDLEWARE_H
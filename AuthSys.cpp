@@ -1,11 +1,38 @@
 #include "AuthSys.h"
+#include "Logger.h"
+#include "Tracer.h"
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <cstdlib>
 #include <curl/curl.h>
 
-AuthSystem::AuthSystem(std::shared_ptr<DatabaseManager> db) : dbManager(db) {}
+// True for http(s) URLs whose host is 127.0.0.1, localhost or [::1]
+static bool isLoopbackURL(const std::string& url) {
+    std::string rest;
+    if (url.compare(0, 7, "http://") == 0) rest = url.substr(7);
+    else if (url.compare(0, 8, "https://") == 0) rest = url.substr(8);
+    else return false;
+    std::string host = rest.substr(0, rest.find_first_of(":/?"));
+    if (rest.compare(0, 5, "[::1]") == 0) host = "[::1]";
+    return host == "127.0.0.1" || host == "localhost" || host == "[::1]";
+}
+
+AuthSystem::AuthSystem(std::shared_ptr<DatabaseManager> db)
+    : dbManager(db), tokenInfoURL("https://oauth2.googleapis.com/tokeninfo") {
+    // The override decides who may log in as whom, so it only ever points at
+    // a local stub (the loadgen one) and is loud about it
+    if (const char* url = std::getenv("UNIRIDE_TOKENINFO_URL")) {
+        if (isLoopbackURL(url)) {
+            tokenInfoURL = url;
+            LOG_WARN("UNIRIDE_TOKENINFO_URL is set: Google sign-in is verified by " << tokenInfoURL
+                     << " instead of Google. Use this for load testing only");
+        } else {
+            LOG_ERROR("Ignoring UNIRIDE_TOKENINFO_URL=" << url << ": only loopback URLs are accepted");
+        }
+    }
+}
 
 
 
@@ -21,19 +48,24 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::stri
 }
 
 crow::json::rvalue AuthSystem::verifyGoogleToken(const std::string& idToken) {
+    TRACE_SPAN("auth.verifyGoogleToken", "auth");
     CURL* curl;
     CURLcode res;
     std::string readBuffer;
     
     curl = curl_easy_init();
     if(curl) {
-        std::string url = "https://oauth2.googleapis.com/tokeninfo?id_token=" + idToken;
+        std::string url = tokenInfoURL + "?id_token=" + idToken;
         
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
         curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
         curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 2L);
+        // Bound how long one token check can hold an auth worker; NOSIGNAL
+        // keeps the timeout from using signals in a multithreaded process
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
         
         res = curl_easy_perform(curl);
         curl_easy_cleanup(curl);
@@ -50,9 +82,9 @@ crow::json::rvalue AuthSystem::verifyGoogleToken(const std::string& idToken) {
     return crow::json::load("{\"error\":\"Network error\"}");
 }
 
+// Runs on the auth executor. No lock: mtx only guards sessionTokens, and
+// holding it across the HTTPS call would serialize every login.
 User AuthSystem::handleGoogleAuth(const std::string& idToken, const std::string& enrollmentId) {
-    std::lock_guard<std::mutex> lock(mtx);
-    
     crow::json::rvalue tokenInfo = verifyGoogleToken(idToken);
     
     if (tokenInfo.has("error")) {
@@ -73,13 +105,12 @@ User AuthSystem::handleGoogleAuth(const std::string& idToken, const std::string&
         return existingUser;
     }
     
+    // A concurrent first login for the same email may win the insert; either
+    // way the row now exists (or the insert genuinely failed and this is empty)
     User newUser(sub, name, email);
     newUser.enrollment_id = enrollmentId;
-    if (dbManager->insertUser(newUser)) {
-        return dbManager->getUserByEmail(email);
-    }
-    
-    return User();
+    dbManager->insertUser(newUser);
+    return dbManager->getUserByEmail(email);
 }
 
 std::string AuthSystem::generateSessionToken() {
@@ -111,6 +142,11 @@ bool AuthSystem::validateSessionToken(const std::string& token, std::string& use
     return false;
 }
 
+size_t AuthSystem::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sessionTokens.size();
+}
+
 std::string AuthSystem::generateJWT(const User& user) {
     // Simplified JWT generation - in production use proper JWT library
     std::string header = "{\"alg\":\"HS256\",\"typ\":\"JWT\"}";
@@ -15,6 +15,7 @@ private:
     mutable std::mutex mtx;
     std::shared_ptr<DatabaseManager> dbManager;
     std::unordered_map<std::string, std::string> sessionTokens; // token -> userID
+    std::string tokenInfoURL; // Google tokeninfo, or a loopback UNIRIDE_TOKENINFO_URL (the loadgen stub)
     
     std::string generateJWT(const User& user);
     bool validateJWT(const std::string& token, std::string& userID);
@@ -29,6 +30,7 @@ public:
     User handleGoogleAuth(const std::string& idToken, const std::string& enrollmentId);
     std::string storeSessionToken(const std::string& userID);
     bool validateSessionToken(const std::string& token, std::string& userID);
+    size_t sessionCount() const;
     crow::json::wvalue toJson() const;
 };
 #endif // AUTHSYS_H
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "ChatFeature.h"
+#include "Tracer.h"
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 
@@ -21,12 +23,14 @@ std::string ChatFeature::getCurrentTime() const {
 bool ChatFeature::SetRideLead(int rideID, const std::string &leadUserID) {
     std::lock_guard<std::mutex> lock(mtx);
     rideLeads[rideID] = leadUserID;
+    if (versions) versions->bumpGlobal();
     return true;
 }
 
 // --- Add a chat message (hub-and-spoke model) ---
 bool ChatFeature::AddMessage(const std::string &sender, const std::string &recipient,
                              const std::string &text, int rideID, std::string &outErr) {
+    TRACE_SPAN("chat.AddMessage", "chat");
     std::lock_guard<std::mutex> lock(mtx);
 
     // Check if ride has a lead
@@ -45,11 +49,13 @@ bool ChatFeature::AddMessage(const std::string &sender, const std::string &recip
 
     Message m{sender, recipient, text, getCurrentTime(), rideID};
     rideChats[rideID].push_back(m);
+    if (versions) versions->bumpChat(rideID);
     return true;
 }
 
 // --- Get messages for a specific ride ---
 crow::json::wvalue ChatFeature::getRideMessagesJson(int rideID) const {
+    TRACE_SPAN("chat.getRideMessagesJson", "chat");
     crow::json::wvalue res;
     std::lock_guard<std::mutex> lock(mtx);
 
@@ -71,6 +77,26 @@ crow::json::wvalue ChatFeature::getRideMessagesJson(int rideID) const {
     return res;
 }
 
+// --- Stream messages for a specific ride into a JsonWriter ---
+void ChatFeature::writeRideMessagesJson(int rideID, JsonWriter &out) const {
+    TRACE_SPAN("chat.writeRideMessagesJson", "chat");
+    std::lock_guard<std::mutex> lock(mtx);
+
+    out.beginObject().key("messages").beginArray();
+    auto it = rideChats.find(rideID);
+    if (it != rideChats.end()) {
+        for (const auto &m : it->second) {
+            out.beginObject()
+                .field("sender", m.sender)
+                .field("recipient", m.recipient)
+                .field("text", m.text)
+                .field("timestamp", m.timestamp)
+                .endObject();
+        }
+    }
+    out.endArray().endObject();
+}
+
 // --- Legacy support: Convert all chat messages to JSON ---
 crow::json::wvalue ChatFeature::getMessagesJson() const {
     crow::json::wvalue res;
@@ -93,9 +119,43 @@ crow::json::wvalue ChatFeature::getMessagesJson() const {
 
 // --- Limit the number of stored messages ---
 void ChatFeature::limitMessages(size_t maxSize) {
+    TRACE_SPAN("chat.limitMessages", "chat");
     std::lock_guard<std::mutex> lock(mtx);
     for (auto &ridePair : rideChats) {
+        if (ridePair.second.size() <= maxSize) continue;
         while (ridePair.second.size() > maxSize)
             ridePair.second.pop_front();
+        if (versions) versions->bumpChat(ridePair.first);
+    }
+}
+
+size_t ChatFeature::channelCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return rideChats.size();
+}
+
+std::vector<int> ChatFeature::channelIDs() const {
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ids.reserve(rideLeads.size() + rideChats.size());
+        for (const auto &lead : rideLeads) ids.push_back(lead.first);
+        for (const auto &chat : rideChats) ids.push_back(chat.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+size_t ChatFeature::evictRides(const std::vector<int> &rideIDs) {
+    TRACE_SPAN("chat.evictRides", "chat");
+    std::lock_guard<std::mutex> lock(mtx);
+    size_t evicted = 0;
+    for (int rideID : rideIDs) {
+        rideLeads.erase(rideID);
+        if (rideChats.erase(rideID) == 0) continue;
+        ++evicted;
+        if (versions) versions->bumpChat(rideID);
     }
+    return evicted;
 }
@@ -5,7 +5,10 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "crow.h"
+#include "JsonWriter.h"
+#include "VersionRegistry.h"
 
 struct Message {
     std::string sender;
@@ -20,14 +23,21 @@ private:
     std::unordered_map<int, std::deque<Message>> rideChats; // rideID -> messages
     std::unordered_map<int, std::string> rideLeads; // rideID -> leadUserID
     mutable std::mutex mtx;
+    VersionRegistry* versions = nullptr;
     std::string getCurrentTime() const;
 
 public:
     ChatFeature();
+    void setVersionRegistry(VersionRegistry* registry) { versions = registry; }
     bool AddMessage(const std::string &sender, const std::string &recipient, const std::string &text, int rideID, std::string &outErr);
     bool SetRideLead(int rideID, const std::string &leadUserID);
     crow::json::wvalue getRideMessagesJson(int rideID) const;
+    void writeRideMessagesJson(int rideID, JsonWriter &out) const;
     crow::json::wvalue getMessagesJson() const; // Legacy support
     void limitMessages(size_t maxSize);
+    size_t channelCount() const;
+    std::vector<int> channelIDs() const; // rides with a chat or a lead set, ascending
+    // Drops the chats and leads of finished rides; returns how many chats went
+    size_t evictRides(const std::vector<int> &rideIDs);
 };
 #endif // CHATFEATURE_H
\ No newline at end of file
@@ -1,7 +1,17 @@
 #include "DatabaseManager.h"
-#include <iostream>
-
-DatabaseManager::DatabaseManager(const std::string& path) : db(nullptr), dbPath(path), locationGraph(nullptr) {}
+#include <algorithm>
+#include "MatchingEngine.h"
+#include "OpenRideTable.h"
+#include "RequestArena.h"
+#include "RideFragmentCache.h"
+#include "VersionRegistry.h"
+#include "SqlProfiler.h"
+#include "Logger.h"
+#include "Tracer.h"
+
+DatabaseManager::DatabaseManager(const std::string& path)
+    : db(nullptr), dbPath(path), locationGraph(nullptr), rideCache(nullptr), versions(nullptr), profiler(nullptr),
+      executor(nullptr), matcher(nullptr), openRides(nullptr) {}
 
 DatabaseManager::~DatabaseManager() {
     if (db) {
@@ -9,12 +19,90 @@ DatabaseManager::~DatabaseManager() {
     }
 }
 
+// Completed rides move here; live tables keep only current activity.
+// Same columns as the live tables, without AUTOINCREMENT: IDs are kept.
+bool DatabaseManager::attachArchive() {
+    if (archivePath.empty()) {
+        if (dbPath.empty() || dbPath == ":memory:") {
+            archivePath = ":memory:";
+        } else if (dbPath.size() > 3 && dbPath.compare(dbPath.size() - 3, 3, ".db") == 0) {
+            archivePath = dbPath.substr(0, dbPath.size() - 3) + "-archive.db";
+        } else {
+            archivePath = dbPath + "-archive";
+        }
+    }
+
+    sqlite3_stmt* stmt;
+    if (prepare("ATTACH DATABASE ? AS archive;", &stmt) != SQLITE_OK) return false;
+    sqlite3_bind_text(stmt, 1, archivePath.c_str(), -1, SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        LOG_ERROR("Can't attach archive database " << archivePath << ": " << sqlite3_errmsg(db));
+        return false;
+    }
+
+    const char* schema = R"(
+        CREATE TABLE IF NOT EXISTS archive.rides (
+            id INTEGER PRIMARY KEY,
+            owner_id TEXT,
+            from_location TEXT NOT NULL,
+            to_location TEXT NOT NULL,
+            time TEXT NOT NULL,
+            mode TEXT NOT NULL,
+            ride_type INTEGER NOT NULL DEFAULT 1,
+            ride_status TEXT DEFAULT 'completed',
+            current_capacity INTEGER NOT NULL DEFAULT 1,
+            max_capacity INTEGER NOT NULL DEFAULT 5,
+            females_only INTEGER DEFAULT 0,
+            gender_preference TEXT DEFAULT 'any',
+            depart_at INTEGER DEFAULT 0,
+            depart_window INTEGER DEFAULT 0,
+            created_at DATETIME
+        );
+        CREATE TABLE IF NOT EXISTS archive.join_requests (
+            id INTEGER PRIMARY KEY,
+            ride_id INTEGER NOT NULL,
+            user_id TEXT NOT NULL,
+            status TEXT,
+            created_at DATETIME
+        );
+        CREATE TABLE IF NOT EXISTS archive.ride_participation (
+            user_id TEXT NOT NULL,
+            ride_id INTEGER NOT NULL,
+            role TEXT NOT NULL,
+            ride_status TEXT NOT NULL DEFAULT 'completed',
+            PRIMARY KEY(user_id, ride_id)
+        ) WITHOUT ROWID;
+        CREATE TABLE IF NOT EXISTS archive.requests (
+            id INTEGER PRIMARY KEY,
+            userID TEXT NOT NULL,
+            from_location TEXT NOT NULL,
+            to_location TEXT NOT NULL,
+            ride_type INTEGER NOT NULL,
+            females_only INTEGER DEFAULT 0,
+            status TEXT,
+            created_at DATETIME
+        );
+        CREATE INDEX IF NOT EXISTS archive.idx_archive_rides_owner ON rides(owner_id, id);
+        CREATE INDEX IF NOT EXISTS archive.idx_archive_join_requests_ride ON join_requests(ride_id, user_id);
+    )";
+    char* errMsg = 0;
+    if (sqlite3_exec(db, schema, 0, 0, &errMsg) != SQLITE_OK) {
+        LOG_ERROR("Error creating archive tables: " << errMsg);
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
 bool DatabaseManager::initialize() {
     int rc = sqlite3_open(dbPath.c_str(), &db);
     if (rc) {
-        std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
+        LOG_ERROR("Can't open database: " << sqlite3_errmsg(db));
         return false;
     }
+    if (profiler) profiler->attach(db);
 
     // Create users table
     const char* createUsersTable = R"(
@@ -44,6 +132,8 @@ bool DatabaseManager::initialize() {
             max_capacity INTEGER NOT NULL DEFAULT 5,
             females_only INTEGER DEFAULT 0,
             gender_preference TEXT DEFAULT 'any',
+            depart_at INTEGER DEFAULT 0,
+            depart_window INTEGER DEFAULT 0,
             created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
             FOREIGN KEY(owner_id) REFERENCES users(userID)
         );
@@ -100,13 +190,25 @@ bool DatabaseManager::initialize() {
         );
     )";
 
+    // Create user -> rides participation index (owner or accepted passenger).
+    // ride_status is denormalized so active-ride lookups never touch history.
+    const char* createParticipationTable = R"(
+        CREATE TABLE IF NOT EXISTS ride_participation (
+            user_id TEXT NOT NULL,
+            ride_id INTEGER NOT NULL,
+            role TEXT NOT NULL,
+            ride_status TEXT NOT NULL DEFAULT 'open',
+            PRIMARY KEY(user_id, ride_id)
+        ) WITHOUT ROWID;
+    )";
+
     char* errMsg = 0;
-    const char* tables[] = {createUsersTable, createRidesTable, createJoinRequestsTable, createRequestsTable, createMessagesTable, createStudentsTable};
+    const char* tables[] = {createUsersTable, createRidesTable, createJoinRequestsTable, createRequestsTable, createMessagesTable, createStudentsTable, createParticipationTable};
     
-    for (int i = 0; i < 6; i++) {
+    for (int i = 0; i < 7; i++) {
         rc = sqlite3_exec(db, tables[i], 0, 0, &errMsg);
         if (rc != SQLITE_OK) {
-            std::cerr << "SQL error: " << errMsg << std::endl;
+            LOG_ERROR("SQL error: " << errMsg);
             sqlite3_free(errMsg);
             return false;
         }
@@ -132,11 +234,13 @@ bool DatabaseManager::initialize() {
     const char* addRideColumns[] = {
         "ALTER TABLE rides ADD COLUMN owner_id TEXT;",
         "ALTER TABLE rides ADD COLUMN ride_status TEXT DEFAULT 'open';",
-        "ALTER TABLE rides ADD COLUMN gender_preference TEXT DEFAULT 'any';"
+        "ALTER TABLE rides ADD COLUMN gender_preference TEXT DEFAULT 'any';",
+        "ALTER TABLE rides ADD COLUMN depart_at INTEGER DEFAULT 0;",
+        "ALTER TABLE rides ADD COLUMN depart_window INTEGER DEFAULT 0;"
     };
     
-    for (int i = 0; i < 3; i++) {
-        sqlite3_exec(db, addRideColumns[i], 0, 0, &errMsg);
+    for (auto sql : addRideColumns) {
+        sqlite3_exec(db, sql, 0, 0, &errMsg);
         // Ignore errors for columns that already exist
         if (errMsg) {
             sqlite3_free(errMsg);
@@ -144,6 +248,57 @@ bool DatabaseManager::initialize() {
         }
     }
 
+    // Indexes backing keyset pagination and the per-user lookups
+    const char* indexes[] = {
+        "CREATE INDEX IF NOT EXISTS idx_rides_owner ON rides(owner_id, id);",
+        "CREATE INDEX IF NOT EXISTS idx_rides_status ON rides(ride_status, id);",
+        "CREATE INDEX IF NOT EXISTS idx_rides_type_status ON rides(ride_type, ride_status, id);",
+        "CREATE INDEX IF NOT EXISTS idx_rides_from ON rides(from_location, id);",
+        "CREATE INDEX IF NOT EXISTS idx_rides_depart ON rides(ride_status, depart_at);",
+        "CREATE INDEX IF NOT EXISTS idx_join_requests_user ON join_requests(user_id, status, ride_id);",
+        "CREATE INDEX IF NOT EXISTS idx_participation_status ON ride_participation(user_id, ride_status, ride_id);",
+        "CREATE INDEX IF NOT EXISTS idx_participation_ride ON ride_participation(ride_id);",
+        "CREATE INDEX IF NOT EXISTS idx_join_requests_expiry ON join_requests(status, created_at);",
+        "CREATE INDEX IF NOT EXISTS idx_requests_expiry ON requests(status, created_at);"
+    };
+
+    for (auto sql : indexes) {
+        if (sqlite3_exec(db, sql, 0, 0, &errMsg) != SQLITE_OK) {
+            LOG_ERROR("Error creating index: " << errMsg);
+            sqlite3_free(errMsg);
+            return false;
+        }
+    }
+
+    // Backfill the participation index the first time it is created
+    sqlite3_stmt* countStmt = nullptr;
+    bool participationEmpty = false;
+    if (prepare("SELECT NOT EXISTS (SELECT 1 FROM ride_participation);", &countStmt) == SQLITE_OK) {
+        if (sqlite3_step(countStmt) == SQLITE_ROW) {
+            participationEmpty = sqlite3_column_int(countStmt, 0) == 1;
+        }
+    }
+    if (countStmt) sqlite3_finalize(countStmt);
+
+    if (participationEmpty) {
+        const char* backfill = R"(
+            INSERT OR IGNORE INTO ride_participation (user_id, ride_id, role, ride_status)
+                SELECT owner_id, id, 'owner', COALESCE(ride_status, 'open') FROM rides
+                WHERE owner_id IS NOT NULL AND owner_id != '';
+            INSERT OR IGNORE INTO ride_participation (user_id, ride_id, role, ride_status)
+                SELECT jr.user_id, jr.ride_id, 'passenger', COALESCE(r.ride_status, 'open')
+                FROM join_requests jr JOIN rides r ON r.id = jr.ride_id
+                WHERE jr.status = 'accepted';
+        )";
+        if (sqlite3_exec(db, backfill, 0, 0, &errMsg) != SQLITE_OK) {
+            LOG_ERROR("Error backfilling ride participation: " << errMsg);
+            sqlite3_free(errMsg);
+            return false;
+        }
+    }
+
+    if (!attachArchive()) return false;
+
     // Ensure students table has gender column (no-op if already present)
     sqlite3_exec(db, "ALTER TABLE students ADD COLUMN gender TEXT;", 0, 0, &errMsg);
     if (errMsg) {
@@ -164,22 +319,143 @@ bool DatabaseManager::initialize() {
 
     for (auto sql : inserts) {
         if (sqlite3_exec(db, sql, 0, 0, &errMsg) != SQLITE_OK) {
-            std::cerr << "Error inserting student: " << errMsg << std::endl;
+            LOG_ERROR("Error inserting student: " << errMsg);
             sqlite3_free(errMsg);
             return false;
         }
     }
 
+    if (openRides) loadOpenRides();
+    return true;
+}
+
+void DatabaseManager::setSqlProfiler(SqlProfiler* sqlProfiler) {
+    profiler = sqlProfiler;
+    if (!db) return;
+    if (profiler) profiler->attach(db);
+    else SqlProfiler::detach(db);
+}
+
+void DatabaseManager::setMatchingEngine(MatchingEngine* engine) {
+    matcher = engine;
+    openRides = engine ? &engine->table() : nullptr;
+    if (db && openRides) loadOpenRides();
+}
+
+bool DatabaseManager::loadOpenRides() {
+    TRACE_SPAN("db.loadOpenRides", "db");
+    if (!openRides) return false;
+    const char* sql = R"(
+        SELECT id, owner_id, from_location, to_location, time, mode, ride_type,
+               current_capacity, max_capacity, females_only, gender_preference, depart_at, depart_window
+        FROM rides WHERE ride_status = 'open';
+    )";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) {
+        LOG_ERROR("SQL prepare error: " << sqlite3_errmsg(db));
+        return false;
+    }
+
+    std::vector<Ride> rides;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        Ride ride;
+        ride.rideID = sqlite3_column_int(stmt, 0);
+        const unsigned char* owner = sqlite3_column_text(stmt, 1);
+        ride.ownerID = owner ? (const char*)owner : "";
+        ride.from = (const char*)sqlite3_column_text(stmt, 2);
+        ride.to = (const char*)sqlite3_column_text(stmt, 3);
+        ride.time = (const char*)sqlite3_column_text(stmt, 4);
+        ride.mode = (const char*)sqlite3_column_text(stmt, 5);
+        ride.rideType = static_cast<RideType>(sqlite3_column_int(stmt, 6));
+        ride.currentCapacity = sqlite3_column_int(stmt, 7);
+        ride.maxCapacity = sqlite3_column_int(stmt, 8);
+        ride.femalesOnly = sqlite3_column_int(stmt, 9) == 1;
+        const unsigned char* pref = sqlite3_column_text(stmt, 10);
+        ride.genderPreference = pref ? (const char*)pref : "any";
+        ride.departAt = sqlite3_column_int64(stmt, 11);
+        ride.departWindow = sqlite3_column_int(stmt, 12);
+        ride.status = RideStatus::OPEN;
+        rides.push_back(std::move(ride));
+    }
+    sqlite3_finalize(stmt);
+    openRides->replaceAll(rides);
+    LOG_INFO("Open ride table loaded: " << openRides->size() << " rides");
     return true;
 }
 
+bool DatabaseManager::post(std::function<void()> work) {
+    if (!executor) {
+        work();
+        return true;
+    }
+    return executor->submit(std::move(work));
+}
+
+// --- Prepare a statement and count it towards queryCount() ---
+int DatabaseManager::prepare(const char* sql, sqlite3_stmt** stmt) {
+    statementCount.fetch_add(1, std::memory_order_relaxed);
+    return sqlite3_prepare_v2(db, sql, -1, stmt, NULL);
+}
+
+// --- Change notifications for the fragment cache and ETag versions ---
+void DatabaseManager::rideChanged(int rideID) {
+    if (rideCache) rideCache->invalidateRide(rideID);
+    if (versions) versions->bumpRide(rideID);
+}
+
+// Re-read one ride into the open ride table after a write that may change
+// its status or columns; rides that are gone or no longer open drop out
+void DatabaseManager::syncOpenRide(int rideID) {
+    if (!openRides) return;
+    Ride ride = getRideByID(rideID);
+    if (ride.rideID == rideID) openRides->upsert(ride);
+    else openRides->remove(rideID);
+}
+
+void DatabaseManager::userChanged(const std::string& userID) {
+    if (versions) versions->bumpUser(userID);
+}
+
+void DatabaseManager::dataChanged() {
+    if (versions) versions->bumpGlobal();
+}
+
+// --- Maintain the ride_participation index ---
+void DatabaseManager::addParticipation(const std::string& userID, int rideID, const char* role) {
+    const char* sql = R"(
+        INSERT OR REPLACE INTO ride_participation (user_id, ride_id, role, ride_status)
+        VALUES (?, ?, ?, COALESCE((SELECT ride_status FROM rides WHERE id = ?), 'open'));
+    )";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return;
+
+    sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, rideID);
+    sqlite3_bind_text(stmt, 3, role, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, rideID);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+}
+
+void DatabaseManager::removePassenger(const std::string& userID, int rideID) {
+    const char* sql = "DELETE FROM ride_participation WHERE user_id = ? AND ride_id = ? AND role = 'passenger';";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return;
+
+    sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, rideID);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+}
+
 bool DatabaseManager::insertUser(const User& user) {
+    TRACE_SPAN("db.insertUser", "db");
     // Try to fetch gender from students table using enrollment_id if provided
     std::string genderToInsert = user.gender;
     if (!user.enrollment_id.empty()) {
         const char* q = "SELECT gender FROM students WHERE enrollment_id = ?;";
         sqlite3_stmt* qstmt = nullptr;
-        int qrc = sqlite3_prepare_v2(db, q, -1, &qstmt, NULL);
+        int qrc = prepare(q, &qstmt);
         if (qrc == SQLITE_OK) {
             sqlite3_bind_text(qstmt, 1, user.enrollment_id.c_str(), -1, SQLITE_STATIC);
             if (sqlite3_step(qstmt) == SQLITE_ROW) {
@@ -193,7 +469,7 @@ bool DatabaseManager::insertUser(const User& user) {
     const char* sql = "INSERT OR REPLACE INTO users (userID, name, email, gender) VALUES (?, ?, ?, ?);";
     sqlite3_stmt* stmt = nullptr;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, user.userID.c_str(), -1, SQLITE_STATIC);
@@ -204,15 +480,23 @@ bool DatabaseManager::insertUser(const User& user) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
 
+    // INSERT OR REPLACE may have changed the name shown on this user's rides
+    if (rc == SQLITE_DONE) {
+        if (rideCache) rideCache->invalidateOwner(user.userID);
+        if (versions) versions->bumpNames();
+        userChanged(user.userID);
+    }
+
     return rc == SQLITE_DONE;
 }
 
 User DatabaseManager::getUserByEmail(const std::string& email) {
+    TRACE_SPAN("db.getUserByEmail", "db");
     const char* sql = "SELECT userID, name, email, gender FROM users WHERE email = ?;";
     sqlite3_stmt* stmt;
     User user;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return user;
 
     sqlite3_bind_text(stmt, 1, email.c_str(), -1, SQLITE_STATIC);
@@ -229,11 +513,12 @@ User DatabaseManager::getUserByEmail(const std::string& email) {
 }
 
 User DatabaseManager::getUserByID(const std::string& userID) {
+    TRACE_SPAN("db.getUserByID", "db");
     const char* sql = "SELECT userID, name, email, gender FROM users WHERE userID = ?;";
     sqlite3_stmt* stmt;
     User user;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return user;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
@@ -250,11 +535,12 @@ User DatabaseManager::getUserByID(const std::string& userID) {
 }
 
 std::vector<User> DatabaseManager::getAllUsers() {
+    TRACE_SPAN("db.getAllUsers", "db");
     std::vector<User> users;
     const char* sql = "SELECT userID, name, email FROM users;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return users;
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -270,12 +556,13 @@ std::vector<User> DatabaseManager::getAllUsers() {
 }
 
 int DatabaseManager::insertRide(Ride& ride) {
-    const char* sql = "INSERT INTO rides (owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+    TRACE_SPAN("db.insertRide", "db");
+    const char* sql = "INSERT INTO rides (owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference, depart_at, depart_window) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) {
-        std::cerr << "SQL prepare error: " << sqlite3_errmsg(db) << std::endl;
+        LOG_ERROR("SQL prepare error: " << sqlite3_errmsg(db));
         return -1;
     }
 
@@ -290,6 +577,8 @@ int DatabaseManager::insertRide(Ride& ride) {
     sqlite3_bind_int(stmt, 9, ride.femalesOnly ? 1 : 0);
     sqlite3_bind_text(stmt, 10, "open", -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 11, ride.genderPreference.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 12, ride.departAt);
+    sqlite3_bind_int(stmt, 13, ride.departWindow);
 
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -297,61 +586,141 @@ int DatabaseManager::insertRide(Ride& ride) {
     if (rc == SQLITE_DONE) {
         int rideID = sqlite3_last_insert_rowid(db);
         ride.rideID = rideID;
+        if (!ride.ownerID.empty()) {
+            addParticipation(ride.ownerID, rideID, "owner");
+        }
+        syncOpenRide(rideID);
+        rideChanged(rideID);
+        userChanged(ride.ownerID);
         return rideID;
     }
     
     return -1;
 }
 
-// Helper function to convert string status to RideStatus enum
-static RideStatus stringToRideStatus(const std::string& statusStr) {
-    if (statusStr == "open") return RideStatus::OPEN;
-    if (statusStr == "full") return RideStatus::FULL;
-    if (statusStr == "started") return RideStatus::STARTED;
-    if (statusStr == "completed") return RideStatus::COMPLETED;
-    return RideStatus::OPEN; // default
+// Owned copy of a cursor row for the callers that keep rides around
+static Ride rideFromView(const RideView& view) {
+    Ride ride;
+    ride.rideID = view.rideID;
+    ride.ownerID = std::string(view.ownerID);
+    ride.userID = ride.ownerID;
+    ride.from = std::string(view.from);
+    ride.to = std::string(view.to);
+    ride.time = std::string(view.time);
+    ride.mode = std::string(view.mode);
+    ride.rideType = view.rideType;
+    ride.currentCapacity = view.currentCapacity;
+    ride.maxCapacity = view.maxCapacity;
+    ride.femalesOnly = view.femalesOnly;
+    ride.status = view.status;
+    ride.genderPreference = std::string(view.genderPreference);
+    ride.departAt = view.departAt;
+    ride.departWindow = view.departWindow;
+    if (!ride.ownerID.empty()) {
+        ride.participants.push_back(ride.ownerID);
+    }
+    return ride;
 }
 
-std::vector<Ride> DatabaseManager::getAllRides() {
-    std::vector<Ride> rides;
-    const char* sql = "SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference FROM rides;";
+RideCursor DatabaseManager::scanAllRides() {
+    const char* sql = "SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference, depart_at, depart_window FROM rides;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) return rides;
+    int rc = prepare(sql, &stmt);
+    if (rc != SQLITE_OK) return RideCursor();
+    return RideCursor(stmt);
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Ride ride;
-        ride.rideID = sqlite3_column_int(stmt, 0);
-        ride.ownerID = (char*)sqlite3_column_text(stmt, 1);
-        ride.userID = ride.ownerID;
-        ride.from = (char*)sqlite3_column_text(stmt, 2);
-        ride.to = (char*)sqlite3_column_text(stmt, 3);
-        ride.time = (char*)sqlite3_column_text(stmt, 4);
-        ride.mode = (char*)sqlite3_column_text(stmt, 5);
-        ride.rideType = static_cast<RideType>(sqlite3_column_int(stmt, 6));
-        ride.currentCapacity = sqlite3_column_int(stmt, 7);
-        ride.maxCapacity = sqlite3_column_int(stmt, 8);
-        ride.femalesOnly = sqlite3_column_int(stmt, 9) == 1;
-        const char* statusStr = (char*)sqlite3_column_text(stmt, 10);
-        ride.status = stringToRideStatus(statusStr ? statusStr : "open");
-        ride.genderPreference = (char*)sqlite3_column_text(stmt, 11);
-        if (!ride.ownerID.empty()) {
-            ride.participants.push_back(ride.ownerID);
+std::vector<Ride> DatabaseManager::getAllRides() {
+    TRACE_SPAN("db.getAllRides", "db");
+    std::vector<Ride> rides;
+    RideCursor cursor = scanAllRides();
+    while (cursor.next()) {
+        rides.push_back(rideFromView(cursor.ride()));
+    }
+    return rides;
+}
+
+RideCursor DatabaseManager::scanRides(const RideFilter& filter, int afterID, int limit) {
+    // Completed rides are read from the live table and the archive; any other
+    // status is live only
+    bool history = filter.status == "completed";
+    // A participant filter is driven from the user's ride_participation rows
+    // (primary key user_id, ride_id), so a page costs O(limit) whatever the
+    // size of the rides table
+    bool byParticipant = !filter.participantID.empty();
+    auto arm = [&](const char* schema, bool withLead) {
+        std::string part = std::string(R"(
+            SELECT r.id, r.owner_id, r.from_location, r.to_location, r.time, r.mode, r.ride_type,
+                   r.current_capacity, r.max_capacity, r.females_only, r.ride_status, r.gender_preference,
+                   r.depart_at, r.depart_window)") +
+            (withLead ? ", COALESCE(u.name, '') FROM " : " FROM ");
+        if (byParticipant) {
+            part += std::string(schema) + ".ride_participation p JOIN " + schema + ".rides r ON r.id = p.ride_id";
+        } else {
+            part += std::string(schema) + ".rides r";
         }
-        rides.push_back(ride);
+        part += withLead ? " LEFT JOIN users u ON u.userID = r.owner_id" : "";
+        part += byParticipant ? " WHERE p.user_id = ? AND p.ride_id > ?" : " WHERE r.id > ?";
+        if (!filter.ownerID.empty()) part += " AND r.owner_id = ?";
+        if (!filter.status.empty()) part += " AND r.ride_status = ?";
+        if (filter.rideType >= 0) part += " AND r.ride_type = ?";
+        if (!filter.fromArea.empty()) part += " AND r.from_location = ?";
+        return part + (byParticipant ? " ORDER BY p.ride_id LIMIT ?" : " ORDER BY r.id LIMIT ?");
+    };
+    std::string sql = arm("main", true) + ";";
+    if (history) {
+        sql = "SELECT x.*, COALESCE(u.name, '') FROM (SELECT * FROM (" + arm("main", false) +
+              ") UNION SELECT * FROM (" + arm("archive", false) +
+              ")) x LEFT JOIN users u ON u.userID = x.owner_id ORDER BY x.id LIMIT ?;";
     }
 
-    sqlite3_finalize(stmt);
+    sqlite3_stmt* stmt;
+    int rc = prepare(sql.c_str(), &stmt);
+    if (rc != SQLITE_OK) return RideCursor();
+
+    // Transient binds: the cursor may outlive the caller's filter
+    int idx = 1;
+    for (int arms = history ? 2 : 1; arms > 0; --arms) {
+        if (byParticipant) sqlite3_bind_text(stmt, idx++, filter.participantID.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, idx++, afterID);
+        if (!filter.ownerID.empty()) sqlite3_bind_text(stmt, idx++, filter.ownerID.c_str(), -1, SQLITE_TRANSIENT);
+        if (!filter.status.empty()) sqlite3_bind_text(stmt, idx++, filter.status.c_str(), -1, SQLITE_TRANSIENT);
+        if (filter.rideType >= 0) sqlite3_bind_int(stmt, idx++, filter.rideType);
+        if (!filter.fromArea.empty()) sqlite3_bind_text(stmt, idx++, filter.fromArea.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, idx++, limit);
+    }
+    if (history) sqlite3_bind_int(stmt, idx++, limit);
+    return RideCursor(stmt);
+}
+
+std::vector<std::pair<Ride, std::string>> DatabaseManager::listRides(const RideFilter& filter, int afterID, int limit) {
+    TRACE_SPAN("db.listRides", "db");
+    std::vector<std::pair<Ride, std::string>> rides;
+    RideCursor cursor = scanRides(filter, afterID, limit);
+    while (cursor.next()) {
+        rides.push_back({rideFromView(cursor.ride()), std::string(cursor.leadName())});
+    }
     return rides;
 }
 
 std::vector<Ride> DatabaseManager::findRideMatches(const std::string& from, const std::string& to, RideType rideType, const std::string& userID) {
+    TRACE_SPAN("db.findRideMatches", "db");
+    if (matcher) {
+        MatchRequest request;
+        request.from = from;
+        request.to = to;
+        request.rideType = rideType;
+        request.userID = userID;
+        if (!userID.empty()) request.userGender = getUserByID(userID).gender;
+        return matcher->match(request);
+    }
+
     std::vector<Ride> matches;
     const char* sql = "SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only FROM rides WHERE ride_type = ? AND current_capacity < max_capacity AND ride_status = 'open' AND owner_id != ?;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return matches;
 
     sqlite3_bind_int(stmt, 1, static_cast<int>(rideType));
@@ -402,10 +771,11 @@ std::vector<Ride> DatabaseManager::findRideMatches(const std::string& from, cons
 }
 
 bool DatabaseManager::insertRequest(const std::string& userID, const std::string& from, const std::string& to, RideType rideType, bool femalesOnly) {
+    TRACE_SPAN("db.insertRequest", "db");
     const char* sql = "INSERT INTO requests (userID, from_location, to_location, ride_type, females_only) VALUES (?, ?, ?, ?, ?);";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
@@ -417,14 +787,16 @@ bool DatabaseManager::insertRequest(const std::string& userID, const std::string
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) userChanged(userID);
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::updateRequestStatus(int requestID, const std::string& status) {
+    TRACE_SPAN("db.updateRequestStatus", "db");
     const char* sql = "UPDATE requests SET status = ? WHERE id = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_STATIC);
@@ -433,16 +805,18 @@ bool DatabaseManager::updateRequestStatus(int requestID, const std::string& stat
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) dataChanged();
     return rc == SQLITE_DONE;
 }
 
 
 
 bool DatabaseManager::insertMessage(const std::string& senderID, const std::string& messageText) {
+    TRACE_SPAN("db.insertMessage", "db");
     const char* sql = "INSERT INTO messages (sender_id, message_text) VALUES (?, ?);";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, senderID.c_str(), -1, SQLITE_STATIC);
@@ -451,14 +825,16 @@ bool DatabaseManager::insertMessage(const std::string& senderID, const std::stri
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) dataChanged();
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::updateRideCapacity(const std::string& userID, const std::string& from, const std::string& to, int newCapacity) {
+    TRACE_SPAN("db.updateRideCapacity", "db");
     const char* sql = "UPDATE rides SET current_capacity = ? WHERE owner_id = ? AND from_location = ? AND to_location = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_int(stmt, 1, newCapacity);
@@ -469,15 +845,33 @@ bool DatabaseManager::updateRideCapacity(const std::string& userID, const std::s
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) {
+        if (openRides) {
+            const char* idSql = "SELECT id FROM rides WHERE owner_id = ? AND from_location = ? AND to_location = ?;";
+            sqlite3_stmt* idStmt;
+            if (prepare(idSql, &idStmt) == SQLITE_OK) {
+                sqlite3_bind_text(idStmt, 1, userID.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(idStmt, 2, from.c_str(), -1, SQLITE_STATIC);
+                sqlite3_bind_text(idStmt, 3, to.c_str(), -1, SQLITE_STATIC);
+                while (sqlite3_step(idStmt) == SQLITE_ROW) {
+                    openRides->setCurrentCapacity(sqlite3_column_int(idStmt, 0), newCapacity);
+                }
+                sqlite3_finalize(idStmt);
+            }
+        }
+        if (rideCache) rideCache->invalidateOwner(userID);
+        userChanged(userID);
+    }
     return rc == SQLITE_DONE;
 }
 
 std::vector<std::pair<std::string, std::string>> DatabaseManager::getAllMessages() {
+    TRACE_SPAN("db.getAllMessages", "db");
     std::vector<std::pair<std::string, std::string>> messages;
     const char* sql = "SELECT sender_id, message_text FROM messages ORDER BY timestamp;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return messages;
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -491,10 +885,11 @@ std::vector<std::pair<std::string, std::string>> DatabaseManager::getAllMessages
 }
 
 bool DatabaseManager::updateUserPreferences(const std::string& userID, const std::string& genderPref, int vehicleType) {
+    TRACE_SPAN("db.updateUserPreferences", "db");
     const char* sql = "UPDATE users SET gender_preference = ?, vehicle_preference = ? WHERE userID = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, genderPref.c_str(), -1, SQLITE_STATIC);
@@ -504,14 +899,16 @@ bool DatabaseManager::updateUserPreferences(const std::string& userID, const std
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) userChanged(userID);
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::getUserPreferences(const std::string& userID, std::string& genderPref, int& vehicleType) {
+    TRACE_SPAN("db.getUserPreferences", "db");
     const char* sql = "SELECT gender_preference, vehicle_preference FROM users WHERE userID = ?;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
@@ -533,27 +930,51 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
     RideType rideType, 
     const std::string& userID, 
     const std::string& genderPref,
-    bool searcherWantsFemalesOnly) {
+    bool searcherWantsFemalesOnly,
+    int64_t departAt,
+    int departWindow) {
+    TRACE_SPAN("db.findMatchingRides", "db");
+
+    // Same predicates as the SQL below, evaluated column-wise in memory
+    if (matcher) {
+        MatchRequest request;
+        request.from = from;
+        request.to = to;
+        request.rideType = rideType;
+        request.userID = userID;
+        request.userGender = getUserByID(userID).gender;
+        request.wantsFemalesOnly = searcherWantsFemalesOnly;
+        request.genderPreference = genderPref.empty() ? "any" : genderPref; // SQL matches '' against 'any' rows only
+        request.departAt = departAt;
+        request.departWindow = departWindow;
+        return matcher->match(request);
+    }
     
     std::vector<Ride> matches;
     const char* sql = R"(
         SELECT id, owner_id, from_location, to_location, time, mode, ride_type, 
-               current_capacity, max_capacity, females_only, gender_preference, ride_status
+               current_capacity, max_capacity, females_only, gender_preference, ride_status,
+               depart_at, depart_window
         FROM rides 
         WHERE ride_type = ? 
           AND ride_status = 'open' 
           AND current_capacity < max_capacity
           AND owner_id != ?
           AND (gender_preference = 'any' OR gender_preference = ?)
+          AND (?4 = 0 OR depart_at = 0 OR
+               (depart_at - MIN(depart_window, ?6) <= ?4 + ?5 AND depart_at + MIN(depart_window, ?6) >= ?4 - ?5))
     )";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return matches;
 
     sqlite3_bind_int(stmt, 1, static_cast<int>(rideType));
     sqlite3_bind_text(stmt, 2, userID.c_str(), -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, genderPref.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, departAt);
+    sqlite3_bind_int(stmt, 5, std::min(std::max(departWindow, 0), MAX_DEPART_WINDOW));
+    sqlite3_bind_int(stmt, 6, MAX_DEPART_WINDOW);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         Ride ride;
@@ -571,6 +992,8 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
         ride.genderPreference = (char*)sqlite3_column_text(stmt, 10);
         const char* statusStr = (char*)sqlite3_column_text(stmt, 11);
         ride.status = stringToRideStatus(statusStr ? statusStr : "open");
+        ride.departAt = sqlite3_column_int64(stmt, 12);
+        ride.departWindow = sqlite3_column_int(stmt, 13);
         
         // Check proximity using LocationGraph
         if (locationGraph && !locationGraph->areConnected(from, ride.from)) continue;
@@ -580,15 +1003,14 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
         User user = getUserByID(userID);
         std::string userGender = user.gender;
         
-        // DEBUG: Log ride and user info
-        std::cout << "DEBUG: Ride ID " << ride.rideID << ", femalesOnly: " << ride.femalesOnly 
-                  << ", userGender: '" << userGender << "', searcherWantsFemalesOnly: " << searcherWantsFemalesOnly << std::endl;
+        LOG_DEBUG("Ride ID " << ride.rideID << ", femalesOnly: " << ride.femalesOnly
+                  << ", userGender: '" << userGender << "', searcherWantsFemalesOnly: " << searcherWantsFemalesOnly);
         
         // ===== CORRECTED FILTERING LOGIC =====
         
         // RULE 1: Males can NEVER see females-only rides
         if (ride.femalesOnly && userGender == "male") {
-            std::cout << "DEBUG: Skipping ride " << ride.rideID << " - RULE 1: Male user cannot see females-only ride" << std::endl;
+            LOG_DEBUG("Skipping ride " << ride.rideID << " - RULE 1: Male user cannot see females-only ride");
             continue; // Skip this ride
         }
         
@@ -596,7 +1018,7 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
         if (userGender == "female" && searcherWantsFemalesOnly) {
             // Only show females-only rides
             if (!ride.femalesOnly) {
-                std::cout << "DEBUG: Skipping ride " << ride.rideID << " - RULE 2: Female wants females-only but ride is not females-only" << std::endl;
+                LOG_DEBUG("Skipping ride " << ride.rideID << " - RULE 2: Female wants females-only but ride is not females-only");
                 continue;
             }
         }
@@ -604,11 +1026,11 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
         // RULE 3: If female user does NOT want females-only specifically, show ALL rides
         // RULE 4: Non-female users (except males) see only regular rides
         if (ride.femalesOnly && userGender != "female") {
-            std::cout << "DEBUG: Skipping ride " << ride.rideID << " - RULE 4: Non-female user cannot see females-only ride" << std::endl;
+            LOG_DEBUG("Skipping ride " << ride.rideID << " - RULE 4: Non-female user cannot see females-only ride");
             continue;
         }
         
-        std::cout << "DEBUG: Including ride " << ride.rideID << " in matches" << std::endl;
+        LOG_DEBUG("Including ride " << ride.rideID << " in matches");
         
         matches.push_back(ride);
     }
@@ -617,11 +1039,85 @@ std::vector<Ride> DatabaseManager::findMatchingRides(
     return matches;
 }
 
+std::pmr::vector<RideView> DatabaseManager::findMatchingRideViews(
+    const std::string& from,
+    const std::string& to,
+    RideType rideType,
+    const std::string& userID,
+    const std::string& genderPref,
+    bool searcherWantsFemalesOnly,
+    RequestArena& arena,
+    int64_t departAt,
+    int departWindow) {
+    std::pmr::vector<RideView> matches(arena.resource());
+    if (matcher) {
+        TRACE_SPAN("db.findMatchingRides", "db");
+        MatchRequest request;
+        request.from = from;
+        request.to = to;
+        request.rideType = rideType;
+        request.userID = userID;
+        request.userGender = std::string(getUserGender(userID, arena));
+        request.wantsFemalesOnly = searcherWantsFemalesOnly;
+        request.genderPreference = genderPref.empty() ? "any" : genderPref;
+        request.departAt = departAt;
+        request.departWindow = departWindow;
+        matcher->match(request, matches);
+        return matches;
+    }
+
+    // SQL fallback: copy the rows into the arena
+    for (const Ride& ride : findMatchingRides(from, to, rideType, userID, genderPref, searcherWantsFemalesOnly,
+                                              departAt, departWindow)) {
+        RideView view;
+        view.rideID = ride.rideID;
+        view.ownerID = arena.copy(ride.ownerID);
+        view.from = arena.copy(ride.from);
+        view.to = arena.copy(ride.to);
+        view.time = arena.copy(ride.time);
+        view.mode = arena.copy(ride.mode);
+        view.genderPreference = arena.copy(ride.genderPreference);
+        view.rideType = ride.rideType;
+        view.currentCapacity = ride.currentCapacity;
+        view.maxCapacity = ride.maxCapacity;
+        view.femalesOnly = ride.femalesOnly;
+        view.departAt = ride.departAt;
+        view.departWindow = ride.departWindow;
+        matches.push_back(view);
+    }
+    return matches;
+}
+
+// One text column of the user's row, copied into the arena; empty if no such user
+std::string_view DatabaseManager::userText(const char* sql, std::string_view userID, RequestArena& arena) {
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return {};
+    sqlite3_bind_text(stmt, 1, userID.data(), static_cast<int>(userID.size()), SQLITE_STATIC);
+    std::string_view text;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* value = (const char*)sqlite3_column_text(stmt, 0);
+        if (value) text = arena.copy(std::string_view(value, sqlite3_column_bytes(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+    return text;
+}
+
+std::string_view DatabaseManager::getUserName(std::string_view userID, RequestArena& arena) {
+    TRACE_SPAN("db.getUserName", "db");
+    return userText("SELECT name FROM users WHERE userID = ?;", userID, arena);
+}
+
+std::string_view DatabaseManager::getUserGender(std::string_view userID, RequestArena& arena) {
+    TRACE_SPAN("db.getUserGender", "db");
+    return userText("SELECT gender FROM users WHERE userID = ?;", userID, arena);
+}
+
 bool DatabaseManager::insertJoinRequest(int rideID, const std::string& userID) {
+    TRACE_SPAN("db.insertJoinRequest", "db");
     const char* sql = "INSERT OR IGNORE INTO join_requests (ride_id, user_id) VALUES (?, ?);";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_int(stmt, 1, rideID);
@@ -630,14 +1126,19 @@ bool DatabaseManager::insertJoinRequest(int rideID, const std::string& userID) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) {
+        if (versions) versions->bumpRide(rideID, false); // join requests aren't shown in /ride/all
+        userChanged(userID);
+    }
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::updateJoinRequestStatus(int rideID, const std::string& userID, const std::string& status) {
+    TRACE_SPAN("db.updateJoinRequestStatus", "db");
     const char* sql = "UPDATE join_requests SET status = ? WHERE ride_id = ? AND user_id = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_STATIC);
@@ -647,14 +1148,21 @@ bool DatabaseManager::updateJoinRequestStatus(int rideID, const std::string& use
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) {
+        if (status == "accepted") addParticipation(userID, rideID, "passenger");
+        else removePassenger(userID, rideID);
+        if (versions) versions->bumpRide(rideID, false); // join requests aren't shown in /ride/all
+        userChanged(userID);
+    }
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::updateRideStatus(int rideID, const std::string& status) {
+    TRACE_SPAN("db.updateRideStatus", "db");
     const char* sql = "UPDATE rides SET ride_status = ? WHERE id = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, status.c_str(), -1, SQLITE_STATIC);
@@ -663,34 +1171,60 @@ bool DatabaseManager::updateRideStatus(int rideID, const std::string& status) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) {
+        const char* syncSql = "UPDATE ride_participation SET ride_status = ? WHERE ride_id = ?;";
+        sqlite3_stmt* syncStmt;
+        if (prepare(syncSql, &syncStmt) == SQLITE_OK) {
+            sqlite3_bind_text(syncStmt, 1, status.c_str(), -1, SQLITE_STATIC);
+            sqlite3_bind_int(syncStmt, 2, rideID);
+            sqlite3_step(syncStmt);
+            sqlite3_finalize(syncStmt);
+        }
+
+        syncOpenRide(rideID);
+        rideChanged(rideID);
+        // Participants' accepted-requests lists filter on ride status
+        if (versions) {
+            for (const auto& participant : getRideParticipants(rideID)) {
+                userChanged(participant);
+            }
+        }
+    }
     return rc == SQLITE_DONE;
 }
 
-std::vector<std::pair<std::string, std::string>> DatabaseManager::getPendingRequests(int rideID) {
-    std::vector<std::pair<std::string, std::string>> requests;
-    const char* sql = "SELECT user_id, created_at FROM join_requests WHERE ride_id = ? AND status = 'pending';";
+JoinRequestCursor DatabaseManager::scanPendingRequests(int rideID) {
+    const char* sql = R"(
+        SELECT jr.user_id, COALESCE(u.name, ''), jr.created_at
+        FROM join_requests jr
+        LEFT JOIN users u ON jr.user_id = u.userID
+        WHERE jr.ride_id = ? AND jr.status = 'pending'
+    )";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) return requests;
+    int rc = prepare(sql, &stmt);
+    if (rc != SQLITE_OK) return JoinRequestCursor();
 
     sqlite3_bind_int(stmt, 1, rideID);
+    return JoinRequestCursor(stmt);
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string userID = (char*)sqlite3_column_text(stmt, 0);
-        std::string timestamp = (char*)sqlite3_column_text(stmt, 1);
-        requests.push_back({userID, timestamp});
+std::vector<std::pair<std::string, std::string>> DatabaseManager::getPendingRequests(int rideID) {
+    TRACE_SPAN("db.getPendingRequests", "db");
+    std::vector<std::pair<std::string, std::string>> requests;
+    JoinRequestCursor cursor = scanPendingRequests(rideID);
+    while (cursor.next()) {
+        requests.push_back({std::string(cursor.userID()), std::string(cursor.timestamp())});
     }
-
-    sqlite3_finalize(stmt);
     return requests;
 }
 
 bool DatabaseManager::hasActiveRequest(const std::string& userID) {
+    TRACE_SPAN("db.hasActiveRequest", "db");
     const char* sql = "SELECT COUNT(*) FROM join_requests WHERE user_id = ? AND status = 'pending';";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
@@ -704,11 +1238,35 @@ bool DatabaseManager::hasActiveRequest(const std::string& userID) {
     return hasActive;
 }
 
+// --- Counts sampled by the /metrics gauges ---
+static int countQuery(int rc, sqlite3_stmt* stmt) {
+    if (rc != SQLITE_OK) return 0;
+    int count = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+int DatabaseManager::countLiveRides() {
+    sqlite3_stmt* stmt;
+    int rc = prepare("SELECT COUNT(*) FROM rides WHERE ride_status IN ('open', 'full', 'started');", &stmt);
+    return countQuery(rc, stmt);
+}
+
+int DatabaseManager::countPendingJoinRequests() {
+    sqlite3_stmt* stmt;
+    int rc = prepare("SELECT COUNT(*) FROM join_requests WHERE status = 'pending';", &stmt);
+    return countQuery(rc, stmt);
+}
+
 bool DatabaseManager::updateRideCapacityByID(int rideID, int newCapacity) {
+    TRACE_SPAN("db.updateRideCapacityByID", "db");
     const char* sql = "UPDATE rides SET current_capacity = ? WHERE id = ?;";
     sqlite3_stmt* stmt;
     
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_int(stmt, 1, newCapacity);
@@ -717,15 +1275,20 @@ bool DatabaseManager::updateRideCapacityByID(int rideID, int newCapacity) {
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
+    if (rc == SQLITE_DONE) {
+        if (openRides) openRides->setCurrentCapacity(rideID, newCapacity);
+        rideChanged(rideID);
+    }
     return rc == SQLITE_DONE;
 }
 
 bool DatabaseManager::isValidEnrollment(const std::string& enrollmentID) {
+    TRACE_SPAN("db.isValidEnrollment", "db");
     const char* sql = "SELECT COUNT(*) FROM students WHERE enrollment_id = ?;";
     sqlite3_stmt* stmt;
     bool exists = false;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, enrollmentID.c_str(), -1, SQLITE_STATIC);
@@ -739,11 +1302,12 @@ bool DatabaseManager::isValidEnrollment(const std::string& enrollmentID) {
 }
 
 bool DatabaseManager::doesEnrollmentMatchEmail(const std::string& enrollmentID, const std::string& email) {
+    TRACE_SPAN("db.doesEnrollmentMatchEmail", "db");
     const char* sql = "SELECT email_pattern FROM students WHERE enrollment_id = ?;";
     sqlite3_stmt* stmt;
     std::string pattern;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return false;
 
     sqlite3_bind_text(stmt, 1, enrollmentID.c_str(), -1, SQLITE_STATIC);
@@ -762,6 +1326,7 @@ bool DatabaseManager::doesEnrollmentMatchEmail(const std::string& enrollmentID,
 }
 
 std::vector<std::pair<int, std::string>> DatabaseManager::getAcceptedRequestsForUser(const std::string& userID) {
+    TRACE_SPAN("db.getAcceptedRequestsForUser", "db");
     std::vector<std::pair<int, std::string>> accepted;
     const char* sql = R"(
         SELECT jr.ride_id, 
@@ -776,7 +1341,7 @@ std::vector<std::pair<int, std::string>> DatabaseManager::getAcceptedRequestsFor
     )";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return accepted;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
@@ -794,10 +1359,15 @@ std::vector<std::pair<int, std::string>> DatabaseManager::getAcceptedRequestsFor
     return accepted;
 }
 
-std::vector<std::pair<std::string, std::string>> DatabaseManager::getAcceptedPassengers(int rideID) {
-    std::vector<std::pair<std::string, std::string>> passengers;
-    const char* sql = R"(
-        SELECT jr.user_id, u.name
+JoinRequestCursor DatabaseManager::scanAcceptedPassengers(int rideID, bool archived) {
+    const char* sql = archived ? R"(
+        SELECT jr.user_id, u.name, jr.created_at
+        FROM archive.join_requests jr
+        JOIN users u ON jr.user_id = u.userID
+        WHERE jr.ride_id = ? AND jr.status = 'accepted'
+        ORDER BY jr.created_at ASC
+    )" : R"(
+        SELECT jr.user_id, u.name, jr.created_at
         FROM join_requests jr
         JOIN users u ON jr.user_id = u.userID
         WHERE jr.ride_id = ? AND jr.status = 'accepted'
@@ -805,41 +1375,40 @@ std::vector<std::pair<std::string, std::string>> DatabaseManager::getAcceptedPas
     )";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) return passengers;
+    int rc = prepare(sql, &stmt);
+    if (rc != SQLITE_OK) return JoinRequestCursor();
 
     sqlite3_bind_int(stmt, 1, rideID);
+    return JoinRequestCursor(stmt);
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::string userID = (char*)sqlite3_column_text(stmt, 0);
-        const unsigned char* namePtr = sqlite3_column_text(stmt, 1);
-        std::string userName = namePtr ? (char*)namePtr : "";
-        passengers.push_back({userID, userName});
+std::vector<std::pair<std::string, std::string>> DatabaseManager::getAcceptedPassengers(int rideID) {
+    TRACE_SPAN("db.getAcceptedPassengers", "db");
+    std::vector<std::pair<std::string, std::string>> passengers;
+    JoinRequestCursor cursor = scanAcceptedPassengers(rideID);
+    while (cursor.next()) {
+        passengers.push_back({std::string(cursor.userID()), std::string(cursor.userName())});
     }
-
-    sqlite3_finalize(stmt);
     return passengers;
 }
 
 std::vector<Ride> DatabaseManager::getActiveRidesForUser(const std::string& userID) {
+    TRACE_SPAN("db.getActiveRidesForUser", "db");
     std::vector<Ride> activeRides;
     const char* sql = R"(
-        SELECT id, owner_id, from_location, to_location, time, mode, ride_type, 
-               current_capacity, max_capacity, females_only, ride_status, gender_preference
-        FROM rides 
-        WHERE (owner_id = ? OR id IN (
-            SELECT ride_id FROM join_requests 
-            WHERE user_id = ? AND status = 'accepted'
-        ))
-        AND ride_status IN ('open', 'started')
+        SELECT r.id, r.owner_id, r.from_location, r.to_location, r.time, r.mode, r.ride_type, 
+               r.current_capacity, r.max_capacity, r.females_only, r.ride_status, r.gender_preference,
+               r.depart_at, r.depart_window
+        FROM ride_participation p
+        JOIN rides r ON r.id = p.ride_id
+        WHERE p.user_id = ? AND p.ride_status IN ('open', 'started')
     )";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return activeRides;
 
     sqlite3_bind_text(stmt, 1, userID.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, userID.c_str(), -1, SQLITE_STATIC);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
         Ride ride;
@@ -857,6 +1426,8 @@ std::vector<Ride> DatabaseManager::getActiveRidesForUser(const std::string& user
         const char* statusStr = (char*)sqlite3_column_text(stmt, 10);
         ride.status = stringToRideStatus(statusStr ? statusStr : "open");
         ride.genderPreference = (char*)sqlite3_column_text(stmt, 11);
+        ride.departAt = sqlite3_column_int64(stmt, 12);
+        ride.departWindow = sqlite3_column_int(stmt, 13);
         if (!ride.ownerID.empty()) {
             ride.participants.push_back(ride.ownerID);
         }
@@ -867,12 +1438,117 @@ std::vector<Ride> DatabaseManager::getActiveRidesForUser(const std::string& user
     return activeRides;
 }
 
+std::vector<std::pair<Ride, std::string>> DatabaseManager::getUserRides(const std::string& userID, const std::string& status, int beforeID, int limit) {
+    TRACE_SPAN("db.getUserRides", "db");
+    std::vector<std::pair<Ride, std::string>> rides;
+    // Walks the (user_id, [ride_status,] ride_id) index newest-first, so a page
+    // costs O(limit) however long the user's history is. Completed rides are
+    // in the archive, so history pages read a page from each and merge them.
+    auto readPage = [&](const char* schema) {
+        std::string sql = std::string(R"(
+            SELECT r.id, r.owner_id, r.from_location, r.to_location, r.time, r.mode, r.ride_type,
+                   r.current_capacity, r.max_capacity, r.females_only, r.ride_status, r.gender_preference,
+                   r.depart_at, r.depart_window, COALESCE(u.name, '')
+            FROM )") + schema + ".ride_participation p JOIN " + schema + R"(.rides r ON r.id = p.ride_id
+            LEFT JOIN users u ON u.userID = r.owner_id
+            WHERE p.user_id = ?
+        )";
+        // Rides that expired unrun are not part of anyone's history
+        sql += status.empty() ? " AND p.ride_status != 'expired'" : " AND p.ride_status = ?";
+        if (beforeID > 0) sql += " AND p.ride_id < ?";
+        sql += " ORDER BY p.ride_id DESC LIMIT ?;";
+
+        sqlite3_stmt* stmt;
+        int rc = prepare(sql.c_str(), &stmt);
+        if (rc != SQLITE_OK) return;
+
+        int idx = 1;
+        sqlite3_bind_text(stmt, idx++, userID.c_str(), -1, SQLITE_STATIC);
+        if (!status.empty()) sqlite3_bind_text(stmt, idx++, status.c_str(), -1, SQLITE_STATIC);
+        if (beforeID > 0) sqlite3_bind_int(stmt, idx++, beforeID);
+        sqlite3_bind_int(stmt, idx++, limit);
+
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            Ride ride;
+            ride.rideID = sqlite3_column_int(stmt, 0);
+            const unsigned char* ownerPtr = sqlite3_column_text(stmt, 1);
+            ride.ownerID = ownerPtr ? (char*)ownerPtr : "";
+            ride.userID = ride.ownerID;
+            ride.from = (char*)sqlite3_column_text(stmt, 2);
+            ride.to = (char*)sqlite3_column_text(stmt, 3);
+            ride.time = (char*)sqlite3_column_text(stmt, 4);
+            ride.mode = (char*)sqlite3_column_text(stmt, 5);
+            ride.rideType = static_cast<RideType>(sqlite3_column_int(stmt, 6));
+            ride.currentCapacity = sqlite3_column_int(stmt, 7);
+            ride.maxCapacity = sqlite3_column_int(stmt, 8);
+            ride.femalesOnly = sqlite3_column_int(stmt, 9) == 1;
+            const char* statusStr = (char*)sqlite3_column_text(stmt, 10);
+            ride.status = stringToRideStatus(statusStr ? statusStr : "open");
+            const unsigned char* prefPtr = sqlite3_column_text(stmt, 11);
+            ride.genderPreference = prefPtr ? (char*)prefPtr : "any";
+            ride.departAt = sqlite3_column_int64(stmt, 12);
+            ride.departWindow = sqlite3_column_int(stmt, 13);
+            if (!ride.ownerID.empty()) {
+                ride.participants.push_back(ride.ownerID);
+            }
+            std::string leadName = (char*)sqlite3_column_text(stmt, 14);
+            rides.push_back({ride, leadName});
+        }
+
+        sqlite3_finalize(stmt);
+    };
+
+    readPage("main");
+    if (!status.empty() && status != "completed") return rides;
+
+    size_t live = rides.size();
+    readPage("archive");
+    if (rides.size() == live) return rides;
+
+    // A ride mid-move is in both pages; keep one, newest first
+    std::stable_sort(rides.begin(), rides.end(),
+                     [](const auto& a, const auto& b) { return a.first.rideID > b.first.rideID; });
+    rides.erase(std::unique(rides.begin(), rides.end(),
+                            [](const auto& a, const auto& b) { return a.first.rideID == b.first.rideID; }),
+                rides.end());
+    if (static_cast<int>(rides.size()) > limit) rides.resize(limit);
+    return rides;
+}
+
+std::vector<std::string> DatabaseManager::getRideParticipants(int rideID) {
+    TRACE_SPAN("db.getRideParticipants", "db");
+    std::vector<std::string> participants;
+    const char* sql = "SELECT user_id FROM ride_participation WHERE ride_id = ?;";
+    sqlite3_stmt* stmt;
+
+    int rc = prepare(sql, &stmt);
+    if (rc != SQLITE_OK) return participants;
+
+    sqlite3_bind_int(stmt, 1, rideID);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        participants.push_back((char*)sqlite3_column_text(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    return participants;
+}
+
 Ride DatabaseManager::getRideByID(int rideID) {
+    TRACE_SPAN("db.getRideByID", "db");
+    return readRide("SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference, depart_at, depart_window FROM rides WHERE id = ?;", rideID);
+}
+
+Ride DatabaseManager::getArchivedRide(int rideID) {
+    TRACE_SPAN("db.getArchivedRide", "db");
+    return readRide("SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference, depart_at, depart_window FROM archive.rides WHERE id = ?;", rideID);
+}
+
+Ride DatabaseManager::readRide(const char* sql, int rideID) {
     Ride ride;
-    const char* sql = "SELECT id, owner_id, from_location, to_location, time, mode, ride_type, current_capacity, max_capacity, females_only, ride_status, gender_preference FROM rides WHERE id = ?;";
     sqlite3_stmt* stmt;
 
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    int rc = prepare(sql, &stmt);
     if (rc != SQLITE_OK) return ride;
 
     sqlite3_bind_int(stmt, 1, rideID);
@@ -892,6 +1568,8 @@ Ride DatabaseManager::getRideByID(int rideID) {
         const char* statusStr = (char*)sqlite3_column_text(stmt, 10);
         ride.status = stringToRideStatus(statusStr ? statusStr : "open");
         ride.genderPreference = (char*)sqlite3_column_text(stmt, 11);
+        ride.departAt = sqlite3_column_int64(stmt, 12);
+        ride.departWindow = sqlite3_column_int(stmt, 13);
         if (!ride.ownerID.empty()) {
             ride.participants.push_back(ride.ownerID);
         }
@@ -899,4 +1577,232 @@ Ride DatabaseManager::getRideByID(int rideID) {
 
     sqlite3_finalize(stmt);
     return ride;
-}
\ No newline at end of file
+}
+// --- Maintenance slices ---
+// Each call handles at most `batch` rows with a few set-based statements and
+// no explicit transaction: the connection is shared by every DB thread, so a
+// BEGIN here would swallow handlers' writes. The statements are ordered so a
+// slice cut short is finished by the next one.
+
+static std::string idPlaceholders(size_t count) {
+    std::string list;
+    for (size_t i = 0; i < count; ++i) list += i ? ",?" : "?";
+    return list;
+}
+
+static int bindIDs(sqlite3_stmt* stmt, int first, const std::vector<int>& ids) {
+    for (int id : ids) sqlite3_bind_int(stmt, first++, id);
+    return first;
+}
+
+// Runs one statement whose parameters are `ids`, repeated `lists` times
+int DatabaseManager::execForIDs(const std::string& sql, const std::vector<int>& ids, int lists) {
+    sqlite3_stmt* stmt;
+    if (prepare(sql.c_str(), &stmt) != SQLITE_OK) return -1;
+    int index = 1;
+    for (int i = 0; i < lists; ++i) index = bindIDs(stmt, index, ids);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? sqlite3_changes(db) : -1;
+}
+
+std::vector<int> DatabaseManager::expireStaleRides(int64_t olderThan, int batch) {
+    TRACE_SPAN("db.expireStaleRides", "db");
+    std::vector<int> rideIDs;
+    // Scheduled rides expire when their window closes, unscheduled ones by age
+    const char* sql = R"(
+        SELECT id FROM rides
+        WHERE ride_status IN ('open', 'full')
+          AND CASE WHEN depart_at > 0 THEN depart_at + depart_window
+                   ELSE CAST(strftime('%s', created_at) AS INTEGER) END < ?
+        ORDER BY id LIMIT ?;
+    )";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return rideIDs;
+    sqlite3_bind_int64(stmt, 1, olderThan);
+    sqlite3_bind_int(stmt, 2, batch);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        rideIDs.push_back(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (rideIDs.empty()) return rideIDs;
+
+    const std::string in = "(" + idPlaceholders(rideIDs.size()) + ")";
+
+    // Participants and waiting requesters see their lists change
+    std::vector<std::string> affected;
+    std::string usersSql = "SELECT user_id FROM ride_participation WHERE ride_id IN " + in +
+                           " UNION SELECT user_id FROM join_requests WHERE status = 'pending' AND ride_id IN " + in + ";";
+    if (prepare(usersSql.c_str(), &stmt) == SQLITE_OK) {
+        bindIDs(stmt, bindIDs(stmt, 1, rideIDs), rideIDs);
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            affected.push_back((char*)sqlite3_column_text(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    // The ride row goes last: until it flips, the next slice selects it again
+    execForIDs("UPDATE join_requests SET status = 'expired' WHERE status = 'pending' AND ride_id IN " + in + ";", rideIDs);
+    execForIDs("UPDATE ride_participation SET ride_status = 'expired' WHERE ride_id IN " + in + ";", rideIDs);
+    if (execForIDs("UPDATE rides SET ride_status = 'expired' WHERE ride_status IN ('open', 'full') AND id IN " + in + ";",
+                   rideIDs) < 0) {
+        return {};
+    }
+
+    for (int rideID : rideIDs) {
+        if (openRides) openRides->remove(rideID);
+        rideChanged(rideID);
+    }
+    for (const auto& userID : affected) userChanged(userID);
+    LOG_INFO("Expired " << rideIDs.size() << " stale rides");
+    return rideIDs;
+}
+
+int DatabaseManager::expirePendingJoinRequests(int64_t olderThan, int batch) {
+    TRACE_SPAN("db.expirePendingJoinRequests", "db");
+    std::vector<int> requestIDs;
+    std::vector<std::pair<int, std::string>> owners; // (rideID, userID)
+    const char* sql = R"(
+        SELECT id, ride_id, user_id FROM join_requests
+        WHERE status = 'pending' AND created_at < datetime(?, 'unixepoch')
+        ORDER BY created_at LIMIT ?;
+    )";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return 0;
+    sqlite3_bind_int64(stmt, 1, olderThan);
+    sqlite3_bind_int(stmt, 2, batch);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        requestIDs.push_back(sqlite3_column_int(stmt, 0));
+        owners.push_back({sqlite3_column_int(stmt, 1), (char*)sqlite3_column_text(stmt, 2)});
+    }
+    sqlite3_finalize(stmt);
+    if (requestIDs.empty()) return 0;
+
+    int changed = execForIDs("UPDATE join_requests SET status = 'expired' WHERE status = 'pending' AND id IN (" +
+                             idPlaceholders(requestIDs.size()) + ");", requestIDs);
+    if (changed <= 0) return 0;
+
+    // The ride's request list changes, the ride listing does not
+    for (const auto& [rideID, userID] : owners) {
+        if (versions) versions->bumpRide(rideID, false);
+        userChanged(userID);
+    }
+    return static_cast<int>(requestIDs.size());
+}
+
+int DatabaseManager::expireRequests(int64_t olderThan, int batch) {
+    TRACE_SPAN("db.expireRequests", "db");
+    const char* sql = R"(
+        UPDATE requests SET status = 'expired'
+        WHERE id IN (SELECT id FROM requests
+                     WHERE status = 'pending' AND created_at < datetime(?, 'unixepoch')
+                     ORDER BY created_at LIMIT ?);
+    )";
+    sqlite3_stmt* stmt;
+    if (prepare(sql, &stmt) != SQLITE_OK) return 0;
+    sqlite3_bind_int64(stmt, 1, olderThan);
+    sqlite3_bind_int(stmt, 2, batch);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? sqlite3_changes(db) : 0;
+}
+
+std::vector<int> DatabaseManager::finishedRideIDs(const std::vector<int>& rideIDs) {
+    TRACE_SPAN("db.finishedRideIDs", "db");
+    std::vector<int> finished;
+    if (rideIDs.empty()) return finished;
+
+    // Everything not still live is finished, including rides no longer in the table
+    std::string sql = "SELECT id FROM rides WHERE ride_status IN ('open', 'full', 'started') AND id IN (" +
+                      idPlaceholders(rideIDs.size()) + ");";
+    sqlite3_stmt* stmt;
+    if (prepare(sql.c_str(), &stmt) != SQLITE_OK) return finished;
+    bindIDs(stmt, 1, rideIDs);
+    std::vector<int> live;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        live.push_back(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) return finished; // unsure: evict nothing
+
+    std::sort(live.begin(), live.end());
+    for (int rideID : rideIDs) {
+        if (!std::binary_search(live.begin(), live.end(), rideID)) finished.push_back(rideID);
+    }
+    return finished;
+}
+
+static const char* RIDE_ROW_COLUMNS =
+    "id, owner_id, from_location, to_location, time, mode, ride_type, ride_status, current_capacity, "
+    "max_capacity, females_only, gender_preference, depart_at, depart_window, created_at";
+
+int DatabaseManager::archiveCompletedRides(int batch) {
+    TRACE_SPAN("db.archiveCompletedRides", "db");
+    std::vector<int> rideIDs;
+    sqlite3_stmt* stmt;
+    // Expired rides keep their status in the archive, so history reads that
+    // ask for 'completed' never see them
+    if (prepare("SELECT id FROM main.rides WHERE ride_status IN ('completed', 'expired') ORDER BY id LIMIT ?;",
+                &stmt) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, batch);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        rideIDs.push_back(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (rideIDs.empty()) return 0;
+
+    // Copy, then delete with the ride row last. Copies are INSERT OR IGNORE,
+    // so a slice interrupted anywhere is completed by the next one, and a
+    // ride mid-move is in both databases with identical rows.
+    const std::string in = "(" + idPlaceholders(rideIDs.size()) + ")";
+    const std::string columns = RIDE_ROW_COLUMNS;
+    const std::string steps[] = {
+        "INSERT OR IGNORE INTO archive.rides (" + columns + ") SELECT " + columns +
+            " FROM main.rides WHERE id IN " + in + ";",
+        "INSERT OR IGNORE INTO archive.join_requests (id, ride_id, user_id, status, created_at)"
+        " SELECT id, ride_id, user_id, status, created_at FROM main.join_requests WHERE ride_id IN " + in + ";",
+        "INSERT OR IGNORE INTO archive.ride_participation (user_id, ride_id, role, ride_status)"
+        " SELECT user_id, ride_id, role, ride_status FROM main.ride_participation WHERE ride_id IN " + in + ";",
+        "DELETE FROM main.join_requests WHERE ride_id IN " + in + ";",
+        "DELETE FROM main.ride_participation WHERE ride_id IN " + in + ";",
+        "DELETE FROM main.rides WHERE ride_status IN ('completed', 'expired') AND id IN " + in + ";",
+    };
+    for (const auto& step : steps) {
+        if (execForIDs(step, rideIDs) < 0) {
+            LOG_WARN("Archiving rides stopped: " << sqlite3_errmsg(db));
+            return 0;
+        }
+    }
+
+    // Drops their fragments from the /ride/all cache
+    for (int rideID : rideIDs) rideChanged(rideID);
+    LOG_DEBUG("Archived " << rideIDs.size() << " finished rides");
+    return static_cast<int>(rideIDs.size());
+}
+
+int DatabaseManager::archiveClosedRequests(int batch) {
+    TRACE_SPAN("db.archiveClosedRequests", "db");
+    std::vector<int> requestIDs;
+    sqlite3_stmt* stmt;
+    if (prepare("SELECT id FROM main.requests WHERE status != 'pending' ORDER BY id LIMIT ?;", &stmt) != SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_bind_int(stmt, 1, batch);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        requestIDs.push_back(sqlite3_column_int(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (requestIDs.empty()) return 0;
+
+    const std::string in = "(" + idPlaceholders(requestIDs.size()) + ")";
+    const char* columns = "id, userID, from_location, to_location, ride_type, females_only, status, created_at";
+    if (execForIDs(std::string("INSERT OR IGNORE INTO archive.requests (") + columns + ") SELECT " + columns +
+                   " FROM main.requests WHERE id IN " + in + ";", requestIDs) < 0 ||
+        execForIDs("DELETE FROM main.requests WHERE id IN " + in + ";", requestIDs) < 0) {
+        return 0;
+    }
+    return static_cast<int>(requestIDs.size());
+}
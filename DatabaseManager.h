@@ -2,24 +2,97 @@
 #define DATABASEMANAGER_H
 
 #include <sqlite3.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include "Executor.h"
 #include "User.h"
 #include "Ride.h"
 #include "LocationGraph.h"
+#include "RowCursor.h"
+
+class MatchingEngine;
+class OpenRideTable;
+class RequestArena;
+class RideFragmentCache;
+class VersionRegistry;
+class SqlProfiler;
+
+// Optional filters for keyset-paginated ride listing; empty fields are ignored
+struct RideFilter {
+    std::string ownerID;
+    std::string participantID; // owner or accepted passenger
+    std::string status;        // "open", "full", "started", "completed", "expired"
+    int rideType = -1;         // RideType value, -1 for any
+    std::string fromArea;
+};
 
 class DatabaseManager {
 private:
     sqlite3* db;
     std::string dbPath;
+    std::string archivePath;
     LocationGraph* locationGraph;
+    RideFragmentCache* rideCache;
+    VersionRegistry* versions;
+    SqlProfiler* profiler;
+    Executor* executor;
+    MatchingEngine* matcher;
+    OpenRideTable* openRides; // matcher->table(), kept in sync by ride writes
+    std::atomic<uint64_t> statementCount{0};
+
+    int prepare(const char* sql, sqlite3_stmt** stmt);
+    void rideChanged(int rideID);
+    void userChanged(const std::string& userID);
+    void dataChanged();
+    void addParticipation(const std::string& userID, int rideID, const char* role);
+    void removePassenger(const std::string& userID, int rideID);
+    void syncOpenRide(int rideID);
+    std::string_view userText(const char* sql, std::string_view userID, RequestArena& arena);
+    bool attachArchive();
+    Ride readRide(const char* sql, int rideID);
+    int execForIDs(const std::string& sql, const std::vector<int>& ids, int lists = 1);
 
 public:
     DatabaseManager(const std::string& path = "rideshare.db");
     ~DatabaseManager();
     
     void setLocationGraph(LocationGraph* graph) { locationGraph = graph; }
+    void setRideCache(RideFragmentCache* cache) { rideCache = cache; }
+    void setVersionRegistry(VersionRegistry* registry) { versions = registry; }
+    void setSqlProfiler(SqlProfiler* sqlProfiler); // attaches now if the database is open, else in initialize()
+    // Serves findMatchingRides and findRideMatches from the engine. Its open
+    // ride table is loaded now if the database is open, else in initialize(),
+    // and ride writes keep it in sync.
+    void setMatchingEngine(MatchingEngine* engine);
+    bool loadOpenRides();
+    uint64_t queryCount() const { return statementCount.load(std::memory_order_relaxed); }
+
+    // Async API: work runs on the DB executor, or inline when none is set.
+    // post() returns false when the executor queue is full.
+    void setExecutor(Executor* pool) { executor = pool; }
+    Executor* getExecutor() const { return executor; }
+    bool post(std::function<void()> work);
+    template <typename F>
+    auto async(F&& work) -> std::future<std::invoke_result_t<F, DatabaseManager&>> {
+        using Result = std::invoke_result_t<F, DatabaseManager&>;
+        auto bound = [this, work = std::forward<F>(work)]() mutable -> Result { return work(*this); };
+        if (executor) return executor->async(std::move(bound));
+        std::packaged_task<Result()> task(std::move(bound));
+        std::future<Result> result = task.get_future();
+        task();
+        return result;
+    }
     
+    // Completed rides are archived to this database, attached as "archive".
+    // Defaults to the main path with -archive.db; set before initialize().
+    void setArchivePath(const std::string& path) { archivePath = path; }
     bool initialize();
     
     // User operations
@@ -31,6 +104,13 @@ public:
     // Ride operations
     int insertRide(Ride& ride);
     std::vector<Ride> getAllRides();
+    // Rides with id > afterID matching `filter`, ordered by id, at most `limit` rows.
+    // Returns (ride, leadUserName) pairs.
+    std::vector<std::pair<Ride, std::string>> listRides(const RideFilter& filter, int afterID, int limit);
+    // Cursor variants for handlers that serialize rows as they step. A cursor
+    // must be drained and dropped inside the same DB task that opened it.
+    RideCursor scanAllRides();
+    RideCursor scanRides(const RideFilter& filter, int afterID, int limit); // leadName() available
     std::vector<Ride> findRideMatches(const std::string& from, const std::string& to, RideType rideType, const std::string& userID = "");
     bool updateRideCapacity(const std::string& userID, const std::string& from, const std::string& to, int newCapacity);
     
@@ -50,7 +130,16 @@ public:
     std::vector<Ride> findMatchingRides(const std::string& from, const std::string& to, 
                                        RideType rideType, const std::string& userID, 
                                        const std::string& genderPref = "any",
-                                       bool searcherWantsFemalesOnly = false);
+                                       bool searcherWantsFemalesOnly = false,
+                                       int64_t departAt = 0, int departWindow = 0); // departAt 0: any time
+    // Request-arena variants for handlers. The returned views point into the
+    // ride index or into `arena` and stay valid until the arena is released.
+    std::pmr::vector<RideView> findMatchingRideViews(const std::string& from, const std::string& to,
+                                                     RideType rideType, const std::string& userID,
+                                                     const std::string& genderPref, bool searcherWantsFemalesOnly,
+                                                     RequestArena& arena, int64_t departAt = 0, int departWindow = 0);
+    std::string_view getUserName(std::string_view userID, RequestArena& arena);
+    std::string_view getUserGender(std::string_view userID, RequestArena& arena);
     bool insertJoinRequest(int rideID, const std::string& userID);
     bool updateJoinRequestStatus(int rideID, const std::string& userID, const std::string& status);
     bool updateRideStatus(int rideID, const std::string& status);
@@ -59,7 +148,10 @@ public:
     // Verify that a given enrollment ID maps to the provided student email (stored in students table)
     bool doesEnrollmentMatchEmail(const std::string& enrollmentID, const std::string& email);
     std::vector<std::pair<std::string, std::string>> getPendingRequests(int rideID); // returns (userID, timestamp) pairs
+    JoinRequestCursor scanPendingRequests(int rideID); // requester names included
     bool hasActiveRequest(const std::string& userID);
+    int countLiveRides();
+    int countPendingJoinRequests();
     bool isValidStudentEmail(const std::string& email);
     
     // Get accepted requests for a user (for notifications)
@@ -67,12 +159,40 @@ public:
     
     // Get accepted passengers for a ride (for ride leads)
     std::vector<std::pair<std::string, std::string>> getAcceptedPassengers(int rideID); // returns (userID, userName) pairs
+    JoinRequestCursor scanAcceptedPassengers(int rideID, bool archived = false);
     
     // Get active rides for a user (OPEN or STARTED status)
     std::vector<Ride> getActiveRidesForUser(const std::string& userID);
     
+    // Rides the user owned or rode in, newest first, with ride id < beforeID (0 = from the newest).
+    // Returns (ride, leadUserName) pairs.
+    std::vector<std::pair<Ride, std::string>> getUserRides(const std::string& userID, const std::string& status, int beforeID, int limit);
+    
+    // Owner and accepted passengers of a ride, from the participation index
+    std::vector<std::string> getRideParticipants(int rideID);
+    
     // Get ride by ID
     Ride getRideByID(int rideID);
+    // A completed or expired ride that has been moved to the archive
+    Ride getArchivedRide(int rideID);
+
+    // Maintenance slices for MaintenanceScheduler jobs. Each touches at most
+    // `batch` rows and is safe to repeat; cutoffs are unix seconds.
+    // Open/full rides whose departure window (or, unscheduled, creation) ended
+    // before the cutoff become 'expired' (never 'completed', so they stay out
+    // of ride history) and leave the matching table; their pending join
+    // requests expire. Returns the ride IDs.
+    std::vector<int> expireStaleRides(int64_t olderThan, int batch);
+    // Pending join requests created before the cutoff become 'expired'
+    int expirePendingJoinRequests(int64_t olderThan, int batch);
+    // Pending ride requests created before the cutoff become 'expired'
+    int expireRequests(int64_t olderThan, int batch);
+    // Those of `rideIDs` that are completed, expired or gone
+    std::vector<int> finishedRideIDs(const std::vector<int>& rideIDs);
+    // Move completed and expired rides with their join requests and participation rows,
+    // and requests no longer pending, to the archive database
+    int archiveCompletedRides(int batch);
+    int archiveClosedRequests(int batch);
 };
 
 #endif // DATABASEMANAGER_H
\ No newline at end of file
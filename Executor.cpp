@@ -0,0 +1,68 @@
+#include "Executor.h"
+#include "Logger.h"
+
+Executor::Executor(const std::string& poolName, size_t threads, size_t queueCapacity)
+    : name(poolName), capacity(queueCapacity == 0 ? 1 : queueCapacity) {
+    if (threads == 0) threads = 1;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&Executor::workerLoop, this);
+    }
+    LOG_INFO("Executor '" << name << "' started: " << threads << " threads, queue " << capacity);
+}
+
+Executor::~Executor() {
+    shutdown();
+}
+
+bool Executor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping || queue.size() >= capacity) {
+            rejectedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        queue.push_back(std::move(task));
+    }
+    ready.notify_one();
+    return true;
+}
+
+void Executor::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        busy.fetch_add(1, std::memory_order_relaxed);
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Executor '" << name << "' task threw: " << e.what());
+        } catch (...) {
+            LOG_ERROR("Executor '" << name << "' task threw an unknown exception");
+        }
+        busy.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void Executor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopping) return;
+        stopping = true;
+    }
+    ready.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t Executor::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return queue.size();
+}
@@ -0,0 +1,70 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed pool of worker threads with a bounded FIFO queue. Blocking work
+// (SQLite, outbound HTTPS) runs here instead of on Crow's I/O threads.
+// submit() refuses work rather than growing the queue without limit, so
+// callers can shed load with a 503 when the pool is saturated.
+class Executor {
+private:
+    std::string name;
+    size_t capacity;
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    mutable std::mutex mtx; // guards queue and stopping
+    std::condition_variable ready;
+    bool stopping = false;
+    std::atomic<size_t> busy{0};
+    std::atomic<uint64_t> rejectedCount{0};
+
+    void workerLoop();
+
+public:
+    Executor(const std::string& poolName, size_t threads, size_t queueCapacity);
+    ~Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // False when the queue is full or the pool is shutting down
+    bool submit(std::function<void()> task);
+
+    // Future-based variant; a rejected task yields a future holding an exception
+    template <typename F>
+    auto async(F&& work) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(work));
+        std::future<Result> result = task->get_future();
+        if (!submit([task]() { (*task)(); })) {
+            std::promise<Result> refused;
+            refused.set_exception(std::make_exception_ptr(std::runtime_error(name + " executor queue is full")));
+            return refused.get_future();
+        }
+        return result;
+    }
+
+    // Finishes queued tasks, then joins the workers. Later submits fail.
+    void shutdown();
+
+    const std::string& poolName() const { return name; }
+    size_t threadCount() const { return workers.size(); }
+    size_t queueDepth() const;
+    size_t activeCount() const { return busy.load(std::memory_order_relaxed); }
+    uint64_t rejected() const { return rejectedCount.load(std::memory_order_relaxed); }
+};
+
+#endif // EXECUTOR_H
@@ -0,0 +1,146 @@
+#include "JsonWriter.h"
+
+#if defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#include <emmintrin.h>
+#define JSONWRITER_SSE2 1
+#endif
+
+JsonWriter::JsonWriter(size_t reserveBytes) {
+    buf.reserve(reserveBytes);
+    hasElement.reserve(16);
+}
+
+void JsonWriter::clear() {
+    buf.clear();
+    hasElement.clear();
+    afterKey = false;
+}
+
+// --- Emit the separator required before the next value ---
+void JsonWriter::beforeValue() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!hasElement.empty()) {
+        if (hasElement.back()) buf.push_back(',');
+        hasElement.back() = 1;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    beforeValue();
+    buf.push_back('{');
+    hasElement.push_back(0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    buf.push_back('}');
+    hasElement.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    beforeValue();
+    buf.push_back('[');
+    hasElement.push_back(0);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    buf.push_back(']');
+    hasElement.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view k) {
+    beforeValue();
+    buf.push_back('"');
+    appendEscaped(buf, k);
+    buf.append("\":", 2);
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view s) {
+    beforeValue();
+    buf.push_back('"');
+    appendEscaped(buf, s);
+    buf.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    beforeValue();
+    if (b) buf.append("true", 4);
+    else buf.append("false", 5);
+    return *this;
+}
+
+JsonWriter& JsonWriter::valueNull() {
+    beforeValue();
+    buf.append("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    beforeValue();
+    buf.append(json.data(), json.size());
+    return *this;
+}
+
+// --- Find the next byte that needs escaping ('"', '\\' or a control char) ---
+static size_t findEscape(const char* s, size_t i, size_t n) {
+#ifdef JSONWRITER_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrlMax = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        // Unsigned "chunk <= 0x1F" without flagging UTF-8 bytes >= 0x80
+        __m128i isCtrl = _mm_cmpeq_epi8(_mm_max_epu8(chunk, ctrlMax), ctrlMax);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                _mm_cmpeq_epi8(chunk, backslash)),
+                                   isCtrl);
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == '"' || c == '\\' || c < 0x20) return i;
+    }
+    return n;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    const char* data = s.data();
+    size_t n = s.size();
+    size_t i = 0;
+
+    while (i < n) {
+        size_t j = findEscape(data, i, n);
+        out.append(data + i, j - i);
+        if (j == n) break;
+
+        unsigned char c = static_cast<unsigned char>(data[j]);
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            default: {
+                char esc[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(esc, 6);
+            }
+        }
+        i = j + 1;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Streaming JSON writer that appends straight into a reusable buffer.
+// Unlike crow::json::wvalue it never builds a tree: every key and value is
+// escaped once and written in place, so a list endpoint costs one pass over
+// its rows. Keep one writer per thread and call clear() between responses.
+class JsonWriter {
+private:
+    std::string buf;
+    std::vector<char> hasElement; // per open container: has a value been written yet
+    bool afterKey = false;
+
+    void beforeValue();
+
+public:
+    explicit JsonWriter(size_t reserveBytes = 4096);
+
+    void clear();
+    const std::string& str() const { return buf; }
+    size_t size() const { return buf.size(); }
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view k);
+
+    JsonWriter& value(std::string_view s);
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b);
+    JsonWriter& valueNull();
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    JsonWriter& value(T n) {
+        beforeValue();
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), n);
+        buf.append(tmp, res.ptr);
+        return *this;
+    }
+
+    template <typename T>
+    JsonWriter& field(std::string_view k, const T& v) {
+        key(k);
+        return value(v);
+    }
+
+    // Append already-serialized JSON (e.g. a cached fragment) as one value
+    JsonWriter& raw(std::string_view json);
+
+    // Append `s` to `out` with JSON string escaping applied (no quotes)
+    static void appendEscaped(std::string& out, std::string_view s);
+};
+
+#endif // JSONWRITER_H
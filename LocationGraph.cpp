@@ -1,11 +1,14 @@
 #include "LocationGraph.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include <algorithm>
 #include <sqlite3.h>
-#include <iostream>
 
 bool LocationGraph::loadFromDatabase(const std::string& dbPath) {
+    TRACE_SPAN("graph.loadFromDatabase", "graph");
     sqlite3* db;
     if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
-        std::cerr << "Cannot open database: " << dbPath << std::endl;
+        LOG_ERROR("Cannot open database: " << dbPath);
         return false;
     }
 
@@ -13,12 +16,12 @@ bool LocationGraph::loadFromDatabase(const std::string& dbPath) {
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "Failed to prepare statement" << std::endl;
+        LOG_ERROR("Failed to prepare statement");
         sqlite3_close(db);
         return false;
     }
 
-    graph.clear();
+    adjacency.clear();
     int edgeCount = 0;
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -26,9 +29,7 @@ bool LocationGraph::loadFromDatabase(const std::string& dbPath) {
         std::string area2 = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
         double distance = sqlite3_column_double(stmt, 2);
 
-        // Add bidirectional edges
-        graph[area1].emplace_back(area2, distance);
-        graph[area2].emplace_back(area1, distance);
+        addEdge(area1, area2, distance);
         edgeCount++;
     }
 
@@ -36,22 +37,42 @@ bool LocationGraph::loadFromDatabase(const std::string& dbPath) {
     sqlite3_close(db);
 
     initialized = true;
-    std::cout << "Location graph loaded: " << edgeCount << " edges, " 
-              << graph.size() << " locations" << std::endl;
+    LOG_INFO("Location graph loaded: " << edgeCount << " edges, "
+             << adjacency.size() << " locations");
     return true;
 }
 
+void LocationGraph::addEdge(const std::string& area1, const std::string& area2, double distance) {
+    (void)distance; // every stored edge is already within the proximity threshold
+    uint32_t a = areas.intern(area1);
+    uint32_t b = areas.intern(area2);
+    link(a, b);
+    link(b, a);
+    initialized = true;
+}
+
+void LocationGraph::link(uint32_t from, uint32_t to) {
+    if (adjacency.size() <= from) adjacency.resize(from + 1);
+    auto& neighbours = adjacency[from];
+    auto pos = std::lower_bound(neighbours.begin(), neighbours.end(), to);
+    if (pos == neighbours.end() || *pos != to) neighbours.insert(pos, to);
+}
+
 bool LocationGraph::areConnected(const std::string& area1, const std::string& area2) const {
     if (!initialized || area1 == area2) return true;
-    
-    // Special case for NED Campus - always connected to itself
-    if (area1 == "NED Campus" && area2 == "NED Campus") return true;
-    
-    auto it = graph.find(area1);
-    if (it == graph.end()) return false;
-    
-    for (const auto& edge : it->second) {
-        if (edge.first == area2) return true;
-    }
-    return false;
-}
\ No newline at end of file
+    return areConnected(areas.find(area1), areas.find(area2));
+}
+
+bool LocationGraph::areConnected(uint32_t area1, uint32_t area2) const {
+    if (!initialized) return true;
+    if (area1 == NO_AREA || area2 == NO_AREA) return false;
+    if (area1 == area2) return true;
+    if (area1 >= adjacency.size()) return false;
+    const auto& neighbours = adjacency[area1];
+    return std::binary_search(neighbours.begin(), neighbours.end(), area2);
+}
+
+const std::vector<uint32_t>& LocationGraph::neighbours(uint32_t area) const {
+    static const std::vector<uint32_t> none;
+    return area < adjacency.size() ? adjacency[area] : none;
+}
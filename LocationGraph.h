@@ -1,19 +1,38 @@
 #ifndef LOCATIONGRAPH_H
 #define LOCATIONGRAPH_H
 
-#include <unordered_map>
-#include <vector>
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "StringInterner.h"
 
+// Area names are interned; adjacency is stored per area handle as a sorted
+// list of neighbour handles, so hot loops can test proximity without
+// hashing or comparing strings.
 class LocationGraph {
 private:
-    std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> graph;
+    StringInterner areas;
+    std::vector<std::vector<uint32_t>> adjacency; // indexed by area handle, sorted
     bool initialized = false;
 
+    void link(uint32_t from, uint32_t to);
+
 public:
+    static constexpr uint32_t NO_AREA = StringInterner::NONE;
+
     bool loadFromDatabase(const std::string& dbPath = "areas.db");
+    void addEdge(const std::string& area1, const std::string& area2, double distance); // bidirectional
     bool areConnected(const std::string& area1, const std::string& area2) const;
+    bool areConnected(uint32_t area1, uint32_t area2) const;
     bool isInitialized() const { return initialized; }
+
+    // Handles for rides; areas outside the graph get a handle with no neighbours
+    uint32_t internArea(const std::string& name) { return areas.intern(name); }
+    uint32_t findArea(const std::string& name) const { return areas.find(name); }
+    const std::string& areaName(uint32_t area) const { return areas.str(area); }
+    size_t areaCount() const { return areas.size(); }
+    // Sorted neighbour handles; empty for areas outside the graph
+    const std::vector<uint32_t>& neighbours(uint32_t area) const;
 };
 
-#endif // LOCATIONGRAPH_H
\ No newline at end of file
+#endif // LOCATIONGRAPH_H
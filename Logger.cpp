@@ -0,0 +1,197 @@
+#include "Logger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+Logger::Logger() : sink(&std::clog) {}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& out) {
+    static const char* names[] = {"trace", "debug", "info", "warn", "error", "off"};
+    for (int i = 0; i <= static_cast<int>(LogLevel::Off); ++i) {
+        if (name == names[i]) {
+            out = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace: return "trace";
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warn: return "warn";
+        case LogLevel::Error: return "error";
+        default: return "off";
+    }
+}
+
+void Logger::setSink(std::ostream* out) {
+    std::lock_guard<std::mutex> lock(drainMtx);
+    sink = out;
+}
+
+// --- Per-thread ring registration ---
+Logger::Ring& Logger::localRing() {
+    // Marks the ring closed when its thread exits; the drainer frees it once empty
+    struct Holder {
+        std::shared_ptr<Ring> ring;
+        ~Holder() {
+            if (ring) ring->closed.store(true, std::memory_order_release);
+        }
+    };
+    thread_local Holder holder;
+    if (!holder.ring) {
+        holder.ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(mtx);
+        holder.ring->threadIndex = nextThreadIndex++;
+        rings.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+void Logger::write(LogLevel level, const char* file, int line, std::string&& message) {
+    const char* slash = std::strrchr(file, '/');
+    Record record;
+    record.level = level;
+    record.time = std::chrono::system_clock::now();
+    record.file = slash ? slash + 1 : file;
+    record.line = line;
+    record.message = std::move(message);
+
+    if (!running.load(std::memory_order_acquire)) {
+        std::string out;
+        format(record, 0, out);
+        std::lock_guard<std::mutex> lock(drainMtx);
+        sink->write(out.data(), static_cast<std::streamsize>(out.size()));
+        sink->flush();
+        return;
+    }
+
+    Ring& ring = localRing();
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    size_t queued = head - ring.tail.load(std::memory_order_acquire);
+    if (queued >= RING_SIZE) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.slots[head & (RING_SIZE - 1)] = std::move(record);
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // Wake the drainer early for warnings and for bursts that would fill the ring
+    if (level >= LogLevel::Warn || queued == RING_SIZE / 2) wake.notify_one();
+}
+
+// --- Background drain ---
+void Logger::format(const Record& record, int threadIndex, std::string& out) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(record.time);
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+        record.time.time_since_epoch()).count() % 1000;
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char prefix[128];
+    int n = std::snprintf(prefix, sizeof(prefix), "ts=%04d-%02d-%02dT%02d:%02d:%02d.%03dZ level=%s thread=%d src=%s:%d msg=\"",
+                          utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec,
+                          static_cast<int>(millis), levelName(record.level), threadIndex, record.file, record.line);
+    out.append(prefix, n > 0 ? std::min(static_cast<size_t>(n), sizeof(prefix) - 1) : 0);
+
+    for (char c : record.message) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default: out += c;
+        }
+    }
+    out += "\"\n";
+}
+
+size_t Logger::drainOnce(std::string& batch) {
+    std::vector<std::shared_ptr<Ring>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        snapshot = rings;
+    }
+
+    size_t drained = 0;
+    for (const auto& ring : snapshot) {
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            Record& record = ring->slots[tail & (RING_SIZE - 1)];
+            format(record, ring->threadIndex, batch);
+            record.message.clear();
+            ++drained;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    if (!batch.empty()) {
+        sink->write(batch.data(), static_cast<std::streamsize>(batch.size()));
+        sink->flush();
+        batch.clear();
+    }
+
+    // Forget rings whose thread has exited and that have nothing left
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < rings.size();) {
+        Ring& ring = *rings[i];
+        if (ring.closed.load(std::memory_order_acquire) &&
+            ring.tail.load(std::memory_order_relaxed) == ring.head.load(std::memory_order_acquire)) {
+            rings[i] = rings.back();
+            rings.pop_back();
+        } else {
+            ++i;
+        }
+    }
+    return drained;
+}
+
+void Logger::drainLoop() {
+    std::string batch;
+    std::mutex waitMtx;
+    while (running.load(std::memory_order_acquire)) {
+        {
+            std::unique_lock<std::mutex> lock(waitMtx);
+            wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        std::lock_guard<std::mutex> lock(drainMtx);
+        drainOnce(batch);
+    }
+}
+
+void Logger::start() {
+    if (running.exchange(true, std::memory_order_acq_rel)) return;
+    drainer = std::thread(&Logger::drainLoop, this);
+}
+
+void Logger::stop() {
+    if (!running.exchange(false, std::memory_order_acq_rel)) return;
+    wake.notify_one();
+    if (drainer.joinable()) drainer.join();
+    std::string batch;
+    std::lock_guard<std::mutex> lock(drainMtx);
+    drainOnce(batch);
+}
+
+void Logger::flush() {
+    std::string batch;
+    std::lock_guard<std::mutex> lock(drainMtx);
+    drainOnce(batch);
+}
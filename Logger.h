@@ -0,0 +1,116 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Mixed case so the names cannot collide with DEBUG/ERROR macros from
+// build flags or platform headers
+enum class LogLevel { Trace = 0, Debug = 1, Info = 2, Warn = 3, Error = 4, Off = 5 };
+
+// Statements below this level are compiled out entirely.
+// Build with -DUNIRIDE_LOG_MIN_LEVEL=2 to strip DEBUG and TRACE.
+#ifndef UNIRIDE_LOG_MIN_LEVEL
+#define UNIRIDE_LOG_MIN_LEVEL 0
+#endif
+
+// Leveled logfmt logger. Each thread appends records to its own
+// single-producer ring buffer; a background thread drains all rings and
+// writes them to the sink in batches, so workers never contend on the
+// output stream. A full ring drops the record and counts it rather than
+// blocking a request. Until start() is called records are written
+// synchronously, which keeps the standalone tools simple.
+class Logger {
+public:
+    struct Record {
+        LogLevel level = LogLevel::Info;
+        std::chrono::system_clock::time_point time;
+        const char* file = "";
+        int line = 0;
+        std::string message;
+    };
+
+private:
+    static constexpr size_t RING_SIZE = 4096; // power of two
+
+    struct Ring {
+        std::array<Record, RING_SIZE> slots;
+        std::atomic<size_t> head{0}; // next slot the producer writes
+        std::atomic<size_t> tail{0}; // next slot the drainer reads
+        std::atomic<bool> closed{false};
+        int threadIndex = 0;
+    };
+
+    static inline std::atomic<int> threshold{static_cast<int>(LogLevel::Info)};
+
+    std::mutex mtx;      // guards rings and nextThreadIndex
+    std::mutex drainMtx; // one consumer at a time; guards sink writes
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::ostream* sink;
+    int nextThreadIndex = 0;
+
+    std::thread drainer;
+    std::condition_variable wake;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> droppedCount{0};
+
+    Logger();
+    Ring& localRing();
+    void drainLoop();
+    size_t drainOnce(std::string& batch); // caller holds drainMtx
+    static void format(const Record& record, int threadIndex, std::string& out);
+
+public:
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static Logger& instance();
+
+    // The only cost of a disabled statement: one relaxed load and a compare
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= threshold.load(std::memory_order_relaxed);
+    }
+    static void setLevel(LogLevel level) { threshold.store(static_cast<int>(level), std::memory_order_relaxed); }
+    static LogLevel level() { return static_cast<LogLevel>(threshold.load(std::memory_order_relaxed)); }
+    static bool parseLevel(const std::string& name, LogLevel& out);
+    static const char* levelName(LogLevel level);
+
+    // Defaults to std::clog. Call before start().
+    void setSink(std::ostream* out);
+
+    void start();
+    void stop();  // drains everything queued so far, then joins the drain thread
+    void flush(); // blocks until every ring has been drained once
+
+    void write(LogLevel level, const char* file, int line, std::string&& message);
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+};
+
+#define UNIRIDE_LOG(lvl, expr)                                                                  \
+    do {                                                                                        \
+        if (static_cast<int>(lvl) >= UNIRIDE_LOG_MIN_LEVEL && Logger::isEnabled(lvl)) {         \
+            std::ostringstream uniride_log_stream;                                              \
+            uniride_log_stream << expr;                                                         \
+            Logger::instance().write(lvl, __FILE__, __LINE__, uniride_log_stream.str());        \
+        }                                                                                       \
+    } while (0)
+
+#define LOG_TRACE(expr) UNIRIDE_LOG(LogLevel::Trace, expr)
+#define LOG_DEBUG(expr) UNIRIDE_LOG(LogLevel::Debug, expr)
+#define LOG_INFO(expr) UNIRIDE_LOG(LogLevel::Info, expr)
+#define LOG_WARN(expr) UNIRIDE_LOG(LogLevel::Warn, expr)
+#define LOG_ERROR(expr) UNIRIDE_LOG(LogLevel::Error, expr)
+
+#endif // LOGGER_H
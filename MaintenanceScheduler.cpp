@@ -0,0 +1,101 @@
+#include "MaintenanceScheduler.h"
+#include "Logger.h"
+#include "Tracer.h"
+
+MaintenanceScheduler::MaintenanceScheduler(std::chrono::milliseconds tickLength, size_t slots)
+    : tick(tickLength.count() > 0 ? tickLength : std::chrono::milliseconds(1)), wheel(slots == 0 ? 1 : slots) {}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    stop();
+}
+
+// Caller holds mtx. A delay of d ticks lands in slot (now + d) and passes
+// that slot (d - 1) / slots times before it is due.
+void MaintenanceScheduler::schedule(size_t timer, uint64_t delayTicks) {
+    if (delayTicks == 0) delayTicks = 1;
+    timers[timer].rounds = (delayTicks - 1) / wheel.size();
+    wheel[(now + delayTicks) % wheel.size()].push_back(timer);
+}
+
+void MaintenanceScheduler::every(const std::string& name, std::chrono::milliseconds interval, size_t batch, Job job) {
+    std::lock_guard<std::mutex> lock(mtx);
+    uint64_t ticks = (interval.count() + tick.count() - 1) / tick.count();
+    timers.push_back(Timer{name, ticks == 0 ? 1 : ticks, batch == 0 ? 1 : batch, std::move(job)});
+    schedule(timers.size() - 1, timers.back().intervalTicks);
+}
+
+void MaintenanceScheduler::advance(uint64_t ticks) {
+    for (uint64_t t = 0; t < ticks; ++t) {
+        std::vector<size_t> due;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++now;
+            auto& slot = wheel[now % wheel.size()];
+            for (size_t i = 0; i < slot.size();) {
+                Timer& timer = timers[slot[i]];
+                if (timer.rounds > 0) {
+                    --timer.rounds;
+                    ++i;
+                    continue;
+                }
+                due.push_back(slot[i]);
+                slot[i] = slot.back();
+                slot.pop_back();
+            }
+        }
+
+        // Jobs run without the lock; timers is only resized by every()
+        for (size_t index : due) {
+            Timer& timer = timers[index];
+            size_t handled = 0;
+            try {
+                TRACE_SPAN("maintenance.job", "maintenance");
+                handled = timer.job(timer.batch);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Maintenance job '" << timer.name << "' threw: " << e.what());
+            } catch (...) {
+                LOG_ERROR("Maintenance job '" << timer.name << "' threw an unknown exception");
+            }
+
+            std::lock_guard<std::mutex> lock(mtx);
+            ++timer.runs;
+            timer.items += handled;
+            schedule(index, handled >= timer.batch ? 1 : timer.intervalTicks);
+        }
+    }
+}
+
+void MaintenanceScheduler::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!wake.wait_for(lock, tick, [this]() { return stopping; })) {
+        lock.unlock();
+        advance(1);
+        lock.lock();
+    }
+}
+
+void MaintenanceScheduler::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (worker.joinable() || stopping) return;
+    worker = std::thread(&MaintenanceScheduler::run, this);
+    LOG_INFO("Maintenance scheduler started: " << timers.size() << " jobs, tick " << tick.count() << " ms");
+}
+
+void MaintenanceScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+std::vector<MaintenanceScheduler::JobStats> MaintenanceScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<JobStats> result;
+    result.reserve(timers.size());
+    for (const auto& timer : timers) {
+        result.push_back(JobStats{timer.name, timer.runs, timer.items});
+    }
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef MAINTENANCESCHEDULER_H
+#define MAINTENANCESCHEDULER_H
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Periodic background jobs on a hashed timer wheel: one slot per tick, each
+// timer parked in the slot of its next due tick with the number of full
+// turns still to wait. A tick only looks at one slot, so the cost does not
+// grow with the number of idle timers.
+//
+// A job does one small slice of work and returns how many items it handled.
+// A full slice (== batch) means more is waiting, so the job runs again on
+// the next tick instead of after its interval; backlogs drain in short
+// steps with the DB free to serve handlers in between.
+class MaintenanceScheduler {
+public:
+    using Job = std::function<size_t(size_t batch)>;
+
+    struct JobStats {
+        std::string name;
+        uint64_t runs = 0;
+        uint64_t items = 0;
+    };
+
+private:
+    struct Timer {
+        std::string name;
+        uint64_t intervalTicks;
+        size_t batch;
+        Job job;
+        uint64_t rounds = 0; // full wheel turns left before it fires
+        uint64_t runs = 0;
+        uint64_t items = 0;
+    };
+
+    std::chrono::milliseconds tick;
+    std::vector<std::vector<size_t>> wheel; // slot -> indexes into timers
+    std::vector<Timer> timers;
+    uint64_t now = 0; // ticks since start
+    mutable std::mutex mtx; // guards wheel, timers' schedule and stats, stopping
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void schedule(size_t timer, uint64_t delayTicks);
+    void run();
+
+public:
+    explicit MaintenanceScheduler(std::chrono::milliseconds tickLength = std::chrono::seconds(1), size_t slots = 64);
+    ~MaintenanceScheduler();
+    MaintenanceScheduler(const MaintenanceScheduler&) = delete;
+    MaintenanceScheduler& operator=(const MaintenanceScheduler&) = delete;
+
+    // Runs `job` every `interval` (rounded up to whole ticks), first after one
+    // interval. Register jobs before start().
+    void every(const std::string& name, std::chrono::milliseconds interval, size_t batch, Job job);
+
+    // Ticks on a background thread until stop(); stop() waits for a running job
+    void start();
+    void stop();
+
+    // Runs `ticks` ticks on the calling thread; for tools and benchmarks
+    void advance(uint64_t ticks = 1);
+
+    std::vector<JobStats> stats() const;
+};
+
+#endif // MAINTENANCESCHEDULER_H
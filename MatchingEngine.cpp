@@ -0,0 +1,253 @@
+#include "MatchingEngine.h"
+#include <algorithm>
+
+namespace {
+
+using ByteColumn = uint8_t (OpenRideBlock::*)[OpenRideBlock::CAPACITY];
+
+class InSetU8Filter : public BoundStage {
+    ByteColumn column;
+    uint16_t allowed;
+    const SelectionKernels& kernels;
+
+public:
+    InSetU8Filter(ByteColumn col, uint16_t allowedValues, const SelectionKernels& k)
+        : column(col), allowed(allowedValues), kernels(k) {}
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        kernels.inSetU8(block.*column, block.rows, allowed, bits);
+    }
+};
+
+class CapacityFilter : public BoundStage {
+    const SelectionKernels& kernels;
+
+public:
+    explicit CapacityFilter(const SelectionKernels& k) : kernels(k) {}
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        kernels.lessU8(block.currentCapacity, block.maxCapacity, block.rows, bits);
+    }
+};
+
+class OwnerFilter : public BoundStage {
+    uint32_t owner;
+    const SelectionKernels& kernels;
+
+public:
+    OwnerFilter(uint32_t excluded, const SelectionKernels& k) : owner(excluded), kernels(k) {}
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        kernels.notEqualU32(block.owners, block.rows, owner, bits);
+    }
+};
+
+class GenderFilter : public BoundStage {
+    InSetU8Filter femalesOnly;
+    InSetU8Filter preference;
+
+public:
+    GenderFilter(InSetU8Filter visible, InSetU8Filter offered) : femalesOnly(visible), preference(offered) {}
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        femalesOnly.apply(block, bits);
+        preference.apply(block, bits);
+    }
+};
+
+class ProximityFilter : public BoundStage {
+    std::vector<int32_t> nearFrom;
+    std::vector<int32_t> nearTo;
+    const SelectionKernels& kernels;
+
+    // mask[a] is -1 for areas within reach of `area`, 0 otherwise
+    static std::vector<int32_t> nearMask(const LocationGraph& graph, size_t areas, const std::string& area) {
+        std::vector<int32_t> mask(areas, 0);
+        uint32_t handle = graph.findArea(area);
+        if (handle == LocationGraph::NO_AREA || handle >= areas) return mask;
+        mask[handle] = -1;
+        for (uint32_t neighbour : graph.neighbours(handle)) {
+            if (neighbour < areas) mask[neighbour] = -1;
+        }
+        return mask;
+    }
+
+public:
+    // Sized to every area interned so far, which covers each handle in any
+    // snapshot taken before bind()
+    ProximityFilter(const LocationGraph& graph, const MatchRequest& request, const SelectionKernels& k)
+        : nearFrom(nearMask(graph, graph.areaCount(), request.from)),
+          nearTo(nearMask(graph, graph.areaCount(), request.to)),
+          kernels(k) {}
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        kernels.lookupU32(block.fromAreas, block.rows, nearFrom.data(), bits);
+        kernels.lookupU32(block.toAreas, block.rows, nearTo.data(), bits);
+    }
+};
+
+class DepartureFilter : public BoundStage {
+    uint32_t low;
+    uint32_t high;
+    const SelectionKernels& kernels;
+
+public:
+    DepartureFilter(uint32_t from, uint32_t until, const SelectionKernels& k) : low(from), high(until), kernels(k) {}
+    bool admits(const OpenRideBlock& block) const override {
+        return block.departMin <= high && block.departMax >= low;
+    }
+    void apply(const OpenRideBlock& block, uint64_t* bits) const override {
+        kernels.overlapsU32(block.departFrom, block.departUntil, block.rows, low, high, bits);
+    }
+};
+
+uint32_t clampSeconds(int64_t seconds) {
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(seconds, 0), UINT32_MAX));
+}
+
+uint16_t bit(uint8_t value) {
+    return static_cast<uint16_t>(1u << value);
+}
+
+} // namespace
+
+// --- Built-in stages ---
+std::unique_ptr<BoundStage> DepartureWindowStage::bind(const MatchRequest& request, const OpenRideTable& table) const {
+    if (request.departAt <= 0) return nullptr;
+    int64_t window = std::min(std::max(request.departWindow, 0), MAX_DEPART_WINDOW);
+    return std::make_unique<DepartureFilter>(clampSeconds(request.departAt - window), clampSeconds(request.departAt + window),
+                                             table.kernels());
+}
+
+std::unique_ptr<BoundStage> RideTypeStage::bind(const MatchRequest& request, const OpenRideTable& table) const {
+    return std::make_unique<InSetU8Filter>(&OpenRideBlock::rideTypes, bit(static_cast<uint8_t>(request.rideType)), table.kernels());
+}
+
+std::unique_ptr<BoundStage> CapacityStage::bind(const MatchRequest&, const OpenRideTable& table) const {
+    return std::make_unique<CapacityFilter>(table.kernels());
+}
+
+// femalesOnly bit 0 admits regular rides, bit 1 females-only rides:
+//   male or unknown gender      -> regular rides only
+//   female                      -> both
+//   female wanting females-only -> females-only rides only
+std::unique_ptr<BoundStage> GenderVisibilityStage::bind(const MatchRequest& request, const OpenRideTable& table) const {
+    uint16_t visible = bit(0);
+    if (request.userGender == "female") visible = request.wantsFemalesOnly ? bit(1) : bit(0) | bit(1);
+    if (request.genderPreference.empty()) {
+        return std::make_unique<InSetU8Filter>(&OpenRideBlock::femalesOnly, visible, table.kernels());
+    }
+
+    uint16_t offered = bit(static_cast<uint8_t>(GenderPreference::ANY));
+    GenderPreference wanted = stringToGenderPreference(request.genderPreference);
+    if (wanted == GenderPreference::FEMALE || wanted == GenderPreference::MALE) offered |= bit(static_cast<uint8_t>(wanted));
+    return std::make_unique<GenderFilter>(InSetU8Filter(&OpenRideBlock::femalesOnly, visible, table.kernels()),
+                                          InSetU8Filter(&OpenRideBlock::genderPreferences, offered, table.kernels()));
+}
+
+std::unique_ptr<BoundStage> OwnerExclusionStage::bind(const MatchRequest& request, const OpenRideTable& table) const {
+    uint32_t owner = table.strings().find(request.userID);
+    if (owner == StringInterner::NONE) return nullptr; // owns nothing in the table
+    return std::make_unique<OwnerFilter>(owner, table.kernels());
+}
+
+std::unique_ptr<BoundStage> ProximityStage::bind(const MatchRequest& request, const OpenRideTable& table) const {
+    const LocationGraph& graph = table.locationGraph();
+    if (!graph.isInitialized()) return nullptr; // no graph: every area is reachable
+    return std::make_unique<ProximityFilter>(graph, request, table.kernels());
+}
+
+double FullestFirstScorer::score(const OpenRideBlock& block, uint32_t row, const MatchRequest&) const {
+    return block.maxCapacity[row] ? double(block.currentCapacity[row]) / block.maxCapacity[row] : 0.0;
+}
+
+// --- Engine ---
+MatchingEngine::MatchingEngine(OpenRideTable& table) : rides(table) {
+    addStage(std::make_unique<DepartureWindowStage>()); // first: may skip whole blocks
+    addStage(std::make_unique<RideTypeStage>());
+    addStage(std::make_unique<CapacityStage>());
+    addStage(std::make_unique<GenderVisibilityStage>());
+    addStage(std::make_unique<OwnerExclusionStage>());
+    addStage(std::make_unique<ProximityStage>()); // last: the gathers cost the most, and skip words already cleared
+}
+
+void MatchingEngine::addStage(std::unique_ptr<MatchStage> stage) {
+    stages.push_back(std::move(stage));
+}
+
+void MatchingEngine::clearStages() {
+    stages.clear();
+}
+
+void MatchingEngine::setScorer(std::unique_ptr<MatchScorer> rideScorer) {
+    scorer = std::move(rideScorer);
+}
+
+std::vector<std::string> MatchingEngine::stageNames() const {
+    std::vector<std::string> names;
+    for (const auto& stage : stages) names.push_back(stage->name());
+    return names;
+}
+
+template <typename Visit>
+void MatchingEngine::scan(const OpenRideSnapshot& snapshot, const MatchRequest& request, Visit&& visit) const {
+    std::vector<std::unique_ptr<BoundStage>> bound;
+    for (const auto& stage : stages) {
+        if (auto filter = stage->bind(request, rides)) bound.push_back(std::move(filter));
+    }
+
+    uint64_t bits[OpenRideBlock::WORDS];
+    for (const auto& blockPtr : snapshot.blocks) {
+        const OpenRideBlock& block = *blockPtr;
+        bool admitted = true;
+        for (const auto& filter : bound) admitted = admitted && filter->admits(block);
+        if (!admitted) continue;
+
+        uint32_t words = (block.rows + 63) / 64;
+        std::fill(bits, bits + words, ~uint64_t(0));
+        if (block.rows % 64) bits[words - 1] = (uint64_t(1) << (block.rows % 64)) - 1;
+
+        for (const auto& filter : bound) filter->apply(block, bits);
+
+        for (uint32_t w = 0; w < words; ++w) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                visit(block, w * 64 + static_cast<uint32_t>(__builtin_ctzll(word)));
+            }
+        }
+    }
+}
+
+std::pmr::vector<MatchingEngine::Candidate> MatchingEngine::rank(const OpenRideSnapshot& snapshot, const MatchRequest& request,
+                                                                 size_t limit, std::pmr::memory_resource* memory) const {
+    std::pmr::vector<Candidate> candidates(memory);
+    scan(snapshot, request, [&](const OpenRideBlock& block, uint32_t row) {
+        double score = scorer ? scorer->score(block, row, request) : 0.0;
+        candidates.push_back({score, block.rideIDs[row], &block, row});
+    });
+
+    auto better = [](const Candidate& a, const Candidate& b) {
+        return a.score != b.score ? a.score > b.score : a.rideID < b.rideID;
+    };
+    size_t keep = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), better);
+    candidates.resize(keep);
+    return candidates;
+}
+
+std::vector<Ride> MatchingEngine::match(const MatchRequest& request, size_t limit) const {
+    auto snapshot = rides.snapshot(); // keeps the blocks alive until rides are materialized
+    auto best = rank(*snapshot, request, limit, std::pmr::get_default_resource());
+    std::vector<Ride> matches;
+    matches.reserve(best.size());
+    for (const Candidate& c : best) matches.push_back(rides.materialize(*c.block, c.row));
+    return matches;
+}
+
+void MatchingEngine::match(const MatchRequest& request, std::pmr::vector<RideView>& out, size_t limit) const {
+    auto snapshot = rides.snapshot();
+    auto best = rank(*snapshot, request, limit, out.get_allocator().resource());
+    out.reserve(out.size() + best.size());
+    for (const Candidate& c : best) out.push_back(rides.view(*c.block, c.row));
+}
+
+size_t MatchingEngine::count(const MatchRequest& request) const {
+    auto snapshot = rides.snapshot();
+    size_t total = 0;
+    scan(*snapshot, request, [&total](const OpenRideBlock&, uint32_t) { ++total; });
+    return total;
+}
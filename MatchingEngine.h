@@ -0,0 +1,151 @@
+#ifndef MATCHINGENGINE_H
+#define MATCHINGENGINE_H
+
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "OpenRideTable.h"
+#include "Ride.h"
+
+// Who is searching and for what. Gender is resolved by the caller, once per search.
+struct MatchRequest {
+    std::string from;
+    std::string to;
+    RideType rideType = RideType::CARPOOL;
+    std::string userID;           // the searcher's own rides are never matched
+    std::string userGender;       // "female", "male", or empty when unknown
+    bool wantsFemalesOnly = false;
+    std::string genderPreference; // rides must be offered to "any" or this; empty skips the check
+    int64_t departAt = 0;         // rider's departure, unix seconds; 0 matches any time
+    int departWindow = 0;         // rider's tolerance either side of departAt, seconds
+};
+
+// A stage prepared for one search. apply() clears the bits of rows in
+// `block` that the stage rejects. admits() may rule out a whole block from
+// its header alone, before any column is read.
+class BoundStage {
+public:
+    virtual ~BoundStage() = default;
+    virtual bool admits(const OpenRideBlock&) const { return true; }
+    virtual void apply(const OpenRideBlock& block, uint64_t* bits) const = 0;
+};
+
+// One filter in the pipeline. bind() does the per-search work (handle
+// lookups, area masks) so apply() is a column kernel per block. It returns
+// nullptr when the stage keeps every row for this request.
+class MatchStage {
+public:
+    virtual ~MatchStage() = default;
+    virtual const char* name() const = 0;
+    virtual std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const = 0;
+};
+
+// Orders the surviving rides; higher scores come first, ties by ride ID
+class MatchScorer {
+public:
+    virtual ~MatchScorer() = default;
+    virtual double score(const OpenRideBlock& block, uint32_t row, const MatchRequest& request) const = 0;
+};
+
+// Built-in stages, in the order the default pipeline runs them
+
+// The ride's departure window must overlap the rider's. Skipped for riders
+// without a departure time; unscheduled rides overlap every window.
+class DepartureWindowStage : public MatchStage {
+public:
+    const char* name() const override { return "departureWindow"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+class RideTypeStage : public MatchStage {
+public:
+    const char* name() const override { return "rideType"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+class CapacityStage : public MatchStage {
+public:
+    const char* name() const override { return "capacity"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+// Females-only rides are shown to female users only, and a female user who
+// asks for females-only rides sees nothing else. Also applies the request's
+// genderPreference against the ride's gender_preference.
+class GenderVisibilityStage : public MatchStage {
+public:
+    const char* name() const override { return "genderVisibility"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+class OwnerExclusionStage : public MatchStage {
+public:
+    const char* name() const override { return "ownerExclusion"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+// Both endpoints must be the searched area or one of its LocationGraph neighbours
+class ProximityStage : public MatchStage {
+public:
+    const char* name() const override { return "proximity"; }
+    std::unique_ptr<BoundStage> bind(const MatchRequest& request, const OpenRideTable& table) const override;
+};
+
+// Rides closest to full first, so groups fill before new ones are started
+class FullestFirstScorer : public MatchScorer {
+public:
+    double score(const OpenRideBlock& block, uint32_t row, const MatchRequest& request) const override;
+};
+
+// The one ride matcher behind RideSystem and DatabaseManager. Each search
+// takes a snapshot of the OpenRideTable, binds every stage, then runs the
+// stages block by block over a selection bitmap. Only the surviving rows are
+// turned back into Ride objects.
+class MatchingEngine {
+private:
+    OpenRideTable& rides;
+    std::vector<std::unique_ptr<MatchStage>> stages;
+    std::unique_ptr<MatchScorer> scorer; // nullptr: order by ride ID
+
+    struct Candidate {
+        double score;
+        int32_t rideID;
+        const OpenRideBlock* block;
+        uint32_t row;
+    };
+
+    // Calls visit(block, row) for every row of `snapshot` that passes all stages
+    template <typename Visit>
+    void scan(const OpenRideSnapshot& snapshot, const MatchRequest& request, Visit&& visit) const;
+    // The best `limit` matching rows of `snapshot`, in result order
+    std::pmr::vector<Candidate> rank(const OpenRideSnapshot& snapshot, const MatchRequest& request, size_t limit,
+                                     std::pmr::memory_resource* memory) const;
+
+public:
+    // Starts with the built-in stages: departure window, ride type, capacity,
+    // gender visibility, owner exclusion, proximity
+    explicit MatchingEngine(OpenRideTable& table);
+
+    // Stages run in the order added; configure before searches start
+    void addStage(std::unique_ptr<MatchStage> stage);
+    void clearStages();
+    void setScorer(std::unique_ptr<MatchScorer> rideScorer);
+    std::vector<std::string> stageNames() const;
+
+    // Matching rides, best first, at most `limit` of them
+    std::vector<Ride> match(const MatchRequest& request, size_t limit = std::numeric_limits<size_t>::max()) const;
+    // Same, as views appended to `out`; scratch space comes from out's memory
+    // resource, so a request arena keeps the whole search off the heap
+    void match(const MatchRequest& request, std::pmr::vector<RideView>& out,
+               size_t limit = std::numeric_limits<size_t>::max()) const;
+    // Number of matching rides, without materializing them
+    size_t count(const MatchRequest& request) const;
+
+    OpenRideTable& table() const { return rides; }
+};
+
+#endif // MATCHINGENGINE_H
@@ -0,0 +1,221 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <sstream>
+
+static int highestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    int bit = 0;
+    while (v >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+int LatencyBuckets::indexFor(uint64_t micros) {
+    if (micros < SUB_BUCKETS) return static_cast<int>(micros);
+    int msb = highestBit(micros);
+    int index = (msb - 1) * SUB_BUCKETS + static_cast<int>((micros >> (msb - 2)) & (SUB_BUCKETS - 1));
+    return index < COUNT ? index : COUNT - 1;
+}
+
+double LatencyBuckets::upperBoundMicros(int index) {
+    if (index < SUB_BUCKETS) return index + 1;
+    int msb = index / SUB_BUCKETS + 1;
+    int sub = index % SUB_BUCKETS;
+    return static_cast<double>(static_cast<uint64_t>(SUB_BUCKETS + sub + 1) << (msb - 2));
+}
+
+// Single-writer increment: only the owning thread writes its shard
+static inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+Metrics::Metrics() {
+    routeNames.push_back("other");
+    routeIDs["other"] = 0;
+}
+
+Metrics::ThreadShard& Metrics::localShard() {
+    thread_local const Metrics* owner = nullptr;
+    thread_local ThreadShard* shard = nullptr;
+    if (owner != this) {
+        std::lock_guard<std::mutex> lock(mtx);
+        shards.push_back(std::make_unique<ThreadShard>());
+        shard = shards.back().get();
+        owner = this;
+    }
+    return *shard;
+}
+
+void Metrics::registerRoute(const std::string& route) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (routeIDs.count(route) || static_cast<int>(routeNames.size()) >= MAX_ROUTES) return;
+    routeIDs[route] = static_cast<int>(routeNames.size());
+    routeNames.push_back(route);
+}
+
+int Metrics::routeID(const std::string& route) {
+    // Per-thread cache so the shared table is only locked the first time a
+    // thread sees a route. It is capped: unregistered paths are client
+    // controlled, so once full, misses go to the shared table uncached.
+    static constexpr size_t CACHE_LIMIT = 4 * MAX_ROUTES;
+    thread_local const Metrics* owner = nullptr;
+    thread_local std::unordered_map<std::string, int> cache;
+    if (owner != this) {
+        cache.clear();
+        owner = this;
+    }
+    auto cached = cache.find(route);
+    if (cached != cache.end()) return cached->second;
+
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = routeIDs.find(route);
+        if (it != routeIDs.end()) id = it->second;
+    }
+    if (cache.size() < CACHE_LIMIT) cache[route] = id;
+    return id;
+}
+
+void Metrics::recordRequest(const std::string& route, int statusCode, uint64_t micros) {
+    RouteShard& stats = localShard().routes[routeID(route)];
+    int statusClass = statusCode / 100;
+    bump(stats.requests[(statusClass >= 1 && statusClass <= 5) ? statusClass : 0]);
+    bump(stats.buckets[LatencyBuckets::indexFor(micros)]);
+    bump(stats.sumMicros, micros);
+}
+
+void Metrics::registerGauge(const std::string& name, const std::string& help, std::function<double()> sample) {
+    std::lock_guard<std::mutex> lock(mtx);
+    gauges.push_back({name, {help, std::move(sample)}});
+}
+
+// Label values escape backslash, double quote and newline
+static std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\') escaped += "\\\\";
+        else if (c == '"') escaped += "\\\"";
+        else if (c == '\n') escaped += "\\n";
+        else escaped += c;
+    }
+    return escaped;
+}
+
+std::string Metrics::renderPrometheus() const {
+    static const char* statusLabels[STATUS_CLASSES] = {"other", "1xx", "2xx", "3xx", "4xx", "5xx"};
+
+    std::vector<std::string> names;
+    std::vector<std::array<uint64_t, STATUS_CLASSES>> requests;
+    std::vector<std::array<uint64_t, LatencyBuckets::COUNT>> buckets;
+    std::vector<uint64_t> sums;
+    decltype(gauges) gaugeList;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        names.reserve(routeNames.size());
+        for (const auto& name : routeNames) names.push_back(escapeLabel(name));
+        gaugeList = gauges;
+        requests.assign(names.size(), {});
+        buckets.assign(names.size(), {});
+        sums.assign(names.size(), 0);
+        for (const auto& shard : shards) {
+            for (size_t r = 0; r < names.size(); ++r) {
+                const RouteShard& stats = shard->routes[r];
+                for (int c = 0; c < STATUS_CLASSES; ++c) requests[r][c] += stats.requests[c].load(std::memory_order_relaxed);
+                for (int b = 0; b < LatencyBuckets::COUNT; ++b) buckets[r][b] += stats.buckets[b].load(std::memory_order_relaxed);
+                sums[r] += stats.sumMicros.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::ostringstream out;
+    char num[64];
+
+    out << "# HELP uniride_http_requests_total HTTP requests by route and status class.\n";
+    out << "# TYPE uniride_http_requests_total counter\n";
+    for (size_t r = 0; r < names.size(); ++r) {
+        for (int c = 0; c < STATUS_CLASSES; ++c) {
+            if (requests[r][c] == 0) continue;
+            out << "uniride_http_requests_total{route=\"" << names[r] << "\",code=\"" << statusLabels[c] << "\"} " << requests[r][c] << "\n";
+        }
+    }
+
+    out << "# HELP uniride_http_request_duration_seconds Request latency by route.\n";
+    out << "# TYPE uniride_http_request_duration_seconds histogram\n";
+    std::ostringstream quantiles;
+    for (size_t r = 0; r < names.size(); ++r) {
+        uint64_t total = 0;
+        for (uint64_t n : buckets[r]) total += n;
+        if (total == 0) continue;
+
+        // Expose one cumulative bucket per power of two; the full resolution
+        // is used for the quantile gauges below
+        uint64_t cumulative = 0;
+        for (int b = 0; b < LatencyBuckets::COUNT; ++b) {
+            cumulative += buckets[r][b];
+            if ((b + 1) % LatencyBuckets::SUB_BUCKETS != 0) continue;
+            std::snprintf(num, sizeof(num), "%g", LatencyBuckets::upperBoundMicros(b) / 1e6);
+            out << "uniride_http_request_duration_seconds_bucket{route=\"" << names[r] << "\",le=\"" << num << "\"} " << cumulative << "\n";
+        }
+        out << "uniride_http_request_duration_seconds_bucket{route=\"" << names[r] << "\",le=\"+Inf\"} " << total << "\n";
+        std::snprintf(num, sizeof(num), "%g", sums[r] / 1e6);
+        out << "uniride_http_request_duration_seconds_sum{route=\"" << names[r] << "\"} " << num << "\n";
+        out << "uniride_http_request_duration_seconds_count{route=\"" << names[r] << "\"} " << total << "\n";
+
+        const double targets[] = {0.5, 0.9, 0.99};
+        for (double q : targets) {
+            uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+            uint64_t seen = 0;
+            int b = 0;
+            for (; b < LatencyBuckets::COUNT; ++b) {
+                seen += buckets[r][b];
+                if (seen >= rank && seen > 0) break;
+            }
+            std::snprintf(num, sizeof(num), "%g", LatencyBuckets::upperBoundMicros(b) / 1e6);
+            quantiles << "uniride_http_request_latency_quantile_seconds{route=\"" << names[r] << "\",quantile=\"" << q << "\"} " << num << "\n";
+        }
+    }
+    out << "# HELP uniride_http_request_latency_quantile_seconds Latency quantiles from the full-resolution histogram.\n";
+    out << "# TYPE uniride_http_request_latency_quantile_seconds gauge\n";
+    out << quantiles.str();
+
+    for (const auto& gauge : gaugeList) {
+        out << "# HELP " << gauge.first << " " << gauge.second.first << "\n";
+        out << "# TYPE " << gauge.first << " gauge\n";
+        std::snprintf(num, sizeof(num), "%g", gauge.second.second());
+        out << gauge.first << " " << num << "\n";
+    }
+
+    return out.str();
+}
+
+std::string Metrics::normalizeRoute(const std::string& method, const std::string& url) {
+    std::string route = method + " ";
+    std::string path = url.substr(0, url.find('?'));
+    std::string previous;
+
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t next = path.find('/', pos + 1);
+        std::string segment = path.substr(pos + 1, next == std::string::npos ? std::string::npos : next - pos - 1);
+        route += "/";
+
+        bool numeric = !segment.empty() && segment.find_first_not_of("0123456789") == std::string::npos;
+        if (numeric) {
+            route += "<int>";
+        } else if ((previous == "user" && segment != "preferences") || previous == "preferences") {
+            route += "<string>";
+        } else {
+            route += segment;
+        }
+
+        previous = segment;
+        if (next == std::string::npos) break;
+        pos = next;
+    }
+    if (path.empty()) route += "/";
+    return route;
+}
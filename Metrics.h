@@ -0,0 +1,75 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Log-linear (HDR-style) latency histogram: SUB_BUCKETS buckets per power of
+// two of microseconds, covering 1us up to ~2^OCTAVES us (~134 s).
+struct LatencyBuckets {
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int OCTAVES = 28;
+    static constexpr int COUNT = SUB_BUCKETS * OCTAVES;
+
+    static int indexFor(uint64_t micros);
+    static double upperBoundMicros(int index);
+};
+
+// Request counters and latency histograms per route, recorded into
+// per-thread shards so the hot path is a handful of uncontended relaxed
+// atomic stores. Shards are merged only when /metrics is scraped.
+class Metrics {
+public:
+    static constexpr int MAX_ROUTES = 64;
+    static constexpr int STATUS_CLASSES = 6; // index 1..5 => 1xx..5xx, 0 => other
+
+    struct RouteShard {
+        std::array<std::atomic<uint64_t>, STATUS_CLASSES> requests{};
+        std::array<std::atomic<uint64_t>, LatencyBuckets::COUNT> buckets{};
+        std::atomic<uint64_t> sumMicros{0};
+    };
+
+    struct ThreadShard {
+        std::array<RouteShard, MAX_ROUTES> routes;
+    };
+
+private:
+    mutable std::mutex mtx; // guards routeNames, shards and gauges (never the record path)
+    std::vector<std::string> routeNames; // registered up front; index 0 is "other"
+    std::unordered_map<std::string, int> routeIDs;
+    std::vector<std::unique_ptr<ThreadShard>> shards;
+    std::vector<std::pair<std::string, std::pair<std::string, std::function<double()>>>> gauges;
+
+    ThreadShard& localShard();
+    int routeID(const std::string& route);
+
+public:
+    Metrics();
+
+    // Give a normalized route ("GET /ride/<int>/requests") its own series.
+    // Register every served route before app.run(); there are MAX_ROUTES
+    // slots and later registrations past that are ignored.
+    void registerRoute(const std::string& route);
+
+    // Record one finished request. `route` should already be normalized;
+    // routes that were never registered (404s, scanners) count as "other".
+    void recordRequest(const std::string& route, int statusCode, uint64_t micros);
+
+    // Gauge sampled at scrape time, e.g. live rides or queue depth
+    void registerGauge(const std::string& name, const std::string& help, std::function<double()> sample);
+
+    // Prometheus text exposition format
+    std::string renderPrometheus() const;
+
+    // "/ride/42/requests" -> "/ride/<int>/requests", "/user/abc/rides" -> "/user/<string>/rides"
+    static std::string normalizeRoute(const std::string& method, const std::string& url);
+};
+
+#endif // METRICS_H
@@ -0,0 +1,31 @@
+#ifndef METRICSMIDDLEWARE_H
+#define METRICSMIDDLEWARE_H
+
+#pragma once
+#include <chrono>
+#include "Metrics.h"
+#include "crow.h"
+
+// Times every request and records it under its normalized route.
+// Set `metrics` before app.run(); requests are ignored while it is null.
+struct MetricsMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+    };
+
+    Metrics* metrics = nullptr;
+
+    void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        ctx.start = std::chrono::steady_clock::now();
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        if (!metrics) return;
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - ctx.start).count();
+        metrics->recordRequest(Metrics::normalizeRoute(crow::method_name(req.method), req.url),
+                               res.code, static_cast<uint64_t>(elapsed));
+    }
+};
+
+#endif // METRICSMIDDLEWARE_H
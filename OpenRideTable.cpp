@@ -0,0 +1,420 @@
+#include "OpenRideTable.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UNIRIDE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// --- Predicate kernels ---
+// Rows past n are never set, so the tail word needs no mask.
+
+namespace {
+
+void inSetU8Scalar(const uint8_t* col, size_t n, uint16_t allowed, uint64_t* bits) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = std::min(n, base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; ++i) word |= uint64_t((allowed >> col[i]) & 1) << (i - base);
+        bits[base / 64] &= word;
+    }
+}
+
+void lessU8Scalar(const uint8_t* a, const uint8_t* b, size_t n, uint64_t* bits) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = std::min(n, base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; ++i) word |= uint64_t(a[i] < b[i]) << (i - base);
+        bits[base / 64] &= word;
+    }
+}
+
+void notEqualU32Scalar(const uint32_t* col, size_t n, uint32_t value, uint64_t* bits) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = std::min(n, base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; ++i) word |= uint64_t(col[i] != value) << (i - base);
+        bits[base / 64] &= word;
+    }
+}
+
+void lookupU32Scalar(const uint32_t* col, size_t n, const int32_t* lookup, uint64_t* bits) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = std::min(n, base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; ++i) word |= uint64_t(lookup[col[i]] != 0) << (i - base);
+        bits[base / 64] &= word;
+    }
+}
+
+void overlapsU32Scalar(const uint32_t* from, const uint32_t* until, size_t n, uint32_t lo, uint32_t hi, uint64_t* bits) {
+    for (size_t base = 0; base < n; base += 64) {
+        size_t end = std::min(n, base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; ++i) word |= uint64_t(from[i] <= hi && until[i] >= lo) << (i - base);
+        bits[base / 64] &= word;
+    }
+}
+
+const SelectionKernels SCALAR_KERNELS = {inSetU8Scalar, lessU8Scalar, notEqualU32Scalar, lookupU32Scalar, overlapsU32Scalar};
+
+#ifdef UNIRIDE_X86_SIMD
+// Full 64-row words use AVX2; the partial tail word reuses the scalar kernel
+
+__attribute__((target("avx2")))
+void inSetU8Avx2(const uint8_t* col, size_t n, uint16_t allowed, uint64_t* bits) {
+    alignas(32) uint8_t lut[32];
+    for (int i = 0; i < 16; ++i) lut[i] = lut[i + 16] = ((allowed >> i) & 1) ? 0xFF : 0;
+    const __m256i table = _mm256_load_si256(reinterpret_cast<const __m256i*>(lut));
+    size_t words = n / 64;
+    for (size_t w = 0; w < words; ++w) {
+        const uint8_t* p = col + w * 64;
+        __m256i lo = _mm256_shuffle_epi8(table, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        __m256i hi = _mm256_shuffle_epi8(table, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)));
+        bits[w] &= uint64_t(uint32_t(_mm256_movemask_epi8(lo))) | uint64_t(uint32_t(_mm256_movemask_epi8(hi))) << 32;
+    }
+    if (words * 64 < n) inSetU8Scalar(col + words * 64, n - words * 64, allowed, bits + words);
+}
+
+__attribute__((target("avx2")))
+void lessU8Avx2(const uint8_t* a, const uint8_t* b, size_t n, uint64_t* bits) {
+    size_t words = n / 64;
+    for (size_t w = 0; w < words; ++w) {
+        uint64_t atLeast = 0; // a >= b exactly when max(a, b) == a
+        for (int half = 0; half < 2; ++half) {
+            size_t offset = w * 64 + half * 32;
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + offset));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + offset));
+            __m256i ge = _mm256_cmpeq_epi8(_mm256_max_epu8(va, vb), va);
+            atLeast |= uint64_t(uint32_t(_mm256_movemask_epi8(ge))) << (half * 32);
+        }
+        bits[w] &= ~atLeast;
+    }
+    if (words * 64 < n) lessU8Scalar(a + words * 64, b + words * 64, n - words * 64, bits + words);
+}
+
+__attribute__((target("avx2")))
+void notEqualU32Avx2(const uint32_t* col, size_t n, uint32_t value, uint64_t* bits) {
+    const __m256i needle = _mm256_set1_epi32(static_cast<int>(value));
+    size_t words = n / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (!bits[w]) continue;
+        uint64_t equal = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + w * 64 + lane * 8));
+            __m256i eq = _mm256_cmpeq_epi32(v, needle);
+            equal |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(eq)))) << (lane * 8);
+        }
+        bits[w] &= ~equal;
+    }
+    if (words * 64 < n) notEqualU32Scalar(col + words * 64, n - words * 64, value, bits + words);
+}
+
+__attribute__((target("avx2")))
+void lookupU32Avx2(const uint32_t* col, size_t n, const int32_t* lookup, uint64_t* bits) {
+    size_t words = n / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (!bits[w]) continue; // gathers are the expensive kernel; skip dead words
+        uint64_t hit = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col + w * 64 + lane * 8));
+            __m256i v = _mm256_i32gather_epi32(lookup, idx, 4);
+            __m256i nz = _mm256_xor_si256(_mm256_cmpeq_epi32(v, _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+            hit |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(nz)))) << (lane * 8);
+        }
+        bits[w] &= hit;
+    }
+    if (words * 64 < n) lookupU32Scalar(col + words * 64, n - words * 64, lookup, bits + words);
+}
+
+__attribute__((target("avx2")))
+void overlapsU32Avx2(const uint32_t* from, const uint32_t* until, size_t n, uint32_t lo, uint32_t hi, uint64_t* bits) {
+    const __m256i low = _mm256_set1_epi32(static_cast<int>(lo));
+    const __m256i high = _mm256_set1_epi32(static_cast<int>(hi));
+    size_t words = n / 64;
+    for (size_t w = 0; w < words; ++w) {
+        if (!bits[w]) continue;
+        uint64_t hit = 0;
+        for (int lane = 0; lane < 8; ++lane) {
+            __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + w * 64 + lane * 8));
+            __m256i u = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(until + w * 64 + lane * 8));
+            __m256i startsBy = _mm256_cmpeq_epi32(_mm256_min_epu32(f, high), f); // f <= hi, unsigned
+            __m256i endsAfter = _mm256_cmpeq_epi32(_mm256_max_epu32(u, low), u); // u >= lo, unsigned
+            __m256i both = _mm256_and_si256(startsBy, endsAfter);
+            hit |= uint64_t(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(both)))) << (lane * 8);
+        }
+        bits[w] &= hit;
+    }
+    if (words * 64 < n) overlapsU32Scalar(from + words * 64, until + words * 64, n - words * 64, lo, hi, bits + words);
+}
+
+const SelectionKernels AVX2_KERNELS = {inSetU8Avx2, lessU8Avx2, notEqualU32Avx2, lookupU32Avx2, overlapsU32Avx2};
+#endif
+
+const SelectionKernels& kernelsFor(bool vectorized) {
+#ifdef UNIRIDE_X86_SIMD
+    if (vectorized) return AVX2_KERNELS;
+#else
+    (void)vectorized;
+#endif
+    return SCALAR_KERNELS;
+}
+
+uint8_t clampCapacity(int value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0), static_cast<int>(UINT8_MAX)));
+}
+
+void copyRow(OpenRideBlock& dst, uint32_t to, const OpenRideBlock& src, uint32_t from) {
+    dst.rideIDs[to] = src.rideIDs[from];
+    dst.owners[to] = src.owners[from];
+    dst.fromAreas[to] = src.fromAreas[from];
+    dst.toAreas[to] = src.toAreas[from];
+    dst.times[to] = src.times[from];
+    dst.modes[to] = src.modes[from];
+    dst.rideTypes[to] = src.rideTypes[from];
+    dst.femalesOnly[to] = src.femalesOnly[from];
+    dst.genderPreferences[to] = src.genderPreferences[from];
+    dst.currentCapacity[to] = src.currentCapacity[from];
+    dst.maxCapacity[to] = src.maxCapacity[from];
+    dst.departFrom[to] = src.departFrom[from];
+    dst.departUntil[to] = src.departUntil[from];
+}
+
+uint32_t clampSeconds(int64_t seconds) {
+    return static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(seconds, 0), UINT32_MAX));
+}
+
+} // namespace
+
+bool OpenRideTable::avx2Supported() {
+#ifdef UNIRIDE_X86_SIMD
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+OpenRideTable::OpenRideTable(LocationGraph& locationGraph)
+    : graph(locationGraph), vectorized(avx2Supported()) {}
+
+const SelectionKernels& OpenRideTable::kernels() const {
+    return kernelsFor(vectorized);
+}
+
+int32_t OpenRideTable::departureBucket(const Ride& ride) {
+    if (ride.departAt <= 0) return OpenRideBlock::UNSCHEDULED;
+    return static_cast<int32_t>(ride.departAt / DEPARTURE_BUCKET_SECONDS);
+}
+
+// --- Mutations ---
+// Every writer holds writeMtx, edits private copies of the blocks it touches
+// and publishes once, so a reader sees either all of a write or none of it.
+
+void OpenRideTable::writeRow(OpenRideBlock& block, uint32_t row, const Ride& ride) {
+    block.rideIDs[row] = ride.rideID;
+    block.owners[row] = text.intern(ride.ownerID);
+    block.fromAreas[row] = graph.internArea(ride.from);
+    block.toAreas[row] = graph.internArea(ride.to);
+    block.times[row] = text.intern(ride.time);
+    block.modes[row] = text.intern(ride.mode);
+    block.rideTypes[row] = static_cast<uint8_t>(ride.rideType);
+    block.femalesOnly[row] = ride.femalesOnly ? 1 : 0;
+    block.genderPreferences[row] = static_cast<uint8_t>(stringToGenderPreference(ride.genderPreference));
+    block.currentCapacity[row] = clampCapacity(ride.currentCapacity);
+    block.maxCapacity[row] = clampCapacity(ride.maxCapacity);
+    if (ride.departAt > 0) {
+        int64_t window = std::min(std::max(ride.departWindow, 0), MAX_DEPART_WINDOW);
+        block.departFrom[row] = clampSeconds(ride.departAt - window);
+        block.departUntil[row] = clampSeconds(ride.departAt + window);
+    } else {
+        block.departFrom[row] = 0;
+        block.departUntil[row] = UINT32_MAX;
+    }
+    block.departMin = std::min(block.departMin, block.departFrom[row]);
+    block.departMax = std::max(block.departMax, block.departUntil[row]);
+}
+
+void OpenRideTable::upsert(const Ride& ride) {
+    if (ride.status != RideStatus::OPEN) {
+        remove(ride.rideID);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(writeMtx);
+    auto next = std::make_shared<OpenRideSnapshot>(*snapshot()); // shares every block
+    auto it = rowOf.find(ride.rideID);
+    if (it != rowOf.end() && next->blocks[it->second / OpenRideBlock::CAPACITY]->bucket == departureBucket(ride)) {
+        uint32_t b = it->second / OpenRideBlock::CAPACITY;
+        auto copy = std::make_shared<OpenRideBlock>(*next->blocks[b]);
+        writeRow(*copy, it->second % OpenRideBlock::CAPACITY, ride);
+        next->blocks[b] = std::move(copy);
+    } else {
+        if (it != rowOf.end()) removeLocked(*next, ride.rideID); // departure moved to another bucket
+        insertLocked(*next, ride);
+    }
+    publish(std::move(next));
+}
+
+void OpenRideTable::remove(int rideID) {
+    std::lock_guard<std::mutex> lock(writeMtx);
+    if (rowOf.find(rideID) == rowOf.end()) return;
+    auto next = std::make_shared<OpenRideSnapshot>(*snapshot());
+    removeLocked(*next, rideID);
+    publish(std::move(next));
+}
+
+// Appends to a block of the ride's departure bucket that has room, or starts
+// a new one; caller holds writeMtx
+void OpenRideTable::insertLocked(OpenRideSnapshot& next, const Ride& ride) {
+    int32_t bucket = departureBucket(ride);
+    uint32_t b;
+    std::shared_ptr<OpenRideBlock> target;
+    auto open = openBlockOf.find(bucket);
+    if (open != openBlockOf.end()) {
+        b = open->second;
+        target = std::make_shared<OpenRideBlock>(*next.blocks[b]);
+    } else {
+        b = static_cast<uint32_t>(next.blocks.size());
+        target = std::make_shared<OpenRideBlock>();
+        target->bucket = bucket;
+        next.blocks.push_back(nullptr);
+        openBlockOf.emplace(bucket, b);
+    }
+    uint32_t row = target->rows++;
+    writeRow(*target, row, ride);
+    if (target->rows == OpenRideBlock::CAPACITY) openBlockOf.erase(bucket);
+    rowOf.emplace(ride.rideID, b * OpenRideBlock::CAPACITY + row);
+    next.blocks[b] = std::move(target);
+    next.rows++;
+}
+
+// Moves the block's last row into the vacated slot. A block left empty is
+// replaced by the table's last block. Caller holds writeMtx.
+void OpenRideTable::removeLocked(OpenRideSnapshot& next, int rideID) {
+    auto it = rowOf.find(rideID);
+    uint32_t slot = it->second;
+    uint32_t b = slot / OpenRideBlock::CAPACITY;
+    uint32_t row = slot % OpenRideBlock::CAPACITY;
+    rowOf.erase(it);
+    next.rows--;
+
+    auto block = std::make_shared<OpenRideBlock>(*next.blocks[b]);
+    uint32_t lastRow = --block->rows;
+    if (row != lastRow) {
+        copyRow(*block, row, *block, lastRow);
+        rowOf[block->rideIDs[row]] = slot;
+    }
+    if (block->rows > 0) {
+        openBlockOf.emplace(block->bucket, b); // has room now, unless the bucket already has an open block
+        next.blocks[b] = std::move(block);
+        return;
+    }
+
+    auto open = openBlockOf.find(block->bucket);
+    if (open != openBlockOf.end() && open->second == b) openBlockOf.erase(open);
+    uint32_t lastBlock = static_cast<uint32_t>(next.blocks.size() - 1);
+    if (b != lastBlock) {
+        next.blocks[b] = std::move(next.blocks[lastBlock]);
+        const OpenRideBlock& moved = *next.blocks[b];
+        for (uint32_t r = 0; r < moved.rows; ++r) rowOf[moved.rideIDs[r]] = b * OpenRideBlock::CAPACITY + r;
+        auto movedOpen = openBlockOf.find(moved.bucket);
+        if (movedOpen != openBlockOf.end() && movedOpen->second == lastBlock) movedOpen->second = b;
+    }
+    next.blocks.pop_back();
+}
+
+void OpenRideTable::setCurrentCapacity(int rideID, int current) {
+    std::lock_guard<std::mutex> lock(writeMtx);
+    auto it = rowOf.find(rideID);
+    if (it == rowOf.end()) return;
+    auto next = std::make_shared<OpenRideSnapshot>(*snapshot());
+    uint32_t b = it->second / OpenRideBlock::CAPACITY;
+    auto copy = std::make_shared<OpenRideBlock>(*next->blocks[b]);
+    copy->currentCapacity[it->second % OpenRideBlock::CAPACITY] = clampCapacity(current);
+    next->blocks[b] = std::move(copy);
+    publish(std::move(next));
+}
+
+// Builds the blocks in place, bucket by bucket in departure order; the last
+// occurrence of a duplicated ride ID wins
+void OpenRideTable::replaceAll(const std::vector<Ride>& rides) {
+    std::lock_guard<std::mutex> lock(writeMtx);
+    std::unordered_map<int, size_t> lastIndex;
+    for (size_t i = 0; i < rides.size(); ++i) {
+        if (rides[i].status == RideStatus::OPEN) lastIndex[rides[i].rideID] = i;
+    }
+    std::map<int32_t, std::vector<const Ride*>> byBucket;
+    for (size_t i = 0; i < rides.size(); ++i) {
+        auto it = lastIndex.find(rides[i].rideID);
+        if (it != lastIndex.end() && it->second == i) byBucket[departureBucket(rides[i])].push_back(&rides[i]);
+    }
+
+    auto next = std::make_shared<OpenRideSnapshot>();
+    std::vector<std::shared_ptr<OpenRideBlock>> blocks;
+    rowOf.clear();
+    openBlockOf.clear();
+    for (const auto& entry : byBucket) {
+        for (size_t i = 0; i < entry.second.size(); ++i) {
+            if (i % OpenRideBlock::CAPACITY == 0) {
+                blocks.push_back(std::make_shared<OpenRideBlock>());
+                blocks.back()->bucket = entry.first;
+            }
+            uint32_t row = blocks.back()->rows++;
+            writeRow(*blocks.back(), row, *entry.second[i]);
+            rowOf.emplace(entry.second[i]->rideID, static_cast<uint32_t>(blocks.size() - 1) * OpenRideBlock::CAPACITY + row);
+        }
+        if (blocks.back()->rows < OpenRideBlock::CAPACITY) {
+            openBlockOf.emplace(entry.first, static_cast<uint32_t>(blocks.size() - 1));
+        }
+        next->rows += entry.second.size();
+    }
+    next->blocks.assign(blocks.begin(), blocks.end());
+    publish(std::move(next));
+}
+
+// --- Reads ---
+Ride OpenRideTable::materialize(const OpenRideBlock& block, uint32_t row) const {
+    Ride ride;
+    ride.rideID = block.rideIDs[row];
+    ride.ownerID = text.str(block.owners[row]);
+    ride.userID = ride.ownerID;
+    ride.from = graph.areaName(block.fromAreas[row]);
+    ride.to = graph.areaName(block.toAreas[row]);
+    ride.time = text.str(block.times[row]);
+    ride.mode = text.str(block.modes[row]);
+    ride.rideType = static_cast<RideType>(block.rideTypes[row]);
+    ride.status = RideStatus::OPEN;
+    ride.currentCapacity = block.currentCapacity[row];
+    ride.maxCapacity = block.maxCapacity[row];
+    ride.femalesOnly = block.femalesOnly[row] != 0;
+    ride.genderPreference = genderPreferenceToString(static_cast<GenderPreference>(block.genderPreferences[row]));
+    if (block.departUntil[row] != UINT32_MAX) {
+        ride.departAt = (int64_t(block.departFrom[row]) + block.departUntil[row]) / 2;
+        ride.departWindow = static_cast<int>((block.departUntil[row] - block.departFrom[row]) / 2);
+    }
+    if (!ride.ownerID.empty()) ride.participants.push_back(ride.ownerID);
+    return ride;
+}
+
+RideView OpenRideTable::view(const OpenRideBlock& block, uint32_t row) const {
+    static const std::string_view PREFERENCES[] = {"any", "female", "male", "any"}; // as genderPreferenceToString
+    RideView ride;
+    ride.rideID = block.rideIDs[row];
+    ride.ownerID = text.str(block.owners[row]);
+    ride.from = graph.areaName(block.fromAreas[row]);
+    ride.to = graph.areaName(block.toAreas[row]);
+    ride.time = text.str(block.times[row]);
+    ride.mode = text.str(block.modes[row]);
+    ride.genderPreference = PREFERENCES[block.genderPreferences[row] & 3];
+    ride.rideType = static_cast<RideType>(block.rideTypes[row]);
+    ride.currentCapacity = block.currentCapacity[row];
+    ride.maxCapacity = block.maxCapacity[row];
+    ride.femalesOnly = block.femalesOnly[row] != 0;
+    if (block.departUntil[row] != UINT32_MAX) {
+        ride.departAt = (int64_t(block.departFrom[row]) + block.departUntil[row]) / 2;
+        ride.departWindow = static_cast<int>((block.departUntil[row] - block.departFrom[row]) / 2);
+    }
+    return ride;
+}
@@ -0,0 +1,118 @@
+#ifndef OPENRIDETABLE_H
+#define OPENRIDETABLE_H
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "LocationGraph.h"
+#include "Ride.h"
+#include "StringInterner.h"
+
+// Up to CAPACITY open rides stored column-wise. Strings are interned handles
+// (areas in the LocationGraph, the rest in the table's own interner); enums,
+// flags and capacities take one byte each. Every row of a block departs in
+// the same time bucket, and departMin/departMax bound the block's departure
+// windows so a time-window search can skip the whole block.
+struct OpenRideBlock {
+    static constexpr uint32_t CAPACITY = 1024;
+    static constexpr uint32_t WORDS = CAPACITY / 64; // selection bitmap words per block
+    static constexpr int32_t UNSCHEDULED = -1;       // bucket of rides without a departure time
+
+    uint32_t rows = 0;
+    int32_t bucket = UNSCHEDULED;
+    uint32_t departMin = UINT32_MAX; // widened on every write, never narrowed
+    uint32_t departMax = 0;
+    int32_t rideIDs[CAPACITY];
+    uint32_t owners[CAPACITY];
+    uint32_t fromAreas[CAPACITY];
+    uint32_t toAreas[CAPACITY];
+    uint32_t times[CAPACITY];
+    uint32_t modes[CAPACITY];
+    uint8_t rideTypes[CAPACITY];
+    uint8_t femalesOnly[CAPACITY];
+    uint8_t genderPreferences[CAPACITY]; // GenderPreference values
+    uint8_t currentCapacity[CAPACITY];
+    uint8_t maxCapacity[CAPACITY];
+    uint32_t departFrom[CAPACITY];  // window start, unix seconds; 0 when unscheduled
+    uint32_t departUntil[CAPACITY]; // window end; UINT32_MAX when unscheduled
+};
+
+// One immutable version of the table; unchanged blocks are shared between versions
+struct OpenRideSnapshot {
+    std::vector<std::shared_ptr<const OpenRideBlock>> blocks;
+    size_t rows = 0;
+};
+
+// Column predicates over one block. Each kernel ANDs into `bits`, where bit i
+// of word w covers row w * 64 + i. Rows at or past n must already be clear.
+struct SelectionKernels {
+    // Keep rows whose value v (< 16) has bit v set in `allowed`
+    void (*inSetU8)(const uint8_t* col, size_t n, uint16_t allowed, uint64_t* bits);
+    // Keep rows where a[i] < b[i]
+    void (*lessU8)(const uint8_t* a, const uint8_t* b, size_t n, uint64_t* bits);
+    // Keep rows where col[i] != value
+    void (*notEqualU32)(const uint32_t* col, size_t n, uint32_t value, uint64_t* bits);
+    // Keep rows where lookup[col[i]] is non-zero
+    void (*lookupU32)(const uint32_t* col, size_t n, const int32_t* lookup, uint64_t* bits);
+    // Keep rows whose [from[i], until[i]] overlaps [lo, hi]
+    void (*overlapsU32)(const uint32_t* from, const uint32_t* until, size_t n, uint32_t lo, uint32_t hi, uint64_t* bits);
+};
+
+// The in-memory index of rides whose status is 'open'. DatabaseManager keeps
+// it in step with SQLite and MatchingEngine reads it. Readers take a snapshot
+// and scan it without holding a lock. Writers serialize on writeMtx, copy the
+// blocks they change and publish the new version with an atomic pointer swap.
+// Rides are placed in blocks by departure bucket, which makes the blocks'
+// departure bounds a time index: a search for next Tuesday morning only
+// scans Tuesday morning's blocks and the unscheduled ones.
+// Kernels use AVX2 when the CPU supports it and scalar loops otherwise. The
+// choice is made at runtime, so no build flags are needed.
+class OpenRideTable {
+private:
+    LocationGraph& graph;
+    StringInterner text; // owners, times and modes
+    std::mutex writeMtx;
+    std::shared_ptr<const OpenRideSnapshot> current = std::make_shared<OpenRideSnapshot>(); // std::atomic_load/store only
+    std::unordered_map<int, uint32_t> rowOf; // ride ID -> block * CAPACITY + row; guarded by writeMtx
+    std::unordered_map<int32_t, uint32_t> openBlockOf; // bucket -> a block of it with free rows; guarded by writeMtx
+    bool vectorized;
+
+    void publish(std::shared_ptr<const OpenRideSnapshot> next) { std::atomic_store(&current, std::move(next)); }
+    void writeRow(OpenRideBlock& block, uint32_t row, const Ride& ride);
+    void insertLocked(OpenRideSnapshot& next, const Ride& ride);
+    void removeLocked(OpenRideSnapshot& next, int rideID);
+
+public:
+    static constexpr int64_t DEPARTURE_BUCKET_SECONDS = 3600;
+
+    explicit OpenRideTable(LocationGraph& locationGraph);
+    static int32_t departureBucket(const Ride& ride);
+
+    // Inserts or replaces the ride; rides that are not OPEN are removed instead
+    void upsert(const Ride& ride);
+    void remove(int rideID);
+    void setCurrentCapacity(int rideID, int current);
+    // Publishes a table holding exactly the open rides in `rides` (bulk load)
+    void replaceAll(const std::vector<Ride>& rides);
+    void clear() { replaceAll({}); }
+    size_t size() const { return snapshot()->rows; }
+
+    std::shared_ptr<const OpenRideSnapshot> snapshot() const { return std::atomic_load(&current); }
+    Ride materialize(const OpenRideBlock& block, uint32_t row) const;
+    // Strings point into the interners and stay valid for the table's lifetime
+    RideView view(const OpenRideBlock& block, uint32_t row) const;
+    LocationGraph& locationGraph() const { return graph; }
+    const StringInterner& strings() const { return text; }
+
+    static bool avx2Supported();
+    // Switches between AVX2 and scalar kernels; call before the table is shared
+    void setVectorized(bool enabled) { vectorized = enabled && avx2Supported(); }
+    bool isVectorized() const { return vectorized; }
+    const SelectionKernels& kernels() const;
+};
+
+#endif // OPENRIDETABLE_H
@@ -1,4 +1,4 @@
 #include "Request.h"
 
-Request::Request(int reqID, const std::string &u, const std::string &r, int idx)
-    : requestID(reqID), userID(u), receiverID(r), rideIndex(idx) {}
+Request::Request(int reqID, const std::string &u, const std::string &r, int ride)
+    : requestID(reqID), userID(u), receiverID(r), rideID(ride) {}
@@ -7,10 +7,18 @@ struct Request {
     int requestID;           // Unique request identifier
     std::string userID;      // ID of the user sending the request
     std::string receiverID;  // ID of the user receiving the request
-    int rideIndex;           // Index of the ride being requested
+    int rideID;              // Database ID of the ride being requested
+
+    // Intrusive links owned by RequestQueue; null while not queued
+    Request* prev = nullptr;            // all pending requests, oldest first
+    Request* next = nullptr;
+    Request* prevForReceiver = nullptr; // pending requests of one receiver
+    Request* nextForReceiver = nullptr;
+    Request* prevForRide = nullptr;     // pending requests for one ride
+    Request* nextForRide = nullptr;
 
     Request() = default;
-    Request(int reqID, const std::string &u, const std::string &r, int idx);
+    Request(int reqID, const std::string &u, const std::string &r, int ride);
 };
 
 #endif // REQUEST_H
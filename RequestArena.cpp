@@ -0,0 +1,18 @@
+#include "RequestArena.h"
+#include <cstring>
+
+RequestArena::RequestArena()
+    : initial(new std::byte[INITIAL_BYTES]),
+      pool(initial.get(), INITIAL_BYTES, std::pmr::new_delete_resource()) {}
+
+std::string_view RequestArena::copy(std::string_view s) {
+    if (s.empty()) return {};
+    char* chars = static_cast<char*>(pool.allocate(s.size(), 1));
+    std::memcpy(chars, s.data(), s.size());
+    return std::string_view(chars, s.size());
+}
+
+RequestArena& RequestArena::local() {
+    thread_local RequestArena arena;
+    return arena;
+}
@@ -0,0 +1,49 @@
+#ifndef REQUESTARENA_H
+#define REQUESTARENA_H
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+
+// Bump allocator for one request's temporaries. Each worker thread owns an
+// arena: a handler opens a Scope, allocates result vectors and strings from
+// resource(), and everything is released in one step when the Scope ends.
+// The first INITIAL_BYTES come from a buffer the arena keeps for its whole
+// life, so a typical request never reaches malloc. Larger requests spill to
+// the heap until release.
+class RequestArena {
+public:
+    static constexpr size_t INITIAL_BYTES = 64 * 1024;
+
+    RequestArena();
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &pool; }
+    // Copies `s` into the arena; the view stays valid until release()
+    std::string_view copy(std::string_view s);
+    void release() { pool.release(); }
+
+    // The calling thread's arena
+    static RequestArena& local();
+
+    // Releases the arena when the request is done
+    class Scope {
+    private:
+        RequestArena& arena;
+
+    public:
+        explicit Scope(RequestArena& requestArena) : arena(requestArena) {}
+        ~Scope() { arena.release(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    std::unique_ptr<std::byte[]> initial;
+    std::pmr::monotonic_buffer_resource pool;
+};
+
+#endif // REQUESTARENA_H
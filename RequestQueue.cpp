@@ -1,8 +1,57 @@
 #include "RequestQueue.h"
-#include <algorithm>
 
 RequestQueue::RequestQueue(RideSystem *rs, DatabaseManager *db) : rideSystem(rs), dbManager(db) {}
 
+// --- Intrusive list helpers; Prev/Next select which of the three lists ---
+template <Request* Request::*Prev, Request* Request::*Next>
+void RequestQueue::pushBack(List& list, Request* r) {
+    r->*Prev = list.tail;
+    r->*Next = nullptr;
+    if (list.tail) list.tail->*Next = r;
+    else list.head = r;
+    list.tail = r;
+    ++list.size;
+}
+
+template <Request* Request::*Prev, Request* Request::*Next>
+void RequestQueue::unlink(List& list, Request* r) {
+    if (r->*Prev) (r->*Prev)->*Next = r->*Next;
+    else list.head = r->*Next;
+    if (r->*Next) (r->*Next)->*Prev = r->*Prev;
+    else list.tail = r->*Prev;
+    r->*Prev = nullptr;
+    r->*Next = nullptr;
+    --list.size;
+}
+
+int RequestQueue::enqueue(const std::string &userID, const std::string &receiverID, int rideID) {
+    int reqID = nextRequestID++;
+    Request* r = &requests.emplace(reqID, Request(reqID, userID, receiverID, rideID)).first->second;
+    pushBack<&Request::prev, &Request::next>(pending, r);
+    pushBack<&Request::prevForReceiver, &Request::nextForReceiver>(byReceiver[receiverID], r);
+    pushBack<&Request::prevForRide, &Request::nextForRide>(byRide[rideID], r);
+    return reqID;
+}
+
+void RequestQueue::remove(Request* r) {
+    unlink<&Request::prev, &Request::next>(pending, r);
+
+    auto receiver = byReceiver.find(r->receiverID);
+    unlink<&Request::prevForReceiver, &Request::nextForReceiver>(receiver->second, r);
+    if (receiver->second.size == 0) byReceiver.erase(receiver);
+
+    auto ride = byRide.find(r->rideID);
+    unlink<&Request::prevForRide, &Request::nextForRide>(ride->second, r);
+    if (ride->second.size == 0) byRide.erase(ride);
+
+    requests.erase(r->requestID);
+}
+
+// Copies handed out of the queue carry no links
+static Request detached(const Request& r) {
+    return Request(r.requestID, r.userID, r.receiverID, r.rideID);
+}
+
 std::vector<int> RequestQueue::createRequest(const std::string &userID, const std::string &from, const std::string &to, RideType rideType) {
     std::vector<int> createdIDs;
     auto matches = rideSystem->findMatches(from, to, rideType, userID);
@@ -17,19 +66,16 @@ std::vector<int> RequestQueue::createRequest(const std::string &userID, const st
         // For rickshaw, first participant creates the group
         std::string ownerID = userID;
         
-        rideSystem->addRide(ownerID, from, to, "flexible", mode, rideType);
-        
+        // Insert first so the in-memory ride carries its database ID
         Ride newRide(ownerID, from, to, "flexible", mode, rideType);
         dbManager->insertRide(newRide);
+        rideSystem->addRide(newRide);
         
         return createdIDs; 
     }
     
-    for (size_t i = 0; i < matches.size(); ++i) {
-        int reqID = nextRequestID++;
-        Request r(reqID, userID, matches[i].userID, static_cast<int>(i));
-        queue.push(r);
-        createdIDs.push_back(reqID);
+    for (const auto &match : matches) {
+        createdIDs.push_back(enqueue(userID, match.userID, match.rideID));
     }
     return createdIDs;
 }
@@ -42,63 +88,87 @@ std::vector<int> RequestQueue::createRideOffer(const std::string &userID, const
     
     // Only bike and carpool can have owners
     if (rideType != RideType::RICKSHAW) {
-        rideSystem->addRide(userID, from, to, "flexible", mode, rideType, femalesOnly);
-        
         Ride newRide(userID, from, to, "flexible", mode, rideType, femalesOnly);
         dbManager->insertRide(newRide);
+        rideSystem->addRide(newRide);
     }
     
     return createdIDs;
 }
 
+int RequestQueue::addRequest(const std::string &userID, const std::string &receiverID, int rideID) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return enqueue(userID, receiverID, rideID);
+}
+
 crow::json::wvalue RequestQueue::listPending() const {
     crow::json::wvalue res;
     std::lock_guard<std::mutex> lock(mtx);
     
-    std::queue<Request> tempQueue = queue;
     int i = 0;
-    while (!tempQueue.empty()) {
-        const Request &r = tempQueue.front();
-        res["requests"][i]["requestID"] = r.requestID;
-        res["requests"][i]["userID"] = r.userID;
-        res["requests"][i]["receiverID"] = r.receiverID;
-        res["requests"][i]["rideIndex"] = r.rideIndex;
-        tempQueue.pop();
-        ++i;
+    for (const Request* r = pending.head; r; r = r->next, ++i) {
+        res["requests"][i]["requestID"] = r->requestID;
+        res["requests"][i]["userID"] = r->userID;
+        res["requests"][i]["receiverID"] = r->receiverID;
+        res["requests"][i]["rideID"] = r->rideID;
     }
     return res;
 }
 
+std::vector<Request> RequestQueue::listPendingFor(const std::string &receiverID) const {
+    std::vector<Request> out;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = byReceiver.find(receiverID);
+    if (it == byReceiver.end()) return out;
+    out.reserve(it->second.size);
+    for (const Request* r = it->second.head; r; r = r->nextForReceiver) out.push_back(detached(*r));
+    return out;
+}
+
+std::vector<Request> RequestQueue::listPendingForRide(int rideID) const {
+    std::vector<Request> out;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = byRide.find(rideID);
+    if (it == byRide.end()) return out;
+    out.reserve(it->second.size);
+    for (const Request* r = it->second.head; r; r = r->nextForRide) out.push_back(detached(*r));
+    return out;
+}
+
+size_t RequestQueue::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return pending.size;
+}
+
 bool RequestQueue::respondToRequest(int requestID, bool accept, std::string &outMessage) {
     std::lock_guard<std::mutex> lock(mtx);
     
-    std::queue<Request> tempQueue;
-    bool found = false;
-    Request targetRequest;
-    
-    while (!queue.empty()) {
-        Request r = queue.front();
-        queue.pop();
-        
-        if (r.requestID == requestID) {
-            found = true;
-            targetRequest = r;
-            if (accept) {
-                outMessage = "Request " + std::to_string(requestID) + " accepted: " + r.userID + " connected with " + r.receiverID;
-            } else {
-                outMessage = "Request " + std::to_string(requestID) + " rejected";
-            }
-        } else {
-            tempQueue.push(r);
-        }
-    }
-    
-    queue = tempQueue;
-    
-    if (!found) {
+    auto it = requests.find(requestID);
+    if (it == requests.end()) {
         outMessage = "Request not found";
         return false;
     }
     
+    const Request &r = it->second;
+    if (accept) {
+        outMessage = "Request " + std::to_string(requestID) + " accepted: " + r.userID + " connected with " + r.receiverID;
+    } else {
+        outMessage = "Request " + std::to_string(requestID) + " rejected";
+    }
+    remove(&it->second);
     return accept;
 }
+
+size_t RequestQueue::cancelRequestsForRide(int rideID) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = byRide.find(rideID);
+    if (it == byRide.end()) return 0;
+    size_t cancelled = it->second.size;
+    // Read next before remove(): the list entry itself goes with its last request
+    for (Request* r = it->second.head; r;) {
+        Request* next = r->nextForRide;
+        remove(r);
+        r = next;
+    }
+    return cancelled;
+}
@@ -2,26 +2,53 @@
 #define REQUESTQUEUE_H
 
 #pragma once
-#include <queue>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "Request.h"
 #include "RideSystem.h"
 #include "DatabaseManager.h"
 #include "crow.h"
 
+// Pending requests indexed three ways: by requestID (hash map), and through
+// intrusive doubly linked lists in arrival order, per receiver and per ride.
+// Requests live in the map, whose nodes never move, so the links stay valid
+// and responding to or cancelling a request is O(1) under the mutex.
 class RequestQueue {
 private:
+    struct List {
+        Request* head = nullptr;
+        Request* tail = nullptr;
+        size_t size = 0;
+    };
+
     mutable std::mutex mtx;
-    std::queue<Request> queue;
+    std::unordered_map<int, Request> requests; // requestID -> request
+    List pending;                              // every request, oldest first
+    std::unordered_map<std::string, List> byReceiver;
+    std::unordered_map<int, List> byRide;
     int nextRequestID = 1;
     RideSystem *rideSystem;
     DatabaseManager *dbManager;
 
+    template <Request* Request::*Prev, Request* Request::*Next>
+    static void pushBack(List& list, Request* r);
+    template <Request* Request::*Prev, Request* Request::*Next>
+    static void unlink(List& list, Request* r);
+
+    int enqueue(const std::string &userID, const std::string &receiverID, int rideID); // caller holds mtx
+    void remove(Request* r);                                                          // caller holds mtx
+
 public:
     RequestQueue(RideSystem *rs, DatabaseManager *db);
     std::vector<int> createRequest(const std::string &userID, const std::string &from, const std::string &to, RideType rideType = RideType::CARPOOL);
     std::vector<int> createRideOffer(const std::string &userID, const std::string &from, const std::string &to, RideType rideType, bool femalesOnly = false);
+    int addRequest(const std::string &userID, const std::string &receiverID, int rideID);
     crow::json::wvalue listPending() const;
+    std::vector<Request> listPendingFor(const std::string &receiverID) const;
+    std::vector<Request> listPendingForRide(int rideID) const;
+    size_t pendingCount() const;
     bool respondToRequest(int requestID, bool accept, std::string &outMessage);
+    size_t cancelRequestsForRide(int rideID); // e.g. when the ride starts or fills
 };
-#endif // REQUESTQUEUE_H
\ No newline at end of file
+#endif // REQUESTQUEUE_H
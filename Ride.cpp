@@ -82,3 +82,54 @@ void Ride::updateStatus() {
         status = RideStatus::OPEN;
     }
 }
+
+RideType stringToRideType(const std::string& typeStr) {
+    if (typeStr == "bike") return RideType::BIKE;
+    if (typeStr == "carpool") return RideType::CARPOOL;
+    if (typeStr == "rickshaw") return RideType::RICKSHAW;
+    return RideType::CARPOOL;
+}
+
+std::string rideTypeToString(RideType type) {
+    switch (type) {
+        case RideType::BIKE: return "bike";
+        case RideType::CARPOOL: return "carpool";
+        case RideType::RICKSHAW: return "rickshaw";
+        default: return "carpool";
+    }
+}
+
+RideStatus stringToRideStatus(const std::string& statusStr) {
+    if (statusStr == "open") return RideStatus::OPEN;
+    if (statusStr == "full") return RideStatus::FULL;
+    if (statusStr == "started") return RideStatus::STARTED;
+    if (statusStr == "completed") return RideStatus::COMPLETED;
+    if (statusStr == "expired") return RideStatus::EXPIRED;
+    return RideStatus::OPEN; // default
+}
+
+std::string rideStatusToString(RideStatus status) {
+    switch (status) {
+        case RideStatus::OPEN: return "open";
+        case RideStatus::FULL: return "full";
+        case RideStatus::STARTED: return "started";
+        case RideStatus::COMPLETED: return "completed";
+        case RideStatus::EXPIRED: return "expired";
+        default: return "open";
+    }
+}
+
+GenderPreference stringToGenderPreference(const std::string& prefStr) {
+    if (prefStr == "any") return GenderPreference::ANY;
+    if (prefStr == "female") return GenderPreference::FEMALE;
+    if (prefStr == "male") return GenderPreference::MALE;
+    return GenderPreference::OTHER;
+}
+
+std::string genderPreferenceToString(GenderPreference pref) {
+    switch (pref) {
+        case GenderPreference::FEMALE: return "female";
+        case GenderPreference::MALE: return "male";
+        default: return "any";
+    }
+}
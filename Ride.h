@@ -1,20 +1,31 @@
 #ifndef RIDE_H
 #define RIDE_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
-enum class RideType {
+enum class RideType : uint8_t {
     BIKE,      // 2 people max (owner + 1 passenger)
     CARPOOL,   // 5 people max (owner + 4 passengers) or 4 participants
     RICKSHAW   // 3 participants max (no owner)
 };
 
-enum class RideStatus {
+enum class RideStatus : uint8_t {
     OPEN,      // Accepting requests
     FULL,      // Capacity reached
     STARTED,   // Ride in progress
-    COMPLETED  // Ride finished
+    COMPLETED, // Ride finished
+    EXPIRED    // Departure window passed without the ride running
+};
+
+// Rider gender a ride is offered to; OTHER covers legacy free-text values
+enum class GenderPreference : uint8_t {
+    ANY,
+    FEMALE,
+    MALE,
+    OTHER
 };
 
 enum class RequestStatus {
@@ -46,6 +57,8 @@ struct Ride {
     std::vector<JoinRequest> pendingRequests; // Pending join requests
     bool femalesOnly;       // Gender preference
     std::string genderPreference; // "male", "female", "any"
+    int64_t departAt = 0;   // Scheduled departure, unix seconds; 0 = not scheduled
+    int departWindow = 0;   // Tolerance either side of departAt, seconds
 
     // Legacy field for compatibility
     std::string userID;     // Same as ownerID
@@ -63,4 +76,39 @@ struct Ride {
     void updateStatus();
 };
 
+// Non-owning copy of a ride's columns for response building. The producer
+// says how long the strings stay valid (ride index or request arena).
+struct RideView {
+    int rideID = 0;
+    std::string_view ownerID;
+    std::string_view from;
+    std::string_view to;
+    std::string_view time;
+    std::string_view mode;
+    std::string_view genderPreference;
+    RideType rideType = RideType::CARPOOL;
+    int currentCapacity = 0;
+    int maxCapacity = 0;
+    bool femalesOnly = false;
+    RideStatus status = RideStatus::OPEN;
+    int64_t departAt = 0;
+    int departWindow = 0;
+
+    int getAvailableSlots() const { return maxCapacity - currentCapacity; }
+};
+
+// Departure windows. A scheduled ride or search covers
+// [departAt - departWindow, departAt + departWindow]; an unscheduled ride
+// (departAt == 0) overlaps every window.
+constexpr int DEFAULT_DEPART_WINDOW = 15 * 60;
+constexpr int MAX_DEPART_WINDOW = 12 * 60 * 60;
+
+// String conversions shared by the API layer and DatabaseManager
+RideType stringToRideType(const std::string& typeStr);
+std::string rideTypeToString(RideType type);
+RideStatus stringToRideStatus(const std::string& statusStr);
+std::string rideStatusToString(RideStatus status);
+GenderPreference stringToGenderPreference(const std::string& prefStr);
+std::string genderPreferenceToString(GenderPreference pref); // OTHER reads back as "any"
+
 #endif // RIDE_H
@@ -0,0 +1,140 @@
+#include "RideFragmentCache.h"
+#include "DatabaseManager.h"
+#include "Tracer.h"
+#include <vector>
+
+// --- Serialize one ride in the /ride/all shape ---
+void RideFragmentCache::writeRide(JsonWriter& out, const RideView& ride, std::string_view leadName) {
+    out.beginObject()
+        .field("rideID", ride.rideID)
+        .field("leadUserID", ride.ownerID)
+        .field("leadUserName", leadName)
+        .field("from", ride.from)
+        .field("to", ride.to)
+        .field("time", ride.time)
+        .field("departAt", ride.departAt)
+        .field("windowMinutes", ride.departWindow / 60)
+        .field("rideType", rideTypeToString(ride.rideType))
+        .field("currentCapacity", ride.currentCapacity)
+        .field("maxCapacity", ride.maxCapacity)
+        .field("availableSlots", ride.getAvailableSlots())
+        .field("femalesOnly", ride.femalesOnly)
+        .field("status", rideStatusToString(ride.status))
+        .endObject();
+}
+
+void RideFragmentCache::writeRide(JsonWriter& out, const Ride& ride, const std::string& leadName) {
+    RideView view;
+    view.rideID = ride.rideID;
+    view.ownerID = ride.ownerID;
+    view.from = ride.from;
+    view.to = ride.to;
+    view.time = ride.time;
+    view.rideType = ride.rideType;
+    view.currentCapacity = ride.currentCapacity;
+    view.maxCapacity = ride.maxCapacity;
+    view.femalesOnly = ride.femalesOnly;
+    view.status = ride.status;
+    view.departAt = ride.departAt;
+    view.departWindow = ride.departWindow;
+    writeRide(out, view, leadName);
+}
+
+uint64_t RideFragmentCache::currentVersion(int rideID) const {
+    auto it = versions.find(rideID);
+    return it == versions.end() ? 0 : it->second;
+}
+
+// --- Render a fragment (caller holds mtx) ---
+void RideFragmentCache::store(const Ride& ride, const std::string& leadName, uint64_t version) {
+    thread_local JsonWriter scratch(256);
+    scratch.clear();
+    writeRide(scratch, ride, leadName);
+
+    Fragment& frag = fragments[ride.rideID];
+    frag.version = version;
+    frag.ownerID = ride.ownerID;
+    frag.json = scratch.str();
+}
+
+void RideFragmentCache::invalidateRide(int rideID) {
+    std::lock_guard<std::mutex> lock(mtx);
+    ++versions[rideID];
+    fragments[rideID]; // make sure newly inserted rides get rendered
+}
+
+void RideFragmentCache::invalidateOwner(const std::string& userID) {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& entry : fragments) {
+        if (entry.second.ownerID == userID) {
+            ++versions[entry.first];
+        }
+    }
+}
+
+void RideFragmentCache::appendRides(JsonWriter& out, DatabaseManager& db) {
+    TRACE_SPAN("cache.appendRides", "serialize");
+    // Work out what needs fetching without holding the lock across SQLite calls
+    bool needWarm;
+    std::vector<std::pair<int, uint64_t>> stale;
+    std::unordered_map<int, uint64_t> warmVersions;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        needWarm = !warmed;
+        if (needWarm) {
+            warmVersions = versions;
+        } else {
+            for (const auto& entry : fragments) {
+                uint64_t current = currentVersion(entry.first);
+                if (entry.second.version != current) {
+                    stale.push_back({entry.first, current});
+                }
+            }
+        }
+    }
+
+    std::vector<std::pair<Ride, uint64_t>> fetched;
+    std::vector<int> missing;
+
+    if (needWarm) {
+        for (auto& ride : db.getAllRides()) {
+            auto it = warmVersions.find(ride.rideID);
+            uint64_t version = it == warmVersions.end() ? 0 : it->second;
+            fetched.push_back({std::move(ride), version});
+        }
+    } else {
+        for (const auto& entry : stale) {
+            Ride ride = db.getRideByID(entry.first);
+            if (ride.rideID == 0) {
+                missing.push_back(entry.first);
+            } else {
+                fetched.push_back({std::move(ride), entry.second});
+            }
+        }
+    }
+
+    // Resolve each lead's name once, even if they own several stale rides
+    std::unordered_map<std::string, std::string> leadNames;
+    for (const auto& item : fetched) {
+        const std::string& ownerID = item.first.ownerID;
+        if (leadNames.find(ownerID) == leadNames.end()) {
+            leadNames[ownerID] = db.getUserByID(ownerID).name;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& item : fetched) {
+        store(item.first, leadNames[item.first.ownerID], item.second);
+    }
+    for (int rideID : missing) {
+        fragments.erase(rideID);
+        versions.erase(rideID);
+    }
+    if (needWarm) warmed = true;
+
+    for (const auto& entry : fragments) {
+        if (entry.second.version != UNRENDERED) {
+            out.raw(entry.second.json);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef RIDEFRAGMENTCACHE_H
+#define RIDEFRAGMENTCACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "Ride.h"
+#include "JsonWriter.h"
+
+class DatabaseManager;
+
+// Pre-serialized JSON object per ride, keyed by (rideID, version).
+// DatabaseManager bumps a ride's version whenever its capacity or status
+// changes, and every ride of a user when that user's name changes. Listing
+// re-renders only the stale rides and concatenates the rest as-is.
+class RideFragmentCache {
+private:
+    static constexpr uint64_t UNRENDERED = ~0ULL;
+
+    struct Fragment {
+        uint64_t version = UNRENDERED; // version the json was rendered at
+        std::string ownerID;
+        std::string json;
+    };
+
+    mutable std::mutex mtx;
+    std::map<int, Fragment> fragments;           // rideID -> fragment, ordered like getAllRides
+    std::unordered_map<int, uint64_t> versions;  // rideID -> current version
+    bool warmed = false;
+
+    uint64_t currentVersion(int rideID) const;
+    void store(const Ride& ride, const std::string& leadName, uint64_t version);
+
+public:
+    void invalidateRide(int rideID);
+    void invalidateOwner(const std::string& userID);
+
+    // Append every ride as an array element, refreshing stale fragments from the DB
+    void appendRides(JsonWriter& out, DatabaseManager& db);
+
+    static void writeRide(JsonWriter& out, const Ride& ride, const std::string& leadName);
+    // Same shape from a cursor row, without materializing a Ride
+    static void writeRide(JsonWriter& out, const RideView& ride, std::string_view leadName);
+};
+
+#endif // RIDEFRAGMENTCACHE_H
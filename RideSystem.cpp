@@ -8,73 +8,86 @@ bool RideSystem::initializeLocationGraph(const std::string& dbPath) {
 
 void RideSystem::addRide(const std::string &id, const std::string &from, const std::string &to,
                          const std::string &time, const std::string &mode, RideType rideType, bool femalesOnly) {
-    std::lock_guard<std::mutex> lock(mtx);
-    rides.emplace_back(id, from, to, time, mode, rideType, femalesOnly);
+    addRide(Ride(id, from, to, time, mode, rideType, femalesOnly));
 }
 
-std::vector<Ride> RideSystem::findMatches(const std::string &from, const std::string &to, RideType rideType, const std::string &userID) const {
-    std::vector<Ride> matches;
-    std::lock_guard<std::mutex> lock(mtx);
-    for (const auto &r : rides) {
-        // Check proximity using precomputed graph
-        bool fromMatch = locationGraph.areConnected(from, r.from);
-        bool toMatch = locationGraph.areConnected(to, r.to);
-        
-        if (fromMatch && toMatch && r.rideType == rideType && r.canAcceptMoreParticipants()) {
-            // Filter out females-only rides for non-females
-            if (r.femalesOnly && !userID.empty() && dbManager) {
-                User user = dbManager->getUserByID(userID);
-                if (user.gender != "female") {
-                    continue; // Skip this ride
-                }
-            }
-            matches.push_back(r);
-        }
+void RideSystem::addRide(const Ride &ride) {
+    if (ride.rideID > 0) {
+        rides.upsert(ride);
+        return;
     }
-    return matches;
+    // Never stored in SQLite: negative IDs cannot collide with database rows
+    Ride local = ride;
+    local.rideID = nextLocalID.fetch_sub(1, std::memory_order_relaxed);
+    rides.upsert(local);
+}
+
+// The searcher's gender is looked up once per call, before any scan
+MatchRequest RideSystem::request(const std::string &from, const std::string &to, RideType rideType, const std::string &userID) const {
+    MatchRequest req;
+    req.from = from;
+    req.to = to;
+    req.rideType = rideType;
+    req.userID = userID;
+    if (dbManager && !userID.empty()) req.userGender = dbManager->getUserByID(userID).gender;
+    return req;
+}
+
+std::vector<Ride> RideSystem::findMatches(const std::string &from, const std::string &to, RideType rideType, const std::string &userID) const {
+    return engine.match(request(from, to, rideType, userID));
 }
 
 std::vector<Ride> RideSystem::getAllRides() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return rides;
+    std::vector<Ride> all;
+    auto snapshot = rides.snapshot();
+    all.reserve(snapshot->rows);
+    for (const auto &block : snapshot->blocks) {
+        for (uint32_t row = 0; row < block->rows; ++row) all.push_back(rides.materialize(*block, row));
+    }
+    return all;
 }
 
 crow::json::wvalue RideSystem::getAllRidesJson() const {
     crow::json::wvalue res;
-    std::lock_guard<std::mutex> lock(mtx);
-    for (size_t i = 0; i < rides.size(); ++i) {
-        res["rides"][i]["userID"] = rides[i].userID;
-        res["rides"][i]["from"] = rides[i].from;
-        res["rides"][i]["to"] = rides[i].to;
-        res["rides"][i]["time"] = rides[i].time;
-        res["rides"][i]["mode"] = rides[i].mode;
-        res["rides"][i]["rideType"] = static_cast<int>(rides[i].rideType);
-        res["rides"][i]["currentCapacity"] = rides[i].currentCapacity;
-        res["rides"][i]["maxCapacity"] = rides[i].maxCapacity;
-        res["rides"][i]["availableSlots"] = rides[i].getAvailableSlots();
+    auto snapshot = rides.snapshot();
+    const StringInterner &text = rides.strings();
+    size_t i = 0;
+    for (const auto &block : snapshot->blocks) {
+        for (uint32_t row = 0; row < block->rows; ++row, ++i) {
+            res["rides"][i]["userID"] = text.str(block->owners[row]);
+            res["rides"][i]["from"] = locationGraph.areaName(block->fromAreas[row]);
+            res["rides"][i]["to"] = locationGraph.areaName(block->toAreas[row]);
+            res["rides"][i]["time"] = text.str(block->times[row]);
+            res["rides"][i]["mode"] = text.str(block->modes[row]);
+            res["rides"][i]["rideType"] = static_cast<int>(block->rideTypes[row]);
+            res["rides"][i]["currentCapacity"] = block->currentCapacity[row];
+            res["rides"][i]["maxCapacity"] = block->maxCapacity[row];
+            res["rides"][i]["availableSlots"] = block->maxCapacity[row] - block->currentCapacity[row];
+        }
     }
     return res;
 }
 
+// Takes the best match and records the seat. With a database the join goes
+// through SQLite, whose writes update the table; otherwise the table is
+// updated directly.
 bool RideSystem::joinRide(const std::string &userID, const std::string &from, const std::string &to, RideType rideType) {
-    std::lock_guard<std::mutex> lock(mtx);
-    for (auto &r : rides) {
-        // Check proximity using precomputed graph
-        bool fromMatch = locationGraph.areConnected(from, r.from);
-        bool toMatch = locationGraph.areConnected(to, r.to);
-        
-        if (fromMatch && toMatch && r.rideType == rideType && r.canAcceptMoreParticipants()) {
-            // Check gender restriction for females-only rides
-            if (r.femalesOnly && dbManager) {
-                User user = dbManager->getUserByID(userID);
-                if (user.gender != "female") {
-                    return false; // Reject non-females from females-only rides
-                }
-            }
-            r.participants.push_back(userID);
-            r.currentCapacity++;
-            return true;
-        }
+    MatchRequest req = request(from, to, rideType, userID);
+    std::lock_guard<std::mutex> lock(joinMtx);
+    auto matches = engine.match(req, 1);
+    if (matches.empty()) return false;
+
+    Ride ride = matches.front();
+    ride.currentCapacity++;
+    ride.participants.push_back(userID);
+    ride.updateStatus();
+    if (!dbManager || ride.rideID < 0) {
+        rides.upsert(ride); // a ride that filled up leaves the table
+        return true;
     }
-    return false;
+    if (!dbManager->insertJoinRequest(ride.rideID, userID)) return false;
+    dbManager->updateJoinRequestStatus(ride.rideID, userID, "accepted");
+    dbManager->updateRideCapacityByID(ride.rideID, ride.currentCapacity);
+    if (ride.status == RideStatus::FULL) dbManager->updateRideStatus(ride.rideID, "full");
+    return true;
 }
@@ -4,30 +4,45 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <atomic>
 #include <mutex>
 #include "Ride.h"
 #include "LocationGraph.h"
+#include "OpenRideTable.h"
+#include "MatchingEngine.h"
 #include "crow.h"
 
 class DatabaseManager;
 class User;
 
+// Front end over the shared ride index: the OpenRideTable holds every open
+// ride and the MatchingEngine answers searches against it. In the server the
+// DatabaseManager is given the same engine, so SQLite is the source of truth
+// and its writes update the table. Without a database, e.g. in benchmarks,
+// the table is the only store.
 class RideSystem {
 private:
-    mutable std::mutex mtx;
-    std::vector<Ride> rides;
-    DatabaseManager* dbManager = nullptr;
     LocationGraph locationGraph;
+    OpenRideTable rides{locationGraph};
+    MatchingEngine engine{rides};
+    DatabaseManager* dbManager = nullptr;
+    std::mutex joinMtx;               // one join decides a seat at a time
+    std::atomic<int> nextLocalID{-1}; // IDs for rides added without a database ID
+
+    MatchRequest request(const std::string &from, const std::string &to, RideType rideType, const std::string &userID) const;
 
 public:
     bool initializeLocationGraph(const std::string& dbPath = "areas.db");
     LocationGraph& getLocationGraph() { return locationGraph; }
+    OpenRideTable& getOpenRideTable() { return rides; }
+    MatchingEngine& getMatchingEngine() { return engine; }
     void addRide(const std::string &id, const std::string &from, const std::string &to,
                  const std::string &time, const std::string &mode, RideType rideType = RideType::CARPOOL, bool femalesOnly = false);
+    void addRide(const Ride &ride); // keeps ride.rideID, e.g. after DatabaseManager::insertRide
     std::vector<Ride> findMatches(const std::string &from, const std::string &to, RideType rideType, const std::string &userID = "") const;
-    std::vector<Ride> getAllRides() const;
+    std::vector<Ride> getAllRides() const; // open rides
     crow::json::wvalue getAllRidesJson() const;
     bool joinRide(const std::string &userID, const std::string &from, const std::string &to, RideType rideType);
     void setDatabaseManager(DatabaseManager* db) { dbManager = db; }
 };
-#endif // RIDESYSTEM_H
\ No newline at end of file
+#endif // RIDESYSTEM_H
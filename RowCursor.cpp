@@ -0,0 +1,46 @@
+#include "RowCursor.h"
+
+RowCursor& RowCursor::operator=(RowCursor&& other) noexcept {
+    if (this != &other) {
+        sqlite3_finalize(stmt);
+        stmt = other.stmt;
+        other.stmt = nullptr;
+    }
+    return *this;
+}
+
+RowCursor::~RowCursor() {
+    sqlite3_finalize(stmt); // no-op for nullptr
+}
+
+bool RowCursor::next() {
+    return stmt && sqlite3_step(stmt) == SQLITE_ROW;
+}
+
+std::string_view RowCursor::text(int column) const {
+    const char* value = (const char*)sqlite3_column_text(stmt, column);
+    if (!value) return {};
+    return std::string_view(value, sqlite3_column_bytes(stmt, column)); // bytes after text(), as SQLite requires
+}
+
+// --- Ride rows ---
+RideView RideCursor::ride() const {
+    RideView ride;
+    ride.rideID = integer(0);
+    ride.ownerID = text(1);
+    ride.from = text(2);
+    ride.to = text(3);
+    ride.time = text(4);
+    ride.mode = text(5);
+    ride.rideType = static_cast<RideType>(integer(6));
+    ride.currentCapacity = integer(7);
+    ride.maxCapacity = integer(8);
+    ride.femalesOnly = integer(9) == 1;
+    std::string_view status = text(10);
+    ride.status = status.empty() ? RideStatus::OPEN : stringToRideStatus(std::string(status));
+    ride.genderPreference = text(11);
+    if (ride.genderPreference.empty()) ride.genderPreference = "any";
+    ride.departAt = sqlite3_column_int64(stmt, 12);
+    ride.departWindow = integer(13);
+    return ride;
+}
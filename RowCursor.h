@@ -0,0 +1,48 @@
+#ifndef ROWCURSOR_H
+#define ROWCURSOR_H
+
+#include <sqlite3.h>
+#include <string_view>
+#include "Ride.h"
+
+// Forward-only cursor over a prepared statement's result rows; the statement
+// is finalized when the cursor goes away. text() views point into SQLite's
+// row buffer and are only valid until the next call to next(), so handlers
+// serialize each row before stepping on.
+class RowCursor {
+protected:
+    sqlite3_stmt* stmt = nullptr;
+
+public:
+    RowCursor() = default; // empty cursor, e.g. when prepare failed
+    explicit RowCursor(sqlite3_stmt* statement) : stmt(statement) {}
+    RowCursor(RowCursor&& other) noexcept : stmt(other.stmt) { other.stmt = nullptr; }
+    RowCursor& operator=(RowCursor&& other) noexcept;
+    RowCursor(const RowCursor&) = delete;
+    RowCursor& operator=(const RowCursor&) = delete;
+    ~RowCursor();
+
+    // Steps to the next row; false at the end, on error, or for an empty cursor
+    bool next();
+    int integer(int column) const { return sqlite3_column_int(stmt, column); }
+    std::string_view text(int column) const; // empty for NULL
+};
+
+// Rows of `rides` in getAllRides/listRides column order
+class RideCursor : public RowCursor {
+public:
+    using RowCursor::RowCursor;
+    RideView ride() const;
+    std::string_view leadName() const { return text(14); } // listings that join users only
+};
+
+// Join requests with the requester's name: (user_id, name, created_at)
+class JoinRequestCursor : public RowCursor {
+public:
+    using RowCursor::RowCursor;
+    std::string_view userID() const { return text(0); }
+    std::string_view userName() const { return text(1); }
+    std::string_view timestamp() const { return text(2); }
+};
+
+#endif // ROWCURSOR_H
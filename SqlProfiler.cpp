@@ -0,0 +1,132 @@
+#include "SqlProfiler.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+SqlProfiler::SqlProfiler() : slowThresholdMicros(50000) {
+    if (const char* ms = std::getenv("UNIRIDE_SLOW_QUERY_MS")) {
+        slowThresholdMicros.store(static_cast<uint64_t>(std::atof(ms) * 1000.0), std::memory_order_relaxed);
+    }
+}
+
+void SqlProfiler::attach(sqlite3* db) {
+    sqlite3_trace_v2(db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, &SqlProfiler::traceCallback, this);
+}
+
+void SqlProfiler::detach(sqlite3* db) {
+    sqlite3_trace_v2(db, 0, nullptr, nullptr);
+}
+
+// A statement run is timed from its STMT event to its PROFILE event on the
+// stepping thread; SQLite's own PROFILE duration has only millisecond
+// resolution on most platforms. Rows are counted in between.
+struct PendingRun {
+    std::chrono::steady_clock::time_point start;
+    uint64_t rows = 0;
+};
+static thread_local std::unordered_map<sqlite3_stmt*, PendingRun> pendingRuns;
+
+int SqlProfiler::traceCallback(unsigned type, void* self, void* p, void* x) {
+    auto* stmt = static_cast<sqlite3_stmt*>(p);
+    if (type == SQLITE_TRACE_STMT) {
+        pendingRuns[stmt] = PendingRun{std::chrono::steady_clock::now(), 0};
+    } else if (type == SQLITE_TRACE_ROW) {
+        ++pendingRuns[stmt].rows;
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        uint64_t nanos = static_cast<uint64_t>(*static_cast<sqlite3_int64*>(x));
+        uint64_t rows = 0;
+        auto run = pendingRuns.find(stmt);
+        if (run != pendingRuns.end()) {
+            nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - run->second.start).count());
+            rows = run->second.rows;
+            pendingRuns.erase(run);
+        }
+        static_cast<SqlProfiler*>(self)->onProfile(stmt, nanos, rows);
+    }
+    return 0;
+}
+
+std::string SqlProfiler::normalize(const char* sql) {
+    std::string out;
+    if (!sql) return out;
+    bool space = false;
+    for (const char* c = sql; *c; ++c) {
+        if (*c == ' ' || *c == '\n' || *c == '\t' || *c == '\r') {
+            space = !out.empty();
+            continue;
+        }
+        if (space) out += ' ';
+        space = false;
+        out += *c;
+    }
+    if (!out.empty() && out.back() == ';') out.pop_back();
+    return out;
+}
+
+void SqlProfiler::onProfile(sqlite3_stmt* stmt, uint64_t nanos, uint64_t rows) {
+    uint64_t micros = nanos / 1000;
+    std::string sql = normalize(sqlite3_sql(stmt));
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        Stats& s = stats[sql];
+        ++s.count;
+        s.totalMicros += micros;
+        s.maxMicros = std::max(s.maxMicros, micros);
+        s.rows += rows;
+        ++s.buckets[LatencyBuckets::indexFor(micros)];
+    }
+
+    if (micros >= slowThreshold()) {
+        char* expanded = sqlite3_expanded_sql(stmt);
+        LOG_WARN("Slow query " << micros / 1000.0 << " ms, " << rows << " rows: "
+                 << (expanded ? expanded : sql.c_str()));
+        sqlite3_free(expanded);
+    }
+}
+
+void SqlProfiler::writeJson(JsonWriter& out) const {
+    std::vector<std::pair<std::string, Stats>> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        sorted.assign(stats.begin(), stats.end());
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.totalMicros > b.second.totalMicros;
+    });
+
+    auto ms = [](double micros) { return std::to_string(micros / 1000.0); };
+
+    out.beginObject();
+    out.key("slowThresholdMs").raw(ms(static_cast<double>(slowThreshold())));
+    out.key("statements").beginArray();
+    for (const auto& entry : sorted) {
+        const Stats& s = entry.second;
+        uint64_t rank = (s.count * 99 + 99) / 100; // ceil(0.99 * count)
+        uint64_t seen = 0;
+        int p99 = 0;
+        for (; p99 < LatencyBuckets::COUNT - 1; ++p99) {
+            seen += s.buckets[p99];
+            if (seen >= rank) break;
+        }
+        out.beginObject()
+            .field("sql", entry.first)
+            .field("count", s.count)
+            .key("totalMs").raw(ms(static_cast<double>(s.totalMicros)))
+            .key("avgMs").raw(ms(static_cast<double>(s.totalMicros) / static_cast<double>(s.count)))
+            .key("p99Ms").raw(ms(std::min(LatencyBuckets::upperBoundMicros(p99), static_cast<double>(s.maxMicros))))
+            .key("maxMs").raw(ms(static_cast<double>(s.maxMicros)))
+            .field("rows", s.rows)
+            .endObject();
+    }
+    out.endArray();
+    out.endObject();
+}
+
+void SqlProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    stats.clear();
+}
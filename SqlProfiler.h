@@ -0,0 +1,56 @@
+#ifndef SQLPROFILER_H
+#define SQLPROFILER_H
+
+#pragma once
+#include <sqlite3.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Metrics.h"
+
+class JsonWriter;
+
+// Per-statement timing from sqlite3_trace_v2: each run is timed from its
+// STMT event to its PROFILE event and ROW events count the rows stepped. Results are
+// aggregated under the statement's SQL text with bound parameters left as
+// '?' and whitespace collapsed, so every call of a query shares one entry.
+// Statements slower than the threshold are logged with their parameters
+// expanded.
+class SqlProfiler {
+public:
+    struct Stats {
+        uint64_t count = 0;
+        uint64_t totalMicros = 0;
+        uint64_t maxMicros = 0;
+        uint64_t rows = 0;
+        std::array<uint32_t, LatencyBuckets::COUNT> buckets{};
+    };
+
+private:
+    mutable std::mutex mtx; // guards stats
+    std::unordered_map<std::string, Stats> stats;
+    std::atomic<uint64_t> slowThresholdMicros;
+
+    static int traceCallback(unsigned type, void* self, void* p, void* x);
+    void onProfile(sqlite3_stmt* stmt, uint64_t nanos, uint64_t rows);
+    static std::string normalize(const char* sql);
+
+public:
+    // Threshold defaults to UNIRIDE_SLOW_QUERY_MS, or 50 ms when unset
+    SqlProfiler();
+
+    void attach(sqlite3* db);
+    static void detach(sqlite3* db);
+
+    void setSlowThresholdMicros(uint64_t micros) { slowThresholdMicros.store(micros, std::memory_order_relaxed); }
+    uint64_t slowThreshold() const { return slowThresholdMicros.load(std::memory_order_relaxed); }
+
+    // {"slowThresholdMs":..,"statements":[{sql,count,totalMs,avgMs,p99Ms,maxMs,rows}]}, slowest total first
+    void writeJson(JsonWriter& out) const;
+    void reset();
+};
+
+#endif // SQLPROFILER_H
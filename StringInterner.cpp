@@ -0,0 +1,24 @@
+#include "StringInterner.h"
+#include <stdexcept>
+
+uint32_t StringInterner::intern(std::string_view value) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = ids.find(value);
+    if (it != ids.end()) return it->second;
+
+    uint32_t id = count.load(std::memory_order_relaxed);
+    uint32_t chunk = id >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS) throw std::length_error("StringInterner is full");
+    if (!chunks[chunk]) chunks[chunk].reset(new std::string[CHUNK_SIZE]);
+    std::string& slot = chunks[chunk][id & (CHUNK_SIZE - 1)];
+    slot.assign(value.data(), value.size());
+    ids.emplace(std::string_view(slot), id);
+    count.store(id + 1, std::memory_order_release); // publish after the slot is written
+    return id;
+}
+
+uint32_t StringInterner::find(std::string_view value) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = ids.find(value);
+    return it == ids.end() ? NONE : it->second;
+}
@@ -0,0 +1,49 @@
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Maps strings to dense 32-bit handles and back. Handles are never reused
+// and str() references stay valid for the interner's lifetime, so hot
+// structures can store a uint32_t instead of a std::string and compare
+// handles instead of characters. Safe to use from several threads; str()
+// takes no lock, since strings live in fixed chunks that never move.
+class StringInterner {
+private:
+    static constexpr uint32_t CHUNK_BITS = 12;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static constexpr uint32_t MAX_CHUNKS = 1024; // 4M strings
+
+    std::unique_ptr<std::string[]> chunks[MAX_CHUNKS];
+    std::atomic<uint32_t> count{0};
+    std::unordered_map<std::string_view, uint32_t> ids;
+    mutable std::mutex mtx; // guards ids and appends
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    StringInterner() = default;
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Returns the existing handle or assigns the next one
+    uint32_t intern(std::string_view value);
+    // Lookup only; NONE when the string was never interned
+    uint32_t find(std::string_view value) const;
+    // Empty string for NONE or unknown handles
+    const std::string& str(uint32_t id) const {
+        static const std::string empty;
+        if (id >= count.load(std::memory_order_acquire)) return empty;
+        return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+    }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+};
+
+#endif // STRINGINTERNER_H
@@ -0,0 +1,129 @@
+#include "Tracer.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+Tracer::Tracer() : origin(std::chrono::steady_clock::now()) {}
+
+Tracer::~Tracer() {
+    close();
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Context& Tracer::context() {
+    thread_local Context ctx;
+    return ctx;
+}
+
+Tracer::Context Tracer::detach() {
+    Context& ctx = context();
+    Context moved = std::move(ctx);
+    ctx = Context();
+    return moved;
+}
+
+void Tracer::attach(Context&& moved) {
+    context() = std::move(moved);
+}
+
+bool Tracer::open(const std::string& path, double sampleRate) {
+    if (sampleRate <= 0.0) return false;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    file.open(path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        LOG_ERROR("Cannot open trace file: " << path);
+        return false;
+    }
+    file << "[\n";
+    firstEvent = true;
+    sampleEvery = static_cast<uint32_t>(std::lround(1.0 / std::min(sampleRate, 1.0)));
+    if (sampleEvery == 0) sampleEvery = 1;
+    enabled.store(true, std::memory_order_release);
+    LOG_INFO("Tracing one request in " << sampleEvery << " to " << path);
+    return true;
+}
+
+void Tracer::close() {
+    enabled.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (file.is_open()) {
+        file << "\n]\n";
+        file.close();
+    }
+}
+
+uint64_t Tracer::nowMicros() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin).count());
+}
+
+void Tracer::beginRequest(const std::string& name) {
+    Context& ctx = context();
+    ctx.sampled = false;
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    uint64_t n = requestCounter.fetch_add(1, std::memory_order_relaxed);
+    if (n % sampleEvery != 0) return;
+
+    ctx.sampled = true;
+    ctx.traceID = n + 1;
+    ctx.requestName = name;
+    ctx.events.clear();
+    ctx.startMicros = nowMicros();
+}
+
+void Tracer::endRequest() {
+    Context& ctx = context();
+    if (!ctx.sampled) return;
+    ctx.sampled = false;
+    flush(ctx, nowMicros());
+}
+
+// Complete ("X") events; the request itself is the outermost span
+void Tracer::flush(Context& ctx, uint64_t endMicros) {
+    thread_local int threadID = 0;
+    static std::atomic<int> nextThreadID{1};
+    if (threadID == 0) threadID = nextThreadID.fetch_add(1, std::memory_order_relaxed);
+
+    JsonWriter json;
+    auto writeEvent = [&](std::string_view name, const char* category, uint64_t start, uint64_t duration) {
+        json.beginObject();
+        json.field("name", name);
+        json.field("cat", category);
+        json.field("ph", "X");
+        json.field("ts", start);
+        json.field("dur", duration);
+        json.field("pid", 1);
+        json.field("tid", threadID);
+        json.key("args");
+        json.beginObject();
+        json.field("trace", ctx.traceID);
+        json.endObject();
+        json.endObject();
+    };
+
+    std::string out;
+    json.clear();
+    writeEvent(ctx.requestName, "request", ctx.startMicros, endMicros - ctx.startMicros);
+    out += json.str();
+    for (const Event& event : ctx.events) {
+        json.clear();
+        writeEvent(event.name, event.category, event.startMicros, event.durationMicros);
+        out += ",\n";
+        out += json.str();
+    }
+    ctx.events.clear();
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!file.is_open()) return;
+    if (!firstEvent) file << ",\n";
+    file << out;
+    file.flush();
+    firstEvent = false;
+}
@@ -0,0 +1,109 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Request-scoped tracing written as Chrome trace-event JSON (open the file
+// in chrome://tracing or ui.perfetto.dev). A request is either sampled as a
+// whole or not at all: beginRequest() decides once and stores the answer
+// in a thread-local context, so spans in unsampled requests cost a single
+// thread-local load. Spans are buffered per thread and appended to the file
+// when the request ends.
+class Tracer {
+public:
+    struct Event {
+        const char* name;
+        const char* category;
+        uint64_t startMicros;
+        uint64_t durationMicros;
+    };
+
+    struct Context {
+        bool sampled = false;
+        uint64_t traceID = 0;
+        uint64_t startMicros = 0;
+        std::string requestName;
+        std::vector<Event> events;
+    };
+
+private:
+    std::mutex mtx; // guards file and firstEvent
+    std::ofstream file;
+    bool firstEvent = true;
+    std::atomic<bool> enabled{false};
+    std::atomic<uint64_t> requestCounter{0};
+    uint32_t sampleEvery = 0; // 0 = never, 1 = every request, N = one in N
+    std::chrono::steady_clock::time_point origin;
+
+    Tracer();
+    void flush(Context& context, uint64_t endMicros);
+
+public:
+    ~Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    static Tracer& instance();
+    static Context& context();
+
+    // sampleRate in (0, 1]; rounded to "one request in N"
+    bool open(const std::string& path, double sampleRate);
+    void close();
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void beginRequest(const std::string& name);
+    void endRequest();
+
+    uint64_t nowMicros() const;
+    static bool active() { return context().sampled; }
+
+    // Move a request to another thread (e.g. an executor hop): detach()
+    // takes the current thread's context, attach() installs it where the
+    // request continues
+    static Context detach();
+    static void attach(Context&& moved);
+};
+
+// Times the enclosing scope when the current request is sampled
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    uint64_t start = 0;
+    bool recording;
+
+public:
+    explicit TraceSpan(const char* spanName, const char* spanCategory = "app")
+        : name(spanName), category(spanCategory), recording(Tracer::active()) {
+        if (recording) start = Tracer::instance().nowMicros();
+    }
+    ~TraceSpan() {
+        if (!recording) return;
+        Tracer::Context& ctx = Tracer::context();
+        if (ctx.sampled) ctx.events.push_back({name, category, start, Tracer::instance().nowMicros() - start});
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+// Scope that starts and ends a request; for code outside the HTTP middleware
+class TraceRequest {
+public:
+    explicit TraceRequest(const std::string& name) { Tracer::instance().beginRequest(name); }
+    ~TraceRequest() { Tracer::instance().endRequest(); }
+    TraceRequest(const TraceRequest&) = delete;
+    TraceRequest& operator=(const TraceRequest&) = delete;
+};
+
+#define UNIRIDE_TRACE_CONCAT_INNER(a, b) a##b
+#define UNIRIDE_TRACE_CONCAT(a, b) UNIRIDE_TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name, category) TraceSpan UNIRIDE_TRACE_CONCAT(uniride_trace_span_, __LINE__)(name, category)
+
+#endif // TRACER_H
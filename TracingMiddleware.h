@@ -0,0 +1,28 @@
+#ifndef TRACINGMIDDLEWARE_H
+#define TRACINGMIDDLEWARE_H
+
+#pragma once
+#include "Metrics.h"
+#include "Tracer.h"
+#include "crow.h"
+
+// Opens a trace context per request so spans in handlers, DatabaseManager
+// and ChatFeature land in the same trace. The context is thread-local:
+// handlers that hand work to an executor move it along with
+// Tracer::detach()/attach() and end the request on the worker, so
+// after_handle then finds nothing left to close.
+struct TracingMiddleware {
+    struct context {};
+
+    void before_handle(crow::request& req, crow::response& /*res*/, context& /*ctx*/) {
+        Tracer& tracer = Tracer::instance();
+        if (!tracer.isEnabled()) return;
+        tracer.beginRequest(Metrics::normalizeRoute(crow::method_name(req.method), req.url));
+    }
+
+    void after_handle(crow::request& /*req*/, crow::response& /*res*/, context& /*ctx*/) {
+        Tracer::instance().endRequest();
+    }
+};
+
+#endif // TRACINGMIDDLEWARE_H
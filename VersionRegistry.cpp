@@ -0,0 +1,70 @@
+#include "VersionRegistry.h"
+#include <chrono>
+#include <mutex>
+
+VersionRegistry::VersionRegistry() {
+    epoch = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+uint64_t VersionRegistry::lookup(const std::unordered_map<int, uint64_t>& map, int key) {
+    auto it = map.find(key);
+    return it == map.end() ? 0 : it->second;
+}
+
+uint64_t VersionRegistry::bumpGlobal() {
+    return global.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+uint64_t VersionRegistry::bumpRide(int rideID, bool affectsListing) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    uint64_t v = bumpGlobal();
+    rides[rideID] = v;
+    if (affectsListing) rideSet.store(v, std::memory_order_release);
+    return v;
+}
+
+uint64_t VersionRegistry::bumpUser(const std::string& userID) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    uint64_t v = bumpGlobal();
+    users[userID] = v;
+    return v;
+}
+
+uint64_t VersionRegistry::bumpNames() {
+    uint64_t v = bumpGlobal();
+    names.store(v, std::memory_order_release);
+    return v;
+}
+
+uint64_t VersionRegistry::bumpChat(int rideID) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    uint64_t v = bumpGlobal();
+    chats[rideID] = v;
+    return v;
+}
+
+uint64_t VersionRegistry::rideVersion(int rideID) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return lookup(rides, rideID);
+}
+
+uint64_t VersionRegistry::userVersion(const std::string& userID) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = users.find(userID);
+    return it == users.end() ? 0 : it->second;
+}
+
+uint64_t VersionRegistry::chatVersion(int rideID) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return lookup(chats, rideID);
+}
+
+std::string VersionRegistry::etag(const char* scope, uint64_t version, bool includeNames) const {
+    std::string tag = "\"" + std::to_string(epoch) + "-" + scope + "-" + std::to_string(version);
+    if (includeNames) {
+        tag += "-" + std::to_string(namesVersion());
+    }
+    tag += "\"";
+    return tag;
+}
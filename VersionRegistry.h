@@ -0,0 +1,48 @@
+#ifndef VERSIONREGISTRY_H
+#define VERSIONREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+// Monotonic change counters used to build ETags for polled endpoints.
+// Every bump draws from one global counter, so an entity's version is the
+// global version of its last mutation (0 = untouched since startup). The
+// process epoch goes into each ETag so a restart never validates old tags.
+class VersionRegistry {
+private:
+    std::atomic<uint64_t> global{0};
+    std::atomic<uint64_t> rideSet{0};  // last change to any ride
+    std::atomic<uint64_t> names{0};    // last change to any user's display data
+    uint64_t epoch;
+
+    mutable std::shared_mutex mtx;
+    std::unordered_map<int, uint64_t> rides;
+    std::unordered_map<int, uint64_t> chats;
+    std::unordered_map<std::string, uint64_t> users;
+
+    static uint64_t lookup(const std::unordered_map<int, uint64_t>& map, int key);
+
+public:
+    VersionRegistry();
+
+    uint64_t bumpGlobal();
+    uint64_t bumpRide(int rideID, bool affectsListing = true);
+    uint64_t bumpUser(const std::string& userID);
+    uint64_t bumpNames();
+    uint64_t bumpChat(int rideID);
+
+    uint64_t globalVersion() const { return global.load(std::memory_order_acquire); }
+    uint64_t rideSetVersion() const { return rideSet.load(std::memory_order_acquire); }
+    uint64_t namesVersion() const { return names.load(std::memory_order_acquire); }
+    uint64_t rideVersion(int rideID) const;
+    uint64_t userVersion(const std::string& userID) const;
+    uint64_t chatVersion(int rideID) const;
+
+    // Quoted strong ETag: "<epoch>-<scope>-<version>[-<namesVersion>]"
+    std::string etag(const char* scope, uint64_t version, bool includeNames = false) const;
+};
+
+#endif // VERSIONREGISTRY_H
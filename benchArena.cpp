@@ -0,0 +1,151 @@
+// Allocation cost of the /request/create match response: the heap-backed
+// path (User per lookup, std::vector<Ride>, std::string display) against the
+// per-request arena path (RideView results, names and display strings in a
+// RequestArena). malloc/calloc/realloc are interposed below, so SQLite's and
+// libstdc++'s allocations are counted too. The handler bodies mirror main.cpp
+// minus Crow.
+// Usage: uniride_arena_bench [rides=1000] [iterations=2000]
+#include "DatabaseManager.h"
+#include "JsonWriter.h"
+#include "Logger.h"
+#include "MatchingEngine.h"
+#include "OpenRideTable.h"
+#include "RequestArena.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// --- malloc-counting hook (glibc) ---
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static std::atomic<uint64_t> mallocCalls{0};
+
+extern "C" void* malloc(size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    mallocCalls.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+static const char* AREAS[] = {"Gulshan-e-Iqbal Block 13", "Gulshan-e-Iqbal Block 10", "North Nazimabad Block H",
+                              "Federal B Area Block 16", "Malir Cantt", "DHA Phase 5", "Saddar", "Korangi"};
+static const int AREA_COUNT = sizeof(AREAS) / sizeof(AREAS[0]);
+
+// Before: the handler as it was, every temporary on the heap
+static size_t heapRequest(DatabaseManager& db, JsonWriter& json) {
+    std::string userID = "searcher";
+    User user = db.getUserByID(userID);
+    auto matches = db.findMatchingRides(AREAS[0], "NED Campus", RideType::CARPOOL, userID, user.gender, false);
+    json.clear();
+    json.beginObject().field("rideType", rideTypeToString(RideType::CARPOOL));
+    json.key("matches").beginArray();
+    for (const auto& match : matches) {
+        User leadUser = db.getUserByID(match.ownerID);
+        std::string display = leadUser.name + " - " + rideTypeToString(match.rideType) + " - " +
+                              std::to_string(match.getAvailableSlots()) + " seats";
+        json.beginObject()
+            .field("rideID", match.rideID)
+            .field("leadUserID", match.ownerID)
+            .field("leadUserName", leadUser.name)
+            .field("leadDisplay", display)
+            .field("from", match.from)
+            .field("to", match.to)
+            .field("time", match.time)
+            .field("rideType", rideTypeToString(match.rideType))
+            .field("availableSlots", match.getAvailableSlots())
+            .endObject();
+    }
+    json.endArray().endObject();
+    return matches.size();
+}
+
+// After: the same response built from the request arena
+static size_t arenaRequest(DatabaseManager& db, JsonWriter& json) {
+    std::string userID = "searcher";
+    RequestArena& arena = RequestArena::local();
+    RequestArena::Scope arenaScope(arena);
+    std::string userGender(db.getUserGender(userID, arena));
+    auto matches = db.findMatchingRideViews(AREAS[0], "NED Campus", RideType::CARPOOL, userID, userGender, false, arena);
+    json.clear();
+    json.beginObject().field("rideType", rideTypeToString(RideType::CARPOOL));
+    json.key("matches").beginArray();
+    for (const auto& match : matches) {
+        std::string_view leadName = db.getUserName(match.ownerID, arena);
+        std::pmr::string display(leadName, arena.resource());
+        display.append(" - ").append(rideTypeToString(match.rideType)).append(" - ")
+            .append(std::to_string(match.getAvailableSlots())).append(" seats");
+        json.beginObject()
+            .field("rideID", match.rideID)
+            .field("leadUserID", match.ownerID)
+            .field("leadUserName", leadName)
+            .field("leadDisplay", std::string_view(display))
+            .field("from", match.from)
+            .field("to", match.to)
+            .field("time", match.time)
+            .field("rideType", rideTypeToString(match.rideType))
+            .field("availableSlots", match.getAvailableSlots())
+            .endObject();
+    }
+    json.endArray().endObject();
+    return matches.size();
+}
+
+template <typename Request>
+static void run(const char* name, DatabaseManager& db, int iterations, Request&& request) {
+    JsonWriter json;
+    size_t matched = request(db, json); // warm up caches, the arena and the writer
+    uint64_t before = mallocCalls.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) request(db, json);
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    double calls = double(mallocCalls.load() - before) / iterations;
+    std::cout << name << ": " << elapsed / iterations << " us, " << calls << " malloc calls per request ("
+              << matched << " matches, " << json.size() << " bytes)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int rides = argc > 1 ? std::atoi(argv[1]) : 1000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    std::ofstream devNull("/dev/null");
+    Logger::instance().setSink(&devNull);
+    Logger::setLevel(LogLevel::Warn);
+
+    LocationGraph graph;
+    for (int i = 0; i + 1 < AREA_COUNT; ++i) graph.addEdge(AREAS[i], AREAS[i + 1], 1.0);
+    DatabaseManager db(":memory:");
+    db.initialize();
+    db.setLocationGraph(&graph);
+    OpenRideTable openRides(graph);
+    MatchingEngine matcher(openRides);
+    db.setMatchingEngine(&matcher);
+
+    db.insertUser(User("searcher", "Searcher", "searcher@cloud.neduet.edu.pk", "female"));
+    for (int u = 0; u < 100; ++u) {
+        std::string id = "owner" + std::to_string(u);
+        db.insertUser(User(id, "Owner Number " + std::to_string(u), id + "@cloud.neduet.edu.pk", u % 2 ? "male" : "female"));
+    }
+    for (int i = 0; i < rides; ++i) {
+        Ride ride("owner" + std::to_string(i % 100), AREAS[i % AREA_COUNT], "NED Campus", "now", "offer",
+                  static_cast<RideType>(i % 3), i % 4 == 0);
+        db.insertRide(ride);
+    }
+
+    std::cout << "rides: " << rides << ", iterations: " << iterations << std::endl;
+    run("heap", db, iterations, heapRequest);
+    run("arena", db, iterations, arenaRequest);
+    return 0;
+}
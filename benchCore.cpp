@@ -0,0 +1,698 @@
+// Microbenchmarks for the core data structures and DatabaseManager queries,
+// run against in-memory SQLite databases seeded at several scales.
+// Flags and the JSON schema follow Google Benchmark, so its compare.py and
+// other tooling can diff runs across commits.
+// Usage: uniride_bench [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>]
+//                      [--benchmark_format=console|json] [--benchmark_out=<file>]
+#include "AdmissionControl.h"
+#include "ChatFeature.h"
+#include "DatabaseManager.h"
+#include "JsonWriter.h"
+#include "LocationGraph.h"
+#include "Logger.h"
+#include "MatchingEngine.h"
+#include "OpenRideTable.h"
+#include "RequestQueue.h"
+#include "RideFragmentCache.h"
+#include "RideSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Harness ---
+class BenchState {
+private:
+    using Clock = std::chrono::steady_clock;
+    int64_t maxIterations;
+    int64_t done = 0;
+    int64_t argument;
+    bool running = false;
+    Clock::time_point realStart;
+    std::clock_t cpuStart = 0;
+    double realSeconds = 0;
+    double cpuSeconds = 0;
+
+public:
+    int64_t itemsProcessed = 0;
+
+    BenchState(int64_t iterations, int64_t arg) : maxIterations(iterations), argument(arg) {}
+
+    int64_t range() const { return argument; }
+    int64_t iterations() const { return maxIterations; }
+
+    bool keepRunning() {
+        if (done == 0 && !running) resumeTiming();
+        if (done++ < maxIterations) return true;
+        pauseTiming();
+        return false;
+    }
+
+    void pauseTiming() {
+        if (!running) return;
+        realSeconds += std::chrono::duration<double>(Clock::now() - realStart).count();
+        cpuSeconds += static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        running = false;
+    }
+
+    void resumeTiming() {
+        if (running) return;
+        running = true;
+        cpuStart = std::clock();
+        realStart = Clock::now();
+    }
+
+    double realTime() const { return realSeconds; }
+    double cpuTime() const { return cpuSeconds; }
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<void(BenchState&)> fn;
+    std::vector<int64_t> args; // empty = run once without an argument
+};
+
+static std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+static void registerBenchmark(const std::string& name, std::function<void(BenchState&)> fn,
+                              std::vector<int64_t> args = {}) {
+    registry().push_back({name, std::move(fn), std::move(args)});
+}
+
+// Defeat dead-code elimination of benchmark results
+template <typename T>
+static void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    int64_t iterations;
+    double realNanos; // per iteration
+    double cpuNanos;
+    double itemsPerSecond;
+};
+
+// Grow the iteration count until one run lasts at least minTime, like Google Benchmark
+static Result runBenchmark(const std::string& name, const std::function<void(BenchState&)>& fn, int64_t arg, double minTime) {
+    int64_t iterations = 1;
+    while (true) {
+        BenchState state(iterations, arg);
+        fn(state);
+        double elapsed = state.realTime();
+        if (elapsed >= minTime || iterations >= 1000000000) {
+            double perSecond = elapsed > 0 ? state.itemsProcessed / elapsed : 0;
+            return {name, iterations, elapsed * 1e9 / iterations, state.cpuTime() * 1e9 / iterations, perSecond};
+        }
+        double multiplier = elapsed > 0 ? minTime * 1.4 / elapsed : 10.0;
+        if (elapsed / minTime > 0.1) multiplier = std::min(multiplier, 10.0);
+        multiplier = std::max(multiplier, 2.0);
+        iterations = static_cast<int64_t>(iterations * multiplier);
+    }
+}
+
+// --- Fixtures ---
+static const char* AREAS[] = {
+    "NED Campus", "Gulshan-e-Iqbal Block 13", "North Nazimabad Block H", "DHA Phase 5", "Saddar",
+    "Malir Cantt", "Nazimabad No. 3", "Clifton Block 2", "Federal B Area", "Johar Block 7",
+    "Korangi", "Landhi", "Tariq Road", "PECHS Block 2", "Bahadurabad", "Shah Faisal Colony",
+};
+static const int AREA_COUNT = sizeof(AREAS) / sizeof(AREAS[0]);
+
+static void buildGraph(LocationGraph& graph) {
+    // Each area is connected to its next three neighbours in the list
+    for (int i = 0; i < AREA_COUNT; ++i) {
+        for (int step = 1; step <= 3; ++step) {
+            graph.addEdge(AREAS[i], AREAS[(i + step) % AREA_COUNT], 2.5 * step);
+        }
+    }
+}
+
+// A database with `rides` rides, one owner per ten rides and a join request on
+// every fourth ride; built once per scale and shared across benchmarks
+struct DbFixture {
+    DatabaseManager db{":memory:"};
+    LocationGraph graph;
+    int rides;
+    int users;
+
+    explicit DbFixture(int rideCount) : rides(rideCount), users(std::max(1, rideCount / 10)) {
+        db.initialize();
+        buildGraph(graph);
+        db.setLocationGraph(&graph);
+        for (int u = 0; u < users; ++u) {
+            std::string id = "user" + std::to_string(u);
+            db.insertUser(User(id, "Student " + std::to_string(u), id + "@cloud.neduet.edu.pk", u % 2 ? "female" : "male"));
+        }
+        for (int r = 0; r < rides; ++r) {
+            Ride ride("user" + std::to_string(r % users), AREAS[r % AREA_COUNT], "NED Campus", "now", "offer",
+                      static_cast<RideType>(r % 2), r % 9 == 0);
+            db.insertRide(ride);
+            if (r % 4 == 0) db.insertJoinRequest(ride.rideID, "user" + std::to_string((r + 1) % users));
+            if (r % 3 == 0) db.updateRideStatus(ride.rideID, "completed");
+        }
+    }
+
+    static DbFixture& at(int rides) {
+        static std::map<int, std::unique_ptr<DbFixture>> fixtures;
+        auto& fixture = fixtures[rides];
+        if (!fixture) fixture = std::make_unique<DbFixture>(rides);
+        return *fixture;
+    }
+};
+
+static const std::vector<int64_t> SCALES = {100, 1000, 10000};
+
+static void registerBenchmarks() {
+    // LocationGraph
+    registerBenchmark("LocationGraph/areConnected/hit", [](BenchState& state) {
+        LocationGraph graph;
+        buildGraph(graph);
+        while (state.keepRunning()) doNotOptimize(graph.areConnected(AREAS[3], AREAS[5]));
+    });
+    registerBenchmark("LocationGraph/areConnected/miss", [](BenchState& state) {
+        LocationGraph graph;
+        buildGraph(graph);
+        while (state.keepRunning()) doNotOptimize(graph.areConnected(AREAS[3], AREAS[10]));
+    });
+
+    // Ride
+    registerBenchmark("Ride/construct", [](BenchState& state) {
+        while (state.keepRunning()) {
+            Ride ride("user42", AREAS[1], AREAS[0], "now", "offer", RideType::CARPOOL, false);
+            doNotOptimize(ride);
+        }
+    });
+    registerBenchmark("Ride/approveRequest", [](BenchState& state) {
+        int pending = static_cast<int>(state.range());
+        while (state.keepRunning()) {
+            state.pauseTiming();
+            Ride ride("owner", AREAS[1], AREAS[0], "now", "offer", RideType::CARPOOL, false);
+            ride.maxCapacity = pending + 1;
+            for (int i = 0; i < pending; ++i) ride.addJoinRequest("user" + std::to_string(i));
+            state.resumeTiming();
+            doNotOptimize(ride.approveRequest("user" + std::to_string(pending - 1)));
+        }
+    }, {4, 32, 256});
+
+    // ChatFeature
+    registerBenchmark("ChatFeature/AddMessage", [](BenchState& state) {
+        ChatFeature chat;
+        chat.SetRideLead(1, "lead");
+        std::string err;
+        int64_t n = 0;
+        while (state.keepRunning()) {
+            doNotOptimize(chat.AddMessage("lead", "user1", "See you at the gate", 1, err));
+            if (++n % 1000 == 0) chat.limitMessages(100);
+        }
+        state.itemsProcessed = state.iterations();
+    });
+    registerBenchmark("ChatFeature/getRideMessagesJson", [](BenchState& state) {
+        ChatFeature chat;
+        chat.SetRideLead(1, "lead");
+        std::string err;
+        for (int64_t i = 0; i < state.range(); ++i) chat.AddMessage("lead", "user1", "See you at the gate", 1, err);
+        while (state.keepRunning()) doNotOptimize(chat.getRideMessagesJson(1).dump());
+    }, {10, 100, 1000});
+    registerBenchmark("ChatFeature/writeRideMessagesJson", [](BenchState& state) {
+        ChatFeature chat;
+        chat.SetRideLead(1, "lead");
+        std::string err;
+        for (int64_t i = 0; i < state.range(); ++i) chat.AddMessage("lead", "user1", "See you at the gate", 1, err);
+        JsonWriter json;
+        while (state.keepRunning()) {
+            json.clear();
+            chat.writeRideMessagesJson(1, json);
+            doNotOptimize(json.size());
+        }
+    }, {10, 100, 1000});
+
+    // RequestQueue: lookups by ID, receiver and ride with N requests pending
+    auto fillQueue = [](RequestQueue& queue, int64_t pending) {
+        for (int64_t i = 0; i < pending; ++i) {
+            queue.addRequest("rider" + std::to_string(i), "lead" + std::to_string(i % 1000), static_cast<int>(i % 5000) + 1);
+        }
+    };
+    registerBenchmark("RequestQueue/respondToRequest/miss", [fillQueue](BenchState& state) {
+        RequestQueue queue(nullptr, nullptr);
+        fillQueue(queue, state.range());
+        std::string message;
+        while (state.keepRunning()) doNotOptimize(queue.respondToRequest(-1, true, message));
+    }, {1000, 10000, 100000});
+    // Respond to the oldest request and add a new one, keeping N pending
+    registerBenchmark("RequestQueue/respondAndAdd", [fillQueue](BenchState& state) {
+        RequestQueue queue(nullptr, nullptr);
+        fillQueue(queue, state.range());
+        int oldest = 1;
+        int64_t n = state.range();
+        std::string message;
+        while (state.keepRunning()) {
+            doNotOptimize(queue.respondToRequest(oldest++, true, message));
+            doNotOptimize(queue.addRequest("rider" + std::to_string(n), "lead" + std::to_string(n % 1000),
+                                           static_cast<int>(n % 5000) + 1));
+            ++n;
+        }
+    }, {1000, 10000, 100000});
+    registerBenchmark("RequestQueue/listPendingFor", [fillQueue](BenchState& state) {
+        RequestQueue queue(nullptr, nullptr);
+        fillQueue(queue, state.range());
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(queue.listPendingFor("lead" + std::to_string(n++ % 1000)));
+    }, {1000, 10000, 100000});
+    registerBenchmark("RequestQueue/listPendingForRide", [fillQueue](BenchState& state) {
+        RequestQueue queue(nullptr, nullptr);
+        fillQueue(queue, state.range());
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(queue.listPendingForRide(static_cast<int>(n++ % 5000) + 1));
+    }, {1000, 10000, 100000});
+
+    // RideSystem: in-memory ride table scans; the matching query returns
+    // about one ride in seven
+    auto fillRides = [](RideSystem& system, int64_t count) {
+        buildGraph(system.getLocationGraph());
+        static const char* TIMES[] = {"08:00", "08:30", "09:00", "13:00", "17:30"};
+        for (int64_t i = 0; i < count; ++i) {
+            Ride ride("user" + std::to_string(i % 2500), AREAS[i % AREA_COUNT], "NED Campus", TIMES[i % 5], "offer",
+                      static_cast<RideType>(i % 3), i % 9 == 0);
+            ride.rideID = static_cast<int>(i) + 1;
+            system.addRide(ride);
+        }
+    };
+    // No ride goes to Korangi, so this measures the scan alone
+    registerBenchmark("RideSystem/findMatches/scan", [fillRides](BenchState& state) {
+        RideSystem system;
+        fillRides(system, state.range());
+        while (state.keepRunning()) doNotOptimize(system.findMatches(AREAS[4], "Korangi", RideType::CARPOOL));
+        state.itemsProcessed = state.iterations() * state.range();
+    }, {1000, 10000, 100000});
+    registerBenchmark("RideSystem/findMatches", [fillRides](BenchState& state) {
+        RideSystem system;
+        fillRides(system, state.range());
+        while (state.keepRunning()) doNotOptimize(system.findMatches(AREAS[4], "NED Campus", RideType::CARPOOL));
+        state.itemsProcessed = state.iterations() * state.range();
+    }, {1000, 10000, 100000});
+    registerBenchmark("RideSystem/getAllRides", [fillRides](BenchState& state) {
+        RideSystem system;
+        fillRides(system, state.range());
+        while (state.keepRunning()) doNotOptimize(system.getAllRides());
+        state.itemsProcessed = state.iterations() * state.range();
+    }, {1000, 10000, 100000});
+    // Contention: one RideSystem shared by readers and a writer. The searcher is
+    // a registered female user, so females-only matches need her gender from
+    // SQLite. /findMatches times a reader against a writer adding and joining a
+    // ride every 100us; /write times add+join against three busy readers.
+    // Run on several cores; on one core both mostly measure time slicing.
+    auto contended = [fillRides](BenchState& state, bool timeWriter) {
+        DatabaseManager db(":memory:");
+        db.initialize();
+        db.insertUser(User("rider", "Rider", "rider@cloud.neduet.edu.pk", "female"));
+        RideSystem system;
+        system.setDatabaseManager(&db);
+        fillRides(system, state.range());
+        std::atomic<bool> stop{false};
+        std::atomic<int64_t> written{0};
+        auto write = [&system, &written]() {
+            int64_t n = written.fetch_add(1);
+            system.addRide("owner" + std::to_string(n), AREAS[n % AREA_COUNT], "NED Campus", "09:00", "offer");
+            system.joinRide("rider" + std::to_string(n), AREAS[4], "NED Campus", RideType::CARPOOL);
+        };
+        std::vector<std::thread> others;
+        if (timeWriter) {
+            for (int t = 0; t < 3; ++t) {
+                others.emplace_back([&]() {
+                    while (!stop.load()) doNotOptimize(system.findMatches(AREAS[4], "NED Campus", RideType::CARPOOL, "rider"));
+                });
+            }
+            while (state.keepRunning()) write();
+        } else {
+            // Writes that never match the query, so a faster writer does not grow the reader's result
+            others.emplace_back([&]() {
+                for (int64_t n = 0; !stop.load(); ++n) {
+                    system.addRide("owner" + std::to_string(n), AREAS[n % AREA_COUNT], "Korangi", "09:00", "offer", RideType::BIKE);
+                    system.joinRide("rider", AREAS[n % AREA_COUNT], "Korangi", RideType::BIKE);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+            while (state.keepRunning()) doNotOptimize(system.findMatches(AREAS[4], "NED Campus", RideType::CARPOOL, "rider"));
+        }
+        stop = true;
+        for (auto& thread : others) thread.join();
+    };
+    registerBenchmark("RideSystem/contended/findMatches", [contended](BenchState& state) { contended(state, false); },
+                      {10000});
+    registerBenchmark("RideSystem/contended/write", [contended](BenchState& state) { contended(state, true); },
+                      {10000});
+
+    // Admission: one check per request in front of every route. Limits are
+    // high enough that every request is admitted, so this times the bucket
+    // CAS and in-flight counter; /contended adds three threads admitting
+    // for the same keys.
+    auto admit = [](BenchState& state, bool contendedKeys) {
+        AdmissionControl::Limits limits;
+        limits.userRate = limits.ipRate = 1000000;
+        limits.userBurst = limits.ipBurst = 16000;
+        AdmissionControl admission(limits);
+        std::vector<std::string> users, ips;
+        for (int64_t i = 0; i < state.range(); ++i) {
+            users.push_back("user" + std::to_string(i));
+            ips.push_back("10.0." + std::to_string(i / 256 % 256) + "." + std::to_string(i % 256));
+        }
+        auto once = [&](int64_t n) {
+            size_t k = static_cast<size_t>(n % state.range());
+            auto decision = admission.admit(AdmissionControl::RouteClass::POLL, users[k], ips[k]);
+            if (decision.verdict == AdmissionControl::Verdict::ADMIT) admission.release(AdmissionControl::RouteClass::POLL);
+            doNotOptimize(decision);
+        };
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> others;
+        if (contendedKeys) {
+            for (int t = 0; t < 3; ++t) {
+                others.emplace_back([&]() {
+                    for (int64_t n = 0; !stop.load(std::memory_order_relaxed); ++n) once(n);
+                });
+            }
+        }
+        int64_t n = 0;
+        while (state.keepRunning()) once(n++);
+        stop = true;
+        for (auto& thread : others) thread.join();
+    };
+    registerBenchmark("AdmissionControl/admit", [admit](BenchState& state) { admit(state, false); }, {1, 1000, 100000});
+    registerBenchmark("AdmissionControl/admit/contended", [admit](BenchState& state) { admit(state, true); }, {1, 1000});
+
+    // MatchingEngine: the default stage pipeline over N open rides. count()
+    // skips materialization, so it is the raw scan; match() builds the Rides.
+    auto fillTable = [](OpenRideTable& table, int64_t count) {
+        std::vector<Ride> rides;
+        for (int64_t i = 0; i < count; ++i) {
+            Ride ride("user" + std::to_string(i % 2500), AREAS[i % AREA_COUNT], AREAS[(i / AREA_COUNT) % 4],
+                      "08:30", "offer", static_cast<RideType>(i % 3), i % 9 == 0);
+            ride.rideID = static_cast<int>(i) + 1;
+            if (i % 5 == 0) ride.currentCapacity = ride.maxCapacity;
+            rides.push_back(std::move(ride));
+        }
+        table.replaceAll(rides);
+    };
+    auto matchRequest = []() {
+        MatchRequest request;
+        request.from = AREAS[4];
+        request.to = "NED Campus";
+        request.userID = "user1";
+        request.userGender = "male";
+        request.genderPreference = "male";
+        return request;
+    };
+    auto scanTable = [fillTable, matchRequest](BenchState& state, bool vectorized) {
+        LocationGraph graph;
+        buildGraph(graph);
+        OpenRideTable table(graph);
+        table.setVectorized(vectorized);
+        fillTable(table, state.range());
+        MatchingEngine engine(table);
+        MatchRequest request = matchRequest();
+        while (state.keepRunning()) doNotOptimize(engine.count(request));
+        state.itemsProcessed = state.iterations() * state.range();
+    };
+    registerBenchmark("MatchingEngine/count/scalar", [scanTable](BenchState& state) { scanTable(state, false); },
+                      {1000, 10000, 100000});
+    if (OpenRideTable::avx2Supported()) {
+        registerBenchmark("MatchingEngine/count/avx2", [scanTable](BenchState& state) { scanTable(state, true); },
+                          {1000, 10000, 100000});
+    }
+    registerBenchmark("MatchingEngine/match", [fillTable, matchRequest](BenchState& state) {
+        LocationGraph graph;
+        buildGraph(graph);
+        OpenRideTable table(graph);
+        fillTable(table, state.range());
+        MatchingEngine engine(table);
+        MatchRequest request = matchRequest();
+        while (state.keepRunning()) doNotOptimize(engine.match(request));
+        state.itemsProcessed = state.iterations() * state.range();
+    }, {1000, 10000, 100000});
+    registerBenchmark("MatchingEngine/match/fullestFirst", [fillTable, matchRequest](BenchState& state) {
+        LocationGraph graph;
+        buildGraph(graph);
+        OpenRideTable table(graph);
+        fillTable(table, state.range());
+        MatchingEngine engine(table);
+        engine.setScorer(std::make_unique<FullestFirstScorer>());
+        MatchRequest request = matchRequest();
+        while (state.keepRunning()) doNotOptimize(engine.match(request, 10));
+        state.itemsProcessed = state.iterations() * state.range();
+    }, {1000, 10000, 100000});
+
+    // A week of scheduled rides posted in random departure order. A search
+    // with a departure window only scans the blocks of its hour buckets;
+    // anyTime is the same search scanning every block.
+    auto weekSearch = [matchRequest](BenchState& state, bool withWindow) {
+        LocationGraph graph;
+        buildGraph(graph);
+        OpenRideTable table(graph);
+        const int64_t weekStart = 1767225600; // 2026-01-01 00:00 UTC
+        std::mt19937 rng(42);
+        for (int64_t i = 0; i < state.range(); ++i) {
+            Ride ride("user" + std::to_string(i % 2500), AREAS[i % AREA_COUNT], AREAS[(i / AREA_COUNT) % 4],
+                      "scheduled", "offer", static_cast<RideType>(i % 3), i % 9 == 0);
+            ride.rideID = static_cast<int>(i) + 1;
+            ride.departAt = weekStart + rng() % (7 * 24 * 3600);
+            ride.departWindow = DEFAULT_DEPART_WINDOW;
+            table.upsert(ride);
+        }
+        MatchingEngine engine(table);
+        MatchRequest request = matchRequest();
+        if (withWindow) {
+            request.departAt = weekStart + 2 * 24 * 3600 + 8 * 3600; // day 3, 08:00
+            request.departWindow = DEFAULT_DEPART_WINDOW;
+        }
+        while (state.keepRunning()) doNotOptimize(engine.count(request));
+        state.itemsProcessed = state.iterations() * state.range();
+    };
+    registerBenchmark("MatchingEngine/count/week/departureWindow", [weekSearch](BenchState& state) { weekSearch(state, true); },
+                      {1000, 10000, 100000});
+    registerBenchmark("MatchingEngine/count/week/anyTime", [weekSearch](BenchState& state) { weekSearch(state, false); },
+                      {1000, 10000, 100000});
+
+    // DatabaseManager
+    registerBenchmark("DatabaseManager/getUserByID", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(f.db.getUserByID("user" + std::to_string(n++ % f.users)));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getRideByID", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(f.db.getRideByID(static_cast<int>(n++ % f.rides) + 1));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getAllRides", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        while (state.keepRunning()) doNotOptimize(f.db.getAllRides());
+        state.itemsProcessed = state.iterations() * f.rides;
+    }, SCALES);
+    registerBenchmark("DatabaseManager/listRides/page50", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        RideFilter filter;
+        filter.status = "open";
+        while (state.keepRunning()) doNotOptimize(f.db.listRides(filter, f.rides / 2, 50));
+    }, SCALES);
+    // A 200-row /ride/all page serialized from owned rows vs straight off the cursor
+    registerBenchmark("DatabaseManager/listRides/page200/json", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        JsonWriter json;
+        while (state.keepRunning()) {
+            json.clear();
+            json.beginArray();
+            for (const auto& item : f.db.listRides(RideFilter(), 0, 200)) {
+                RideFragmentCache::writeRide(json, item.first, item.second);
+            }
+            json.endArray();
+            doNotOptimize(json.size());
+        }
+    }, SCALES);
+    registerBenchmark("DatabaseManager/scanRides/page200/json", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        JsonWriter json;
+        while (state.keepRunning()) {
+            json.clear();
+            json.beginArray();
+            RideCursor rides = f.db.scanRides(RideFilter(), 0, 200);
+            while (rides.next()) RideFragmentCache::writeRide(json, rides.ride(), rides.leadName());
+            json.endArray();
+            doNotOptimize(json.size());
+        }
+    }, SCALES);
+    registerBenchmark("DatabaseManager/findMatchingRides", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        while (state.keepRunning()) {
+            doNotOptimize(f.db.findMatchingRides(AREAS[2], "NED Campus", RideType::CARPOOL, "user1", "any", false));
+        }
+    }, SCALES);
+    // Same queries served by a MatchingEngine attached for the duration of the run
+    registerBenchmark("DatabaseManager/findMatchingRides/matchingEngine", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        OpenRideTable table(f.graph);
+        MatchingEngine engine(table);
+        f.db.setMatchingEngine(&engine);
+        while (state.keepRunning()) {
+            doNotOptimize(f.db.findMatchingRides(AREAS[2], "NED Campus", RideType::CARPOOL, "user1", "any", false));
+        }
+        f.db.setMatchingEngine(nullptr);
+    }, SCALES);
+    registerBenchmark("DatabaseManager/findRideMatches", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        while (state.keepRunning()) doNotOptimize(f.db.findRideMatches(AREAS[2], "NED Campus", RideType::CARPOOL, "user1"));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/findRideMatches/matchingEngine", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        OpenRideTable table(f.graph);
+        MatchingEngine engine(table);
+        f.db.setMatchingEngine(&engine);
+        while (state.keepRunning()) doNotOptimize(f.db.findRideMatches(AREAS[2], "NED Campus", RideType::CARPOOL, "user1"));
+        f.db.setMatchingEngine(nullptr);
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getActiveRidesForUser", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(f.db.getActiveRidesForUser("user" + std::to_string(n++ % f.users)));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getUserRides", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) {
+            doNotOptimize(f.db.getUserRides("user" + std::to_string(n++ % f.users), "completed", 0, 20));
+        }
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getPendingRequests", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(f.db.getPendingRequests(static_cast<int>(n++ % f.rides) + 1));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/getAcceptedRequestsForUser", [](BenchState& state) {
+        DbFixture& f = DbFixture::at(static_cast<int>(state.range()));
+        int64_t n = 0;
+        while (state.keepRunning()) doNotOptimize(f.db.getAcceptedRequestsForUser("user" + std::to_string(n++ % f.users)));
+    }, SCALES);
+    registerBenchmark("DatabaseManager/insertRide", [](BenchState& state) {
+        DatabaseManager db(":memory:");
+        db.initialize();
+        while (state.keepRunning()) {
+            Ride ride("user1", AREAS[1], "NED Campus", "now", "offer");
+            doNotOptimize(db.insertRide(ride));
+        }
+    });
+}
+
+// --- Output ---
+static void writeJson(std::ostream& out, const std::vector<Result>& results, const char* executable) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    auto number = [](double v) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6g", v);
+        return std::string(buf);
+    };
+
+    JsonWriter json;
+    json.beginObject();
+    json.key("context").beginObject()
+        .field("date", date)
+        .field("executable", executable)
+        .field("num_cpus", static_cast<int>(std::thread::hardware_concurrency()))
+#ifdef NDEBUG
+        .field("library_build_type", "release")
+#else
+        .field("library_build_type", "debug")
+#endif
+        .endObject();
+    json.key("benchmarks").beginArray();
+    for (const Result& r : results) {
+        json.beginObject()
+            .field("name", r.name)
+            .field("run_type", "iteration")
+            .field("iterations", r.iterations)
+            .key("real_time").raw(number(r.realNanos))
+            .key("cpu_time").raw(number(r.cpuNanos))
+            .field("time_unit", "ns");
+        if (r.itemsPerSecond > 0) json.key("items_per_second").raw(number(r.itemsPerSecond));
+        json.endObject();
+    }
+    json.endArray().endObject();
+    out << json.str() << "\n";
+}
+
+int main(int argc, char** argv) {
+    std::string filter = ".*";
+    std::string format = "console";
+    std::string outPath;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* flag) -> const char* {
+            size_t len = std::strlen(flag);
+            return arg.compare(0, len, flag) == 0 ? argv[i] + len : nullptr;
+        };
+        if (const char* v = value("--benchmark_filter=")) filter = v;
+        else if (const char* v = value("--benchmark_format=")) format = v;
+        else if (const char* v = value("--benchmark_out=")) outPath = v;
+        else if (const char* v = value("--benchmark_min_time=")) minTime = std::atof(v);
+        else {
+            std::cerr << "Unknown flag: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    Logger::setLevel(LogLevel::Warn);
+    registerBenchmarks();
+
+    std::regex pattern(filter);
+    std::vector<Result> results;
+    if (format == "console") {
+        std::printf("%-52s %15s %15s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    }
+    for (const Benchmark& bench : registry()) {
+        std::vector<int64_t> args = bench.args.empty() ? std::vector<int64_t>{0} : bench.args;
+        for (int64_t arg : args) {
+            std::string name = bench.args.empty() ? bench.name : bench.name + "/" + std::to_string(arg);
+            if (!std::regex_search(name, pattern)) continue;
+            Result r = runBenchmark(name, bench.fn, arg, minTime);
+            results.push_back(r);
+            if (format == "console") {
+                std::printf("%-52s %12.0f ns %12.0f ns %12lld\n", name.c_str(), r.realNanos, r.cpuNanos,
+                            static_cast<long long>(r.iterations));
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    if (format == "json") writeJson(std::cout, results, argv[0]);
+    if (!outPath.empty()) {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "Cannot write " << outPath << std::endl;
+            return 1;
+        }
+        writeJson(out, results, argv[0]);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Serialization benchmark: crow::json::wvalue vs JsonWriter for /ride/all
+// Usage: uniride_json_bench [rides=10000] [iterations=50]
+#include "crow.h"
+#include "JsonWriter.h"
+#include "Ride.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::vector<Ride> makeRides(int count) {
+    const char* areas[] = {"NED Campus", "Gulshan-e-Iqbal Block 13", "DHA Phase 5", "Saddar", "North Nazimabad Block H"};
+    std::vector<Ride> rides;
+    rides.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Ride ride("user" + std::to_string(i % 500), areas[i % 5], areas[(i + 2) % 5], "now", "offer",
+                  static_cast<RideType>(i % 3), i % 7 == 0);
+        ride.rideID = i + 1;
+        rides.push_back(ride);
+    }
+    return rides;
+}
+
+static std::string buildWvalue(const std::vector<Ride>& rides) {
+    crow::json::wvalue res;
+    res["rides"] = crow::json::wvalue::list();
+    for (size_t i = 0; i < rides.size(); ++i) {
+        res["rides"][i]["rideID"] = rides[i].rideID;
+        res["rides"][i]["leadUserID"] = rides[i].ownerID;
+        res["rides"][i]["leadUserName"] = "Student " + rides[i].ownerID;
+        res["rides"][i]["from"] = rides[i].from;
+        res["rides"][i]["to"] = rides[i].to;
+        res["rides"][i]["time"] = rides[i].time;
+        res["rides"][i]["rideType"] = rideTypeToString(rides[i].rideType);
+        res["rides"][i]["currentCapacity"] = rides[i].currentCapacity;
+        res["rides"][i]["maxCapacity"] = rides[i].maxCapacity;
+        res["rides"][i]["availableSlots"] = rides[i].getAvailableSlots();
+        res["rides"][i]["femalesOnly"] = rides[i].femalesOnly;
+        res["rides"][i]["status"] = rideStatusToString(rides[i].status);
+    }
+    return res.dump();
+}
+
+static const std::string& buildWriter(JsonWriter& json, const std::vector<Ride>& rides) {
+    json.clear();
+    json.beginObject().key("rides").beginArray();
+    std::string leadName;
+    for (const auto& ride : rides) {
+        leadName = "Student " + ride.ownerID;
+        json.beginObject()
+            .field("rideID", ride.rideID)
+            .field("leadUserID", ride.ownerID)
+            .field("leadUserName", leadName)
+            .field("from", ride.from)
+            .field("to", ride.to)
+            .field("time", ride.time)
+            .field("rideType", rideTypeToString(ride.rideType))
+            .field("currentCapacity", ride.currentCapacity)
+            .field("maxCapacity", ride.maxCapacity)
+            .field("availableSlots", ride.getAvailableSlots())
+            .field("femalesOnly", ride.femalesOnly)
+            .field("status", rideStatusToString(ride.status))
+            .endObject();
+    }
+    json.endArray().endObject();
+    return json.str();
+}
+
+template <typename F>
+static double timeIt(int iterations, size_t& bytes, F&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bytes = fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 10000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 50;
+    auto rides = makeRides(count);
+
+    size_t wvalueBytes = 0, writerBytes = 0;
+    double wvalueMs = timeIt(iterations, wvalueBytes, [&]() { return buildWvalue(rides).size(); });
+
+    JsonWriter json;
+    double writerMs = timeIt(iterations, writerBytes, [&]() { return buildWriter(json, rides).size(); });
+
+    std::cout << "rides: " << count << ", iterations: " << iterations << std::endl;
+    std::cout << "wvalue:     " << wvalueMs << " ms/response, " << wvalueBytes << " bytes" << std::endl;
+    std::cout << "JsonWriter: " << writerMs << " ms/response, " << writerBytes << " bytes" << std::endl;
+    std::cout << "speedup:    " << (writerMs > 0 ? wvalueMs / writerMs : 0) << "x" << std::endl;
+    return 0;
+}
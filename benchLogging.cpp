@@ -0,0 +1,76 @@
+// Logging overhead in findMatchingRides: synchronous stream writes (the old
+// std::cout << std::endl behaviour) against the async logger at DEBUG, INFO
+// and OFF. Log output goes to /dev/null so only the logging path is measured.
+// Usage: uniride_log_bench [rides=5000] [iterations=20] [threads=1]
+#include "DatabaseManager.h"
+#include "Logger.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double runMatching(DatabaseManager& db, int iterations, int threads, size_t& matched) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    std::vector<size_t> counts(threads, 0);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&db, &counts, iterations, t]() {
+            for (int i = 0; i < iterations; ++i) {
+                counts[t] += db.findMatchingRides("Gulshan-e-Iqbal Block 13", "NED Campus",
+                                                  RideType::CARPOOL, "searcher", "any", false).size();
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    matched = 0;
+    for (size_t count : counts) matched += count;
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / (iterations * threads);
+}
+
+int main(int argc, char** argv) {
+    int rides = argc > 1 ? std::stoi(argv[1]) : 5000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 20;
+    int threads = argc > 3 ? std::stoi(argv[3]) : 1;
+
+    std::ofstream devNull("/dev/null");
+    Logger& logger = Logger::instance();
+    logger.setSink(&devNull);
+
+    DatabaseManager db(":memory:");
+    db.initialize();
+    db.insertUser(User("searcher", "Searcher", "searcher@cloud.neduet.edu.pk", "female"));
+    for (int i = 0; i < rides; ++i) {
+        Ride ride("owner" + std::to_string(i % 200), "Gulshan-e-Iqbal Block 13", "NED Campus", "now", "offer",
+                  RideType::CARPOOL, i % 4 == 0);
+        db.insertRide(ride);
+    }
+
+    struct Mode {
+        const char* name;
+        LogLevel level;
+        bool async;
+    };
+    const Mode modes[] = {
+        {"DEBUG, synchronous", LogLevel::Debug, false},
+        {"DEBUG, async", LogLevel::Debug, true},
+        {"INFO", LogLevel::Info, true},
+        {"OFF", LogLevel::Off, true},
+    };
+
+    std::cout << "rides: " << rides << ", iterations: " << iterations << ", threads: " << threads << std::endl;
+    for (const Mode& mode : modes) {
+        Logger::setLevel(mode.level);
+        if (mode.async) logger.start();
+        size_t matched = 0;
+        runMatching(db, 1, threads, matched); // warm up
+        double perCall = runMatching(db, iterations, threads, matched);
+        if (mode.async) logger.stop();
+        std::cout << mode.name << ": " << perCall << " ms per findMatchingRides ("
+                  << matched / (iterations * threads) << " matches)" << std::endl;
+    }
+    std::cout << "records dropped by full rings: " << logger.dropped() << std::endl;
+    return 0;
+}
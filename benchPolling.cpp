@@ -0,0 +1,133 @@
+// Replays the frontend's polling cadence against DatabaseManager and counts
+// SQLite statements with and without ETag revalidation.
+// Usage: uniride_poll_replay [clients=50] [simulated seconds=600] [seed=42]
+#include "DatabaseManager.h"
+#include "JsonWriter.h"
+#include "RideFragmentCache.h"
+#include "VersionRegistry.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Poller {
+    std::string userID;
+    int rideID;          // ride this client leads (polled by Dashboard)
+    std::unordered_map<std::string, std::string> etags; // path -> last ETag seen
+};
+
+// Same DB calls as the handlers in main.cpp
+static void serveRideAll(DatabaseManager& db, RideFragmentCache& cache, JsonWriter& json) {
+    json.clear();
+    json.beginArray();
+    cache.appendRides(json, db);
+    json.endArray();
+}
+
+static void serveRideRequests(DatabaseManager& db, int rideID) {
+    JoinRequestCursor requests = db.scanPendingRequests(rideID);
+    while (requests.next()) {
+    }
+}
+
+static void serveAcceptedPassengers(DatabaseManager& db, int rideID) {
+    JoinRequestCursor passengers = db.scanAcceptedPassengers(rideID);
+    while (passengers.next()) {
+    }
+}
+
+static void serveAcceptedRequests(DatabaseManager& db, const std::string& userID) {
+    for (const auto& accepted : db.getAcceptedRequestsForUser(userID)) {
+        db.getRideByID(accepted.first);
+        db.getUserByID(accepted.second);
+    }
+}
+
+static uint64_t replay(int clients, int seconds, unsigned seed, bool conditional) {
+    DatabaseManager db(":memory:");
+    db.initialize();
+    RideFragmentCache cache;
+    VersionRegistry versions;
+    db.setRideCache(&cache);
+    db.setVersionRegistry(&versions);
+
+    std::vector<Poller> pollers;
+    for (int i = 0; i < clients; ++i) {
+        std::string userID = "student" + std::to_string(i);
+        db.insertUser(User(userID, "Student " + std::to_string(i), userID + "@cloud.neduet.edu.pk"));
+        Ride ride(userID, "Area " + std::to_string(i % 10), "NED Campus", "now", "offer");
+        db.insertRide(ride);
+        pollers.push_back({userID, ride.rideID, {}});
+    }
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pickClient(0, clients - 1);
+    JsonWriter json;
+    uint64_t before = db.queryCount();
+
+    // Run each poll unless the client's ETag is still current
+    auto poll = [&](Poller& p, const std::string& path, const std::string& etag, auto&& serve) {
+        if (conditional) {
+            auto it = p.etags.find(path);
+            if (it != p.etags.end() && it->second == etag) return;
+            p.etags[path] = etag;
+        }
+        serve();
+    };
+
+    for (int t = 0; t < seconds; ++t) {
+        // Roughly one mutation every two seconds: join, approve or a new ride
+        if (rng() % 2 == 0) {
+            Poller& lead = pollers[pickClient(rng)];
+            Poller& rider = pollers[pickClient(rng)];
+            switch (rng() % 3) {
+                case 0: db.insertJoinRequest(lead.rideID, rider.userID); break;
+                case 1: db.updateJoinRequestStatus(lead.rideID, rider.userID, "accepted"); break;
+                default: {
+                    Ride ride(rider.userID, "Area " + std::to_string(t % 10), "NED Campus", "now", "request");
+                    db.insertRide(ride);
+                }
+            }
+        }
+
+        for (int i = 0; i < clients; ++i) {
+            Poller& p = pollers[i];
+            int phase = (t + i) % 70; // spread clients across the cadence
+            if (phase % 5 == 0) { // Rides.tsx, ChatPage status refresh
+                poll(p, "/ride/all", versions.etag("rides", versions.rideSetVersion(), true),
+                     [&]() { serveRideAll(db, cache, json); });
+                poll(p, "/user/accepted-requests", versions.etag("user", versions.userVersion(p.userID), true),
+                     [&]() { serveAcceptedRequests(db, p.userID); });
+            }
+            if (phase % 10 == 0) { // RideHistory.tsx, Dashboard.tsx
+                poll(p, "/ride/all#history", versions.etag("rides", versions.rideSetVersion(), true),
+                     [&]() { serveRideAll(db, cache, json); });
+            }
+            if (phase % 7 == 0) { // Dashboard.tsx per owned ride
+                std::string rideTag = versions.etag("ride", versions.rideVersion(p.rideID), true);
+                poll(p, "/ride/requests", rideTag, [&]() { serveRideRequests(db, p.rideID); });
+                poll(p, "/ride/accepted", rideTag, [&]() { serveAcceptedPassengers(db, p.rideID); });
+            }
+        }
+    }
+
+    return db.queryCount() - before;
+}
+
+int main(int argc, char** argv) {
+    int clients = argc > 1 ? std::stoi(argv[1]) : 50;
+    int seconds = argc > 2 ? std::stoi(argv[2]) : 600;
+    unsigned seed = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 42;
+
+    uint64_t unconditional = replay(clients, seconds, seed, false);
+    uint64_t conditional = replay(clients, seconds, seed, true);
+
+    std::cout << "clients: " << clients << ", simulated seconds: " << seconds << std::endl;
+    std::cout << "SQLite statements without ETags: " << unconditional << std::endl;
+    std::cout << "SQLite statements with ETags:    " << conditional << std::endl;
+    if (unconditional > 0) {
+        std::cout << "reduction: " << 100.0 * (1.0 - double(conditional) / double(unconditional)) << "%" << std::endl;
+    }
+    return 0;
+}
@@ -45,12 +45,31 @@ export const userAPI = {
   async getAcceptedRequests(userID: string) {
     return api.get(`/user/${userID}/accepted-requests`)
   },
+  // Rides the user owned or joined, newest first; pass nextCursor back as cursor
+  async getRides(userID: string, params: { status?: string; cursor?: number; limit?: number } = {}) {
+    return api.get(`/user/${userID}/rides`, { params })
+  },
 }
 
 export const rideAPI = {
   async getAll() {
     return api.get('/ride/all')
   },
+  // Filtered listing: one keyset page per call, pass nextCursor back as cursor
+  async list(params: { owner?: string; participant?: string; status?: string; type?: string; from?: string; cursor?: number; limit?: number }) {
+    return api.get('/ride/all', { params })
+  },
+  // Follow nextCursor until every matching ride has been fetched
+  async listAll(params: { owner?: string; participant?: string; status?: string; type?: string; from?: string; limit?: number }) {
+    const rides: any[] = []
+    let cursor: number | undefined = undefined
+    do {
+      const res: any = await rideAPI.list({ ...params, cursor })
+      rides.push(...(res.data.rides || []))
+      cursor = res.data.nextCursor ?? undefined
+    } while (cursor !== undefined)
+    return rides
+  },
   async offer(payload: any) {
     return api.post('/ride/offer', payload)
   },
@@ -132,7 +132,7 @@ export default function ChatPage() {
       setError('Loading ride information...')
       return
     }
-    if (rideStatus === 'completed') {
+    if (rideStatus === 'completed' || rideStatus === 'expired') {
       setError('Cannot send messages for a completed ride')
       return
     }
@@ -167,7 +167,7 @@ export default function ChatPage() {
     return <div style={{ padding: '20px', color: '#dc2626' }}>Please sign in to use chat.</div>
   }
 
-  const isCompleted = rideStatus === 'completed'
+  const isCompleted = rideStatus === 'completed' || rideStatus === 'expired'
   const participantsList = Object.entries(userNames).filter(([id]) => id !== rideLeadID && id !== '')
 
   return (
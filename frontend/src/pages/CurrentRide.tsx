@@ -117,8 +117,8 @@ export default function CurrentRide({ onRideEnded }: CurrentRideProps) {
     }
   }
 
-  const activeRides = myRides.filter(r => r.status !== 'completed')
-  const activePassengerRides = passengerRides.filter(r => r.status !== 'completed')
+  const activeRides = myRides.filter(r => r.status !== 'completed' && r.status !== 'expired')
+  const activePassengerRides = passengerRides.filter(r => r.status !== 'completed' && r.status !== 'expired')
 
   return (
     <div style={{ margin: '0 auto', padding: '10px', maxWidth: '800px' }}>
@@ -110,7 +110,7 @@ export default function Dashboard() {
         const hasPendingRequests = (pendingRequests[ride.rideID] || []).length > 0
         const rideStatus = ride.status || 'open'
         const isStarted = rideStatus === 'started'
-        const isCompleted = rideStatus === 'completed'
+        const isCompleted = rideStatus === 'completed' || rideStatus === 'expired'
         const canStart = !isStarted && !isCompleted
         const canEnd = isStarted && !isCompleted
         const showChat = (hasAccepted || hasPendingRequests || isStarted) && !isCompleted
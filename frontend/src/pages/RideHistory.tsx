@@ -1,24 +1,49 @@
-import React, { useEffect, useState } from 'react'
+import React, { useEffect, useRef, useState } from 'react'
 import { useAuth } from '../context/AuthContext'
-import { rideAPI } from '../api/client'
+import { userAPI } from '../api/client'
 
 export default function RideHistory() {
   const { user } = useAuth()
   const [myRides, setMyRides] = useState<any[]>([])
+  const [nextCursor, setNextCursor] = useState<number | undefined>(undefined)
   const [loading, setLoading] = useState(false)
+  const [loadingMore, setLoadingMore] = useState(false)
+  const olderLoaded = useRef(false)
 
+  // Polls fetch only the newest page; older pages stay as loaded
   const refreshMyRides = async () => {
     if (!user) return
     setLoading(true)
     try {
-      const res = await rideAPI.getAll()
-      const owned = res.data.rides?.filter((r: any) => r.leadUserID === user.id) || []
-      setMyRides(owned)
+      const res: any = await userAPI.getRides(String(user.id), { status: 'completed' })
+      const firstPage: any[] = res.data.rides || []
+      const firstCursor: number | undefined = res.data.nextCursor ?? undefined
+      if (!olderLoaded.current || firstCursor === undefined) {
+        olderLoaded.current = false
+        setMyRides(firstPage)
+        setNextCursor(firstCursor)
+      } else {
+        setMyRides(prev => [...firstPage, ...prev.filter(r => r.rideID < firstCursor)])
+      }
     } finally {
       setLoading(false)
     }
   }
 
+  const loadMore = async () => {
+    if (!user || nextCursor === undefined) return
+    setLoadingMore(true)
+    try {
+      const res: any = await userAPI.getRides(String(user.id), { status: 'completed', cursor: nextCursor })
+      const page: any[] = res.data.rides || []
+      olderLoaded.current = true
+      setMyRides(prev => [...prev.filter(r => r.rideID >= nextCursor), ...page])
+      setNextCursor(res.data.nextCursor ?? undefined)
+    } finally {
+      setLoadingMore(false)
+    }
+  }
+
   useEffect(() => {
     if (!user) return
     refreshMyRides()
@@ -45,6 +70,17 @@ export default function RideHistory() {
           </div>
         )
       }) : <div style={{ textAlign: 'center', padding: '2rem', color: '#6b7280', fontSize: '1rem' }}>{loading ? 'Loading your rides…' : 'No completed rides yet.'}</div>}
+      {nextCursor !== undefined && (
+        <div style={{ textAlign: 'center', marginTop: '1rem' }}>
+          <button
+            onClick={loadMore}
+            disabled={loadingMore}
+            style={{ padding: '10px 20px', border: 'none', borderRadius: '12px', fontWeight: '500', cursor: 'pointer', fontSize: '14px', backgroundColor: '#e07d2e', color: 'white' }}
+          >
+            {loadingMore ? 'Loading…' : 'Load more'}
+          </button>
+        </div>
+      )}
     </div>
   )
 }
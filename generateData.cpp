@@ -0,0 +1,554 @@
+// Deterministic synthetic dataset generator.
+//
+// Writes a complete rideshare.db (users, students, rides, join_requests,
+// messages, ride_participation) and a matching areas.db edge list from a
+// single seed, so performance runs at campus or city scale are repeatable:
+//
+//   uniride_datagen --scale 100k --seed 42
+//   uniride_datagen --rides 250000 --db big.db --areas big_areas.db --force
+//
+// The schema comes from DatabaseManager::initialize(), so generated files
+// are exactly what the server opens. Rows are bulk loaded inside one
+// transaction through prepared statements with journaling turned off.
+#include "DatabaseManager.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* CAMPUS = "NED Campus";
+const double CAMPUS_LAT = 24.9330;
+const double CAMPUS_LON = 67.1110;
+const double MAX_EDGE_KM = 4.0; // same threshold as buildGraph
+
+// Rows are stamped relative to a fixed date, not "now", so two runs with
+// the same seed produce byte-identical databases
+const std::time_t EPOCH = 1725148800; // 2024-09-01 00:00:00 UTC
+const int HISTORY_DAYS = 180;
+
+struct Options {
+    long rides = 10000;
+    unsigned seed = 42;
+    double femaleShare = 0.4;
+    double campusShare = 0.85; // rides with NED Campus at one end
+    std::string dbPath = "rideshare.db";
+    std::string areasPath = "areas.db";
+    std::string locationsPath = "locations.csv";
+    bool force = false;
+};
+
+struct Location {
+    std::string name;
+    double lat;
+    double lon;
+};
+
+struct Student {
+    std::string userID;
+    bool female;
+};
+
+const char* FIRST_MALE[] = {"Ahmed", "Ali", "Bilal", "Danish", "Faisal", "Hamza", "Hassan", "Imran", "Junaid",
+                            "Kamran", "Omar", "Saad", "Taha", "Usman", "Zain"};
+const char* FIRST_FEMALE[] = {"Aiza", "Ayesha", "Fatima", "Hira", "Iqra", "Khadija", "Maham", "Maryam", "Noor",
+                              "Sana", "Sara", "Zainab", "Zoha", "Anum", "Mahnoor"};
+const char* LAST[] = {"Khan", "Siddiqui", "Soomro", "Rafique", "Zaman", "Rashid", "Abrar", "Zafar", "Qureshi",
+                      "Memon", "Shaikh", "Baig", "Ansari", "Hussain", "Malik", "Raza"};
+const char* CHAT_LINES[] = {"Assalam o alaikum, I'll be at the gate in 5", "Where should we meet?",
+                            "Running a bit late, sorry", "I'm wearing a blue shirt", "Reached the pickup point",
+                            "Can we leave at 8:15 instead?", "Thanks for the ride!", "Which gate, main or staff?",
+                            "On my way", "Please wait 2 minutes"};
+
+template <size_t N>
+const char* pick(const char* (&items)[N], std::mt19937& rng) {
+    return items[std::uniform_int_distribution<size_t>(0, N - 1)(rng)];
+}
+
+double haversine(double lat1, double lon1, double lat2, double lon2) {
+    const double R = 6371.0; // Earth radius in km
+    double dLat = (lat2 - lat1) * M_PI / 180.0;
+    double dLon = (lon2 - lon1) * M_PI / 180.0;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) * sin(dLon / 2) * sin(dLon / 2);
+    return R * 2 * atan2(sqrt(a), sqrt(1 - a));
+}
+
+std::string formatTime(std::time_t t) {
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &t);
+#else
+    gmtime_r(&t, &utc);
+#endif
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &utc);
+    return buf;
+}
+
+bool exec(sqlite3* db, const char* sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "SQL error: " << (errMsg ? errMsg : "unknown") << " in: " << sql << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+// Binds text by pointer; every string passed here outlives the step
+void bindText(sqlite3_stmt* stmt, int index, const std::string& value) {
+    sqlite3_bind_text(stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_STATIC);
+}
+
+bool stepAndReset(sqlite3* db, sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "Insert failed: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseScale(const std::string& text, long& out) {
+    if (text == "10k") out = 10000;
+    else if (text == "100k") out = 100000;
+    else if (text == "1m" || text == "1M") out = 1000000;
+    else return false;
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        try {
+            if (arg == "--scale") {
+                if (!value(v) || !parseScale(v, opt.rides)) return false;
+            } else if (arg == "--rides") {
+                if (!value(v)) return false;
+                opt.rides = std::stol(v);
+            } else if (arg == "--seed") {
+                if (!value(v)) return false;
+                opt.seed = static_cast<unsigned>(std::stoul(v));
+            } else if (arg == "--female-share") {
+                if (!value(v)) return false;
+                opt.femaleShare = std::stod(v);
+            } else if (arg == "--campus-share") {
+                if (!value(v)) return false;
+                opt.campusShare = std::stod(v);
+            } else if (arg == "--db") {
+                if (!value(opt.dbPath)) return false;
+            } else if (arg == "--areas") {
+                if (!value(opt.areasPath)) return false;
+            } else if (arg == "--locations") {
+                if (!value(opt.locationsPath)) return false;
+            } else if (arg == "--force") {
+                opt.force = true;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return opt.rides > 0;
+}
+
+bool loadLocations(const std::string& path, std::vector<Location>& out) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(file, line); // header
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        std::stringstream ss(line);
+        std::string name, latStr, lonStr;
+        if (std::getline(ss, name, ',') && std::getline(ss, latStr, ',') && std::getline(ss, lonStr)) {
+            try {
+                out.push_back({name, std::stod(latStr), std::stod(lonStr)});
+            } catch (const std::exception&) {
+                std::cerr << "Skipping bad line: " << line << std::endl;
+            }
+        }
+    }
+    // The campus is the destination most rides share; buildGraph leaves it
+    // out of locations.csv, so add it here
+    if (std::none_of(out.begin(), out.end(), [](const Location& l) { return l.name == CAMPUS; })) {
+        out.push_back({CAMPUS, CAMPUS_LAT, CAMPUS_LON});
+    }
+    return !out.empty();
+}
+
+bool prepareOutput(const std::string& path, bool force) {
+    std::ifstream existing(path);
+    if (!existing.good()) return true;
+    if (!force) {
+        std::cerr << path << " already exists; pass --force to overwrite it" << std::endl;
+        return false;
+    }
+    existing.close();
+    if (std::remove(path.c_str()) != 0) {
+        std::cerr << "Cannot remove " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --- areas.db: same edge rule as buildGraph, campus included ---
+long writeAreas(const Options& opt, const std::vector<Location>& locations) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open(opt.areasPath.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Cannot open " << opt.areasPath << std::endl;
+        sqlite3_close(db);
+        return -1;
+    }
+    long count = 0;
+    sqlite3_stmt* stmt = nullptr;
+    bool ok = exec(db, "CREATE TABLE IF NOT EXISTS edges (id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                       "area1 TEXT NOT NULL, area2 TEXT NOT NULL, distance_km REAL NOT NULL);") &&
+              exec(db, "BEGIN;") &&
+              sqlite3_prepare_v2(db, "INSERT INTO edges (area1, area2, distance_km) VALUES (?, ?, ?);", -1, &stmt,
+                                 nullptr) == SQLITE_OK;
+    for (size_t i = 0; ok && i < locations.size(); ++i) {
+        for (size_t j = i + 1; ok && j < locations.size(); ++j) {
+            double dist = haversine(locations[i].lat, locations[i].lon, locations[j].lat, locations[j].lon);
+            if (dist > MAX_EDGE_KM) continue;
+            bindText(stmt, 1, locations[i].name);
+            bindText(stmt, 2, locations[j].name);
+            sqlite3_bind_double(stmt, 3, dist);
+            ok = stepAndReset(db, stmt);
+            ++count;
+        }
+    }
+    sqlite3_finalize(stmt);
+    ok = ok && exec(db, "COMMIT;");
+    sqlite3_close(db);
+    return ok ? count : -1;
+}
+
+// Rank-weighted popularity so a few neighbourhoods dominate, as in real demand
+std::discrete_distribution<size_t> areaPopularity(size_t areaCount, std::mt19937& rng) {
+    std::vector<size_t> rank(areaCount);
+    for (size_t i = 0; i < areaCount; ++i) rank[i] = i;
+    std::shuffle(rank.begin(), rank.end(), rng);
+    std::vector<double> weights(areaCount);
+    for (size_t i = 0; i < areaCount; ++i) weights[i] = 1.0 / (1.0 + rank[i]);
+    return std::discrete_distribution<size_t>(weights.begin(), weights.end());
+}
+
+// Maintaining the idx_* indexes row by row dominates a large load; they are
+// recreated by initialize() once the data is in
+bool dropSecondaryIndexes(sqlite3* db) {
+    std::vector<std::string> names;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT name FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx\\_%' ESCAPE '\\';",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        names.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)));
+    }
+    sqlite3_finalize(stmt);
+    for (const auto& name : names) {
+        if (!exec(db, ("DROP INDEX " + name + ";").c_str())) return false;
+    }
+    return true;
+}
+
+struct Counts {
+    long users = 0;
+    long rides = 0;
+    long joinRequests[3] = {0, 0, 0}; // pending, accepted, rejected
+    long messages = 0;
+    long participation = 0;
+};
+
+bool writeRideshare(const Options& opt, const std::vector<Location>& locations, Counts& counts) {
+    // Create the schema (and the demo students) exactly as the server does
+    {
+        DatabaseManager schema(opt.dbPath);
+        if (!schema.initialize()) return false;
+    }
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(opt.dbPath.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Cannot open " << opt.dbPath << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    bool ok = exec(db, "PRAGMA journal_mode = OFF;") && exec(db, "PRAGMA synchronous = OFF;") &&
+              exec(db, "PRAGMA cache_size = -262144;") && dropSecondaryIndexes(db) && exec(db, "BEGIN;");
+
+    sqlite3_stmt* insertUser = nullptr;
+    sqlite3_stmt* insertStudent = nullptr;
+    sqlite3_stmt* insertRide = nullptr;
+    sqlite3_stmt* insertJoin = nullptr;
+    sqlite3_stmt* insertMessage = nullptr;
+    const char* sql[] = {
+        "INSERT INTO users (userID, name, email, gender, gender_preference, vehicle_preference, has_active_request) "
+        "VALUES (?, ?, ?, ?, ?, ?, 0);",
+        "INSERT INTO students (enrollment_id, email_pattern, gender) VALUES (?, ?, ?);",
+        "INSERT INTO rides (id, owner_id, from_location, to_location, time, mode, ride_type, ride_status, "
+        "current_capacity, max_capacity, females_only, gender_preference, created_at) "
+        "VALUES (?, ?, ?, ?, 'flexible', ?, ?, ?, ?, ?, ?, ?, ?);",
+        "INSERT INTO join_requests (ride_id, user_id, status, created_at) VALUES (?, ?, ?, ?);",
+        "INSERT INTO messages (sender_id, message_text, timestamp) VALUES (?, ?, ?);"};
+    sqlite3_stmt** stmts[] = {&insertUser, &insertStudent, &insertRide, &insertJoin, &insertMessage};
+    for (int i = 0; ok && i < 5; ++i) {
+        if (sqlite3_prepare_v2(db, sql[i], -1, stmts[i], nullptr) != SQLITE_OK) {
+            std::cerr << "SQL prepare error: " << sqlite3_errmsg(db) << std::endl;
+            ok = false;
+        }
+    }
+
+    std::mt19937 rng(opt.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // --- Users and the matching students roster ---
+    // Four rides per student over the history window; every live ride gets
+    // a distinct owner because the app allows one active ride per user
+    long userCount = std::max(500L, opt.rides / 4);
+    std::vector<Student> students;
+    std::vector<size_t> femaleIndex;
+    students.reserve(userCount);
+    for (long i = 0; ok && i < userCount; ++i) {
+        bool female = unit(rng) < opt.femaleShare;
+        const char* first = female ? pick(FIRST_FEMALE, rng) : pick(FIRST_MALE, rng);
+        const char* last = pick(LAST, rng);
+        char id[32], enrollment[32];
+        std::snprintf(id, sizeof(id), "1%020ld", i);                        // Google "sub"-shaped
+        std::snprintf(enrollment, sizeof(enrollment), "NED/%05ld/%ld", i / 4, 2021 + i % 4);
+        std::string userID = id;
+        std::string name = std::string(first) + " " + last;
+        std::string email = last + std::to_string(4800000 + i) + "@cloud.neduet.edu.pk";
+        for (char& c : email) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        std::string gender = female ? "female" : "male";
+        std::string preference = female && unit(rng) < 0.5 ? "female" : "any";
+        std::string enrollmentID = enrollment;
+
+        bindText(insertUser, 1, userID);
+        bindText(insertUser, 2, name);
+        bindText(insertUser, 3, email);
+        bindText(insertUser, 4, gender);
+        bindText(insertUser, 5, preference);
+        sqlite3_bind_int(insertUser, 6, std::uniform_int_distribution<int>(1, 3)(rng));
+        ok = stepAndReset(db, insertUser);
+
+        bindText(insertStudent, 1, enrollmentID);
+        bindText(insertStudent, 2, email);
+        bindText(insertStudent, 3, gender);
+        ok = ok && stepAndReset(db, insertStudent);
+
+        if (female) femaleIndex.push_back(students.size());
+        students.push_back({userID, female});
+        ++counts.users;
+    }
+
+    // --- Rides, join requests and chat ---
+    size_t campusIndex = 0;
+    while (locations[campusIndex].name != CAMPUS) ++campusIndex;
+    auto popularity = areaPopularity(locations.size(), rng);
+    auto otherArea = [&]() {
+        size_t area;
+        do area = popularity(rng); while (area == campusIndex);
+        return area;
+    };
+
+    // Shuffled owner order; the first liveCount rides are the live ones
+    std::vector<size_t> ownerOrder(students.size());
+    for (size_t i = 0; i < ownerOrder.size(); ++i) ownerOrder[i] = i;
+    std::shuffle(ownerOrder.begin(), ownerOrder.end(), rng);
+
+    std::discrete_distribution<int> typeDist({30, 50, 20});             // bike, carpool, rickshaw
+    std::discrete_distribution<int> liveStatusDist({70, 15, 15});       // open, full, started
+    const double liveShare = 0.2;
+    std::vector<size_t> chosen;
+    std::string status, createdAt, joinAt, sentAt, mode, fromArea, toArea;
+
+    for (long r = 0; ok && r < opt.rides; ++r) {
+        bool live = r < static_cast<long>(opt.rides * liveShare) && r < static_cast<long>(students.size());
+        size_t ownerIdx = live ? ownerOrder[r] : std::uniform_int_distribution<size_t>(0, students.size() - 1)(rng);
+        const Student& owner = students[ownerIdx];
+
+        int type = typeDist(rng);
+        int maxCapacity = type == 0 ? 2 : type == 1 ? 4 : 3; // matches Ride's constructor
+        mode = type == 0 ? "bike" : type == 1 ? "car" : "rickshaw";
+        bool femalesOnly = owner.female && !femaleIndex.empty() && unit(rng) < 0.3;
+        static const char* LIVE_STATUS[] = {"open", "full", "started"};
+        status = live ? LIVE_STATUS[liveStatusDist(rng)] : "completed";
+
+        // Mornings head to campus, afternoons head home
+        int day = std::uniform_int_distribution<int>(0, HISTORY_DAYS - 1)(rng);
+        bool toCampus = unit(rng) < 0.6;
+        int hour = toCampus ? std::uniform_int_distribution<int>(7, 10)(rng)
+                            : std::uniform_int_distribution<int>(12, 18)(rng);
+        std::time_t created = EPOCH + day * 86400L + hour * 3600L + std::uniform_int_distribution<int>(0, 3599)(rng);
+        if (live) created = EPOCH + HISTORY_DAYS * 86400L + hour * 3600L; // today
+        createdAt = formatTime(created);
+
+        size_t from, to;
+        if (unit(rng) < opt.campusShare) {
+            size_t area = otherArea();
+            from = toCampus ? area : campusIndex;
+            to = toCampus ? campusIndex : area;
+        } else {
+            from = otherArea();
+            do to = otherArea(); while (to == from);
+        }
+        fromArea = locations[from].name;
+        toArea = locations[to].name;
+
+        // Accepted passengers decide the capacity; "full" means no free seat
+        int accepted = status == "full" ? maxCapacity - 1
+                     : status == "open" ? std::uniform_int_distribution<int>(0, maxCapacity - 2)(rng)
+                                        : std::uniform_int_distribution<int>(0, maxCapacity - 1)(rng);
+        int pending = status == "open" ? std::uniform_int_distribution<int>(0, 3)(rng) : 0;
+        int rejected = std::uniform_int_distribution<int>(0, 2)(rng) == 0 ? 1 : 0;
+
+        long rideID = r + 1;
+        sqlite3_bind_int64(insertRide, 1, rideID);
+        bindText(insertRide, 2, owner.userID);
+        bindText(insertRide, 3, fromArea);
+        bindText(insertRide, 4, toArea);
+        bindText(insertRide, 5, mode);
+        sqlite3_bind_int(insertRide, 6, type);
+        bindText(insertRide, 7, status);
+        sqlite3_bind_int(insertRide, 8, 1 + accepted);
+        sqlite3_bind_int(insertRide, 9, maxCapacity);
+        sqlite3_bind_int(insertRide, 10, femalesOnly ? 1 : 0);
+        sqlite3_bind_text(insertRide, 11, femalesOnly ? "female" : "any", -1, SQLITE_STATIC);
+        bindText(insertRide, 12, createdAt);
+        ok = stepAndReset(db, insertRide);
+        ++counts.rides;
+
+        // Distinct requesters other than the owner, female-only where required
+        chosen.clear();
+        int wanted = accepted + pending + rejected;
+        for (int attempts = 0; static_cast<int>(chosen.size()) < wanted && attempts < wanted * 8; ++attempts) {
+            size_t idx = femalesOnly
+                ? femaleIndex[std::uniform_int_distribution<size_t>(0, femaleIndex.size() - 1)(rng)]
+                : std::uniform_int_distribution<size_t>(0, students.size() - 1)(rng);
+            if (idx == ownerIdx || std::find(chosen.begin(), chosen.end(), idx) != chosen.end()) continue;
+            chosen.push_back(idx);
+        }
+        for (size_t k = 0; ok && k < chosen.size(); ++k) {
+            int kind = static_cast<int>(k) < accepted ? 1 : static_cast<int>(k) < accepted + pending ? 0 : 2;
+            static const char* JOIN_STATUS[] = {"pending", "accepted", "rejected"};
+            joinAt = formatTime(created + 60 * static_cast<long>(k + 1));
+            sqlite3_bind_int64(insertJoin, 1, rideID);
+            bindText(insertJoin, 2, students[chosen[k]].userID);
+            sqlite3_bind_text(insertJoin, 3, JOIN_STATUS[kind], -1, SQLITE_STATIC);
+            bindText(insertJoin, 4, joinAt);
+            ok = stepAndReset(db, insertJoin);
+            ++counts.joinRequests[kind];
+        }
+
+        // Chat only happens between the lead and accepted passengers
+        if (accepted > 0) {
+            int lines = std::uniform_int_distribution<int>(1, 6)(rng);
+            for (int m = 0; ok && m < lines; ++m) {
+                size_t sender = m % 2 == 0 ? ownerIdx : chosen[std::uniform_int_distribution<int>(0, accepted - 1)(rng)];
+                sentAt = formatTime(created + 600 + 45 * m);
+                bindText(insertMessage, 1, students[sender].userID);
+                sqlite3_bind_text(insertMessage, 2, pick(CHAT_LINES, rng), -1, SQLITE_STATIC);
+                bindText(insertMessage, 3, sentAt);
+                ok = stepAndReset(db, insertMessage);
+                ++counts.messages;
+            }
+        }
+    }
+
+    for (auto stmt : stmts) sqlite3_finalize(*stmt);
+
+    // Same rows DatabaseManager::initialize() backfills, inserted in key
+    // order so the WITHOUT ROWID table is appended rather than split
+    ok = ok && exec(db, R"(
+        INSERT INTO ride_participation (user_id, ride_id, role, ride_status)
+            SELECT user_id, ride_id, role, ride_status FROM (
+                SELECT owner_id AS user_id, id AS ride_id, 'owner' AS role, ride_status FROM rides
+                UNION ALL
+                SELECT jr.user_id, jr.ride_id, 'passenger', r.ride_status
+                FROM join_requests jr JOIN rides r ON r.id = jr.ride_id
+                WHERE jr.status = 'accepted')
+            ORDER BY user_id, ride_id;
+    )");
+    ok = ok && exec(db, "COMMIT;");
+    sqlite3_close(db);
+    if (!ok) return false;
+
+    // Second initialize() rebuilds the secondary indexes, one sorted pass each
+    {
+        DatabaseManager schema(opt.dbPath);
+        if (!schema.initialize()) return false;
+    }
+
+    if (sqlite3_open(opt.dbPath.c_str(), &db) != SQLITE_OK) {
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    ok = exec(db, "ANALYZE;") &&
+         sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM ride_participation;", -1, &stmt, nullptr) == SQLITE_OK &&
+         sqlite3_step(stmt) == SQLITE_ROW;
+    if (ok) counts.participation = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " [--scale 10k|100k|1m | --rides N] [--seed N] [--female-share F]\n"
+                  << "       [--campus-share F] [--db rideshare.db] [--areas areas.db] [--locations locations.csv]"
+                  << " [--force]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Location> locations;
+    if (!loadLocations(opt.locationsPath, locations)) return 1;
+    if (!prepareOutput(opt.dbPath, opt.force) || !prepareOutput(opt.areasPath, opt.force)) return 1;
+
+    auto start = std::chrono::steady_clock::now();
+    long edges = writeAreas(opt, locations);
+    if (edges < 0) return 1;
+
+    Counts counts;
+    if (!writeRideshare(opt, locations, counts)) return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "seed " << opt.seed << ", " << locations.size() << " areas, " << edges << " edges -> "
+              << opt.areasPath << "\n"
+              << "users/students:     " << counts.users << "\n"
+              << "rides:              " << counts.rides << "\n"
+              << "join_requests:      " << counts.joinRequests[0] << " pending, " << counts.joinRequests[1]
+              << " accepted, " << counts.joinRequests[2] << " rejected\n"
+              << "messages:           " << counts.messages << "\n"
+              << "ride_participation: " << counts.participation << "\n"
+              << "written to " << opt.dbPath << " in " << seconds << " s" << std::endl;
+    return 0;
+}
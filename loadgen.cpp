@@ -0,0 +1,504 @@
+// HTTP load generator: N simulated students replaying UniRide sessions
+// against a running server at a target request rate.
+//
+// Usage: uniride_loadgen <scenario.conf>
+//
+// The scenario file (see loadgen_peak_hour.conf) sets the server URL, the
+// student count, the target RPS, the duration and the weight of each action
+// in the mix. Login goes through POST /auth/google/verify. Pointing the server
+// at the built-in tokeninfo stub avoids real Google tokens:
+//
+//   uniride_loadgen scenario.conf          (starts the stub on auth_stub_port
+//                                           and seeds students into seed_db)
+//   UNIRIDE_DB=loadgen.db UNIRIDE_TOKENINFO_URL=http://127.0.0.1:18081/tokeninfo ./UniRide
+//
+// seed_db should be a scratch database (the server's UNIRIDE_DB), never the
+// real rideshare.db. The server accepts only loopback tokeninfo URLs.
+//
+// Requests run on an open-loop schedule, and latency is measured from each
+// request's scheduled start. A server that falls behind therefore shows up
+// in the percentiles instead of silently lowering the offered load.
+#include <curl/curl.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+// --- Scenario config: "key = value" lines, '#' comments ---
+struct Scenario {
+    std::string baseURL = "http://127.0.0.1:8080";
+    int students = 20;
+    double rps = 50;
+    int durationSeconds = 30;
+    int authStubPort = 0;    // 0 = no stub
+    std::string seedDB;      // server database to register loadgen students in
+    unsigned seed = 42;
+    std::vector<std::pair<std::string, double>> mix; // action -> weight
+};
+
+static bool loadScenario(const std::string& path, Scenario& out) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open scenario file: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        auto trim = [](std::string s) {
+            s.erase(0, s.find_first_not_of(" \t\r"));
+            s.erase(s.find_last_not_of(" \t\r") + 1);
+            return s;
+        };
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+        try {
+            if (key == "base_url") out.baseURL = value;
+            else if (key == "students") out.students = std::stoi(value);
+            else if (key == "rps") out.rps = std::stod(value);
+            else if (key == "duration_s") out.durationSeconds = std::stoi(value);
+            else if (key == "auth_stub_port") out.authStubPort = std::stoi(value);
+            else if (key == "seed_db") out.seedDB = value;
+            else if (key == "seed") out.seed = static_cast<unsigned>(std::stoul(value));
+            else if (key.rfind("mix.", 0) == 0) out.mix.push_back({key.substr(4), std::stod(value)});
+            else std::cerr << path << ":" << lineNumber << ": unknown key '" << key << "'" << std::endl;
+        } catch (const std::exception&) {
+            std::cerr << path << ":" << lineNumber << ": bad value for '" << key << "'" << std::endl;
+            return false;
+        }
+    }
+    if (out.mix.empty() || out.students <= 0 || out.rps <= 0) {
+        std::cerr << "Scenario needs students > 0, rps > 0 and at least one mix.<action> weight" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static std::string studentEmail(int n) { return "loadgen" + std::to_string(n) + "@cloud.neduet.edu.pk"; }
+static std::string studentEnrollment(int n) { return "LG/" + std::to_string(n); }
+
+// --- Register loadgen students so enrollment checks pass ---
+static bool seedStudents(const std::string& dbPath, int count) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Cannot open " << dbPath << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+    sqlite3_exec(db, "CREATE TABLE IF NOT EXISTS students (enrollment_id TEXT PRIMARY KEY, email_pattern TEXT, gender TEXT);",
+                 0, 0, nullptr);
+    sqlite3_exec(db, "BEGIN;", 0, 0, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO students VALUES (?, ?, ?);", -1, &stmt, nullptr);
+    for (int i = 0; i < count; ++i) {
+        std::string enrollment = studentEnrollment(i);
+        std::string email = studentEmail(i);
+        sqlite3_bind_text(stmt, 1, enrollment.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, email.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, i % 2 ? "female" : "male", -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    bool ok = sqlite3_exec(db, "COMMIT;", 0, 0, nullptr) == SQLITE_OK;
+    sqlite3_close(db);
+    return ok;
+}
+
+// --- Minimal tokeninfo stub: id_token "loadgen-<n>" -> student n ---
+#ifndef _WIN32
+static void runAuthStub(int port, std::atomic<bool>& stop) {
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(server, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(server, 64) != 0) {
+        std::cerr << "Auth stub cannot listen on port " << port << std::endl;
+        close(server);
+        return;
+    }
+
+    while (!stop.load()) {
+        pollfd pfd{server, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) continue;
+
+        char buf[4096];
+        ssize_t n = recv(client, buf, sizeof(buf) - 1, 0);
+        std::string request(buf, n > 0 ? static_cast<size_t>(n) : 0);
+        std::string body = "{\"error\":\"invalid_token\"}";
+        int status = 400;
+        size_t tokenPos = request.find("id_token=loadgen-");
+        if (tokenPos != std::string::npos) {
+            int student = std::atoi(request.c_str() + tokenPos + std::strlen("id_token=loadgen-"));
+            body = "{\"email\":\"" + studentEmail(student) + "\",\"name\":\"Load Student " + std::to_string(student) +
+                   "\",\"sub\":\"loadgen-" + std::to_string(student) + "\"}";
+            status = 200;
+        }
+        std::string response = "HTTP/1.1 " + std::to_string(status) + (status == 200 ? " OK" : " Bad Request") +
+                               "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+                               "\r\nConnection: close\r\n\r\n" + body;
+        send(client, response.data(), response.size(), 0);
+        close(client);
+    }
+    close(server);
+}
+#endif
+
+// --- HTTP client ---
+struct Response {
+    long status = 0; // 0 = transport error
+    std::string body;
+    std::string etag;
+};
+
+static size_t collectBody(char* data, size_t size, size_t count, void* out) {
+    static_cast<std::string*>(out)->append(data, size * count);
+    return size * count;
+}
+
+static size_t collectETag(char* data, size_t size, size_t count, void* out) {
+    std::string header(data, size * count);
+    std::string name = header.substr(0, 5);
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (name == "etag:") {
+        std::string value = header.substr(5);
+        value.erase(0, value.find_first_not_of(" \t"));
+        value.erase(value.find_last_not_of(" \t\r\n") + 1);
+        *static_cast<std::string*>(out) = value;
+    }
+    return size * count;
+}
+
+class HttpClient {
+private:
+    CURL* curl;
+    std::string baseURL;
+
+public:
+    explicit HttpClient(const std::string& base) : curl(curl_easy_init()), baseURL(base) {}
+    ~HttpClient() { curl_easy_cleanup(curl); }
+
+    Response send(const char* method, const std::string& path, const std::string& body = "",
+                  const std::string& ifNoneMatch = "") {
+        Response res;
+        std::string url = baseURL + path;
+        curl_slist* headers = nullptr;
+        headers = curl_slist_append(headers, "Content-Type: application/json");
+        if (!ifNoneMatch.empty()) headers = curl_slist_append(headers, ("If-None-Match: " + ifNoneMatch).c_str());
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, collectBody);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res.body);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, collectETag);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &res.etag);
+        if (std::strcmp(method, "POST") == 0) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+        } else {
+            curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+        }
+
+        if (curl_easy_perform(curl) == CURLE_OK) {
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &res.status);
+        }
+        curl_slist_free_all(headers);
+        return res;
+    }
+};
+
+// All values of "key":<int> in a JSON body
+static std::vector<int> extractInts(const std::string& body, const std::string& key) {
+    std::vector<int> values;
+    std::string needle = "\"" + key + "\":";
+    for (size_t pos = body.find(needle); pos != std::string::npos; pos = body.find(needle, pos + 1)) {
+        const char* start = body.c_str() + pos + needle.size();
+        if (*start >= '0' && *start <= '9') values.push_back(std::atoi(start));
+    }
+    return values;
+}
+
+// All values of "key":"<string>" in a JSON body (no escapes expected)
+static std::vector<std::string> extractStrings(const std::string& body, const std::string& key) {
+    std::vector<std::string> values;
+    std::string needle = "\"" + key + "\":\"";
+    for (size_t pos = body.find(needle); pos != std::string::npos; pos = body.find(needle, pos + 1)) {
+        size_t start = pos + needle.size();
+        size_t end = body.find('"', start);
+        if (end == std::string::npos) break;
+        values.push_back(body.substr(start, end - start));
+    }
+    return values;
+}
+
+// --- Per-endpoint results ---
+struct EndpointStats {
+    std::vector<uint32_t> latencyMicros;
+    uint64_t ok = 0;          // 2xx and 304
+    uint64_t clientErrors = 0; // 4xx, mostly business rules (e.g. already in a ride)
+    uint64_t serverErrors = 0; // 5xx
+    uint64_t transportErrors = 0;
+};
+
+using StatsMap = std::map<std::string, EndpointStats>;
+
+// Rides seen by any student, used to pick join targets
+struct SharedRides {
+    std::mutex mtx;
+    std::vector<int> open;
+
+    void update(const std::vector<int>& ids) {
+        std::lock_guard<std::mutex> lock(mtx);
+        open = ids;
+    }
+    int pick(std::mt19937& rng) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (open.empty()) return 0;
+        return open[rng() % open.size()];
+    }
+};
+
+static const char* AREAS[] = {"Gulshan-e-Iqbal Block 13", "North Nazimabad Block H", "DHA Phase 5",
+                              "Saddar", "Malir Cantt", "Nazimabad No. 3", "Clifton Block 2"};
+
+class Student {
+private:
+    int index;
+    HttpClient http;
+    std::mt19937 rng;
+    SharedRides& shared;
+    StatsMap& stats;
+
+    std::string userID;
+    int ownRide = 0;
+    bool ownRideStarted = false;
+    int joinedRide = 0;
+    std::map<std::string, std::string> etags;
+
+    Response call(const std::string& label, const char* method, const std::string& path,
+                  const std::string& body, Clock::time_point scheduled, bool conditional = false) {
+        std::string etag = conditional ? etags[path] : std::string();
+        Response res = http.send(method, path, body, etag);
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - scheduled).count();
+
+        EndpointStats& s = stats[label];
+        s.latencyMicros.push_back(static_cast<uint32_t>(std::min<int64_t>(micros, UINT32_MAX)));
+        if (res.status == 0) ++s.transportErrors;
+        else if (res.status >= 500) ++s.serverErrors;
+        else if (res.status >= 400) ++s.clientErrors;
+        else ++s.ok;
+        if (conditional && !res.etag.empty()) etags[path] = res.etag;
+        return res;
+    }
+
+    std::string area() { return AREAS[rng() % (sizeof(AREAS) / sizeof(AREAS[0]))]; }
+
+public:
+    Student(int n, const std::string& baseURL, unsigned seed, SharedRides& rides, StatsMap& out)
+        : index(n), http(baseURL), rng(seed + n), shared(rides), stats(out) {}
+
+    bool login() {
+        std::string body = "{\"idToken\":\"loadgen-" + std::to_string(index) + "\",\"enrollmentId\":\"" +
+                           studentEnrollment(index) + "\"}";
+        Response res = call("POST /auth/google/verify", "POST", "/auth/google/verify", body, Clock::now());
+        auto ids = extractStrings(res.body, "id");
+        if (res.status != 200 || ids.empty()) return false;
+        userID = ids.front();
+        return true;
+    }
+
+    void act(const std::string& action, Clock::time_point scheduled) {
+        if (action == "poll_rides") {
+            Response res = call("GET /ride/all", "GET", "/ride/all", "", scheduled, true);
+            if (res.status == 200) shared.update(extractInts(res.body, "rideID"));
+        } else if (action == "poll_accepted") {
+            call("GET /user/<id>/accepted-requests", "GET", "/user/" + userID + "/accepted-requests", "", scheduled, true);
+        } else if (action == "poll_requests" && ownRide) {
+            call("GET /ride/<id>/requests", "GET", "/ride/" + std::to_string(ownRide) + "/requests", "", scheduled, true);
+        } else if (action == "poll_chat" && (ownRide || joinedRide)) {
+            int ride = ownRide ? ownRide : joinedRide;
+            call("GET /chat/ride/<id>", "GET", "/chat/ride/" + std::to_string(ride), "", scheduled, true);
+        } else if (action == "request_create" && !ownRide) {
+            std::string body = "{\"userID\":\"" + userID + "\",\"from\":\"" + area() +
+                               "\",\"to\":\"NED Campus\",\"rideType\":\"carpool\",\"femalesOnly\":false}";
+            Response res = call("POST /request/create", "POST", "/request/create", body, scheduled);
+            if (res.body.find("You are now the lead") != std::string::npos) {
+                auto ids = extractInts(res.body, "rideID");
+                if (!ids.empty()) ownRide = ids.front();
+            }
+        } else if (action == "offer" && !ownRide) {
+            std::string body = "{\"userID\":\"" + userID + "\",\"from\":\"" + area() +
+                               "\",\"to\":\"NED Campus\",\"rideType\":\"carpool\",\"seats\":4,\"femalesOnly\":false}";
+            Response res = call("POST /ride/offer", "POST", "/ride/offer", body, scheduled);
+            auto ids = extractInts(res.body, "rideID");
+            if (res.status == 200 && !ids.empty()) ownRide = ids.front();
+        } else if (action == "join" && !ownRide && !joinedRide) {
+            int ride = shared.pick(rng);
+            if (!ride) return;
+            std::string body = "{\"userID\":\"" + userID + "\",\"rideID\":" + std::to_string(ride) + "}";
+            Response res = call("POST /ride/request", "POST", "/ride/request", body, scheduled);
+            if (res.status == 200) joinedRide = ride;
+        } else if (action == "respond" && ownRide) {
+            std::string path = "/ride/" + std::to_string(ownRide) + "/requests";
+            Response pending = call("GET /ride/<id>/requests", "GET", path, "", scheduled);
+            for (const auto& requester : extractStrings(pending.body, "userID")) {
+                std::string body = "{\"rideID\":" + std::to_string(ownRide) + ",\"userID\":\"" + requester +
+                                   "\",\"accept\":true}";
+                call("POST /ride/respond", "POST", "/ride/respond", body, scheduled);
+            }
+        } else if (action == "chat_send" && (ownRide || joinedRide)) {
+            int ride = ownRide ? ownRide : joinedRide;
+            std::string body = "{\"sender\":\"" + userID + "\",\"recipient\":\"\",\"text\":\"on my way\",\"rideID\":" +
+                               std::to_string(ride) + "}";
+            call("POST /chat/send", "POST", "/chat/send", body, scheduled);
+        } else if (action == "start_end" && ownRide) {
+            std::string body = "{\"userID\":\"" + userID + "\"}";
+            if (!ownRideStarted) {
+                call("POST /ride/<id>/start", "POST", "/ride/" + std::to_string(ownRide) + "/start", body, scheduled);
+                ownRideStarted = true;
+            } else {
+                call("POST /ride/<id>/end", "POST", "/ride/" + std::to_string(ownRide) + "/end", body, scheduled);
+                ownRide = 0;
+                ownRideStarted = false;
+            }
+        } else {
+            // Action not possible in this student's state; poll like an idle client
+            Response res = call("GET /ride/all", "GET", "/ride/all", "", scheduled, true);
+            if (res.status == 200) shared.update(extractInts(res.body, "rideID"));
+        }
+    }
+};
+
+static double percentile(std::vector<uint32_t>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+    return sorted[rank] / 1000.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: uniride_loadgen <scenario.conf>" << std::endl;
+        return 1;
+    }
+    Scenario scenario;
+    if (!loadScenario(argv[1], scenario)) return 1;
+
+    if (!scenario.seedDB.empty() && !seedStudents(scenario.seedDB, scenario.students)) return 1;
+
+    std::atomic<bool> stopStub{false};
+    std::thread stub;
+    if (scenario.authStubPort > 0) {
+#ifndef _WIN32
+        stub = std::thread(runAuthStub, scenario.authStubPort, std::ref(stopStub));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+#else
+        std::cerr << "auth_stub_port is not supported on Windows" << std::endl;
+#endif
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    std::vector<std::string> actions;
+    std::vector<double> weights;
+    for (const auto& entry : scenario.mix) {
+        actions.push_back(entry.first);
+        weights.push_back(entry.second);
+    }
+
+    SharedRides shared;
+    std::vector<StatsMap> perStudent(scenario.students);
+    std::atomic<int> loggedIn{0};
+    auto start = Clock::now();
+    auto end = start + std::chrono::seconds(scenario.durationSeconds);
+    double meanGapSeconds = scenario.students / scenario.rps;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < scenario.students; ++i) {
+        workers.emplace_back([&, i]() {
+            Student student(i, scenario.baseURL, scenario.seed, shared, perStudent[i]);
+            if (!student.login()) return;
+            loggedIn.fetch_add(1);
+
+            std::mt19937 rng(scenario.seed * 7919 + i);
+            std::exponential_distribution<double> gap(1.0 / meanGapSeconds);
+            std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+            auto next = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+            while (next < end) {
+                std::this_thread::sleep_until(next);
+                student.act(actions[pick(rng)], next);
+                next += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(gap(rng)));
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    stopStub.store(true);
+    if (stub.joinable()) stub.join();
+    curl_global_cleanup();
+
+    StatsMap merged;
+    for (auto& studentStats : perStudent) {
+        for (auto& entry : studentStats) {
+            EndpointStats& m = merged[entry.first];
+            m.latencyMicros.insert(m.latencyMicros.end(), entry.second.latencyMicros.begin(), entry.second.latencyMicros.end());
+            m.ok += entry.second.ok;
+            m.clientErrors += entry.second.clientErrors;
+            m.serverErrors += entry.second.serverErrors;
+            m.transportErrors += entry.second.transportErrors;
+        }
+    }
+
+    uint64_t total = 0;
+    std::printf("students logged in: %d/%d, elapsed: %.1f s, target: %.1f rps\n",
+                loggedIn.load(), scenario.students, elapsed, scenario.rps);
+    std::printf("%-36s %8s %8s %9s %9s %9s %7s %7s %7s\n",
+                "endpoint", "requests", "rps", "p50 ms", "p95 ms", "p99 ms", "4xx %", "5xx %", "net %");
+    for (auto& entry : merged) {
+        EndpointStats& s = entry.second;
+        std::sort(s.latencyMicros.begin(), s.latencyMicros.end());
+        double n = static_cast<double>(s.latencyMicros.size());
+        total += s.latencyMicros.size();
+        std::printf("%-36s %8zu %8.1f %9.2f %9.2f %9.2f %7.2f %7.2f %7.2f\n",
+                    entry.first.c_str(), s.latencyMicros.size(), n / elapsed,
+                    percentile(s.latencyMicros, 0.50), percentile(s.latencyMicros, 0.95), percentile(s.latencyMicros, 0.99),
+                    100.0 * s.clientErrors / n, 100.0 * s.serverErrors / n, 100.0 * s.transportErrors / n);
+    }
+    std::printf("total: %llu requests, %.1f rps achieved\n", static_cast<unsigned long long>(total), total / elapsed);
+    return 0;
+}
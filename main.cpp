@@ -2,33 +2,179 @@
 #include "crow/middlewares/cors.h"
 #include "AuthSys.h"
 #include "RideSystem.h"
+#include "RequestArena.h"
 #include "RequestQueue.h"
 #include "ChatFeature.h"
 #include "DatabaseManager.h"
+#include "JsonWriter.h"
+#include "RideFragmentCache.h"
+#include "VersionRegistry.h"
+#include "Metrics.h"
+#include "MetricsMiddleware.h"
+#include "AdmissionControl.h"
+#include "AdmissionMiddleware.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "TracingMiddleware.h"
+#include "SqlProfiler.h"
+#include "Executor.h"
+#include "MaintenanceScheduler.h"
+#include <curl/curl.h>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
 
-// Helper function to convert string to RideType
-RideType stringToRideType(const std::string& typeStr) {
-    if (typeStr == "bike") return RideType::BIKE;
-    if (typeStr == "carpool") return RideType::CARPOOL;
-    if (typeStr == "rickshaw") return RideType::RICKSHAW;
-    return RideType::CARPOOL;
+// Helper to send a JsonWriter body with the JSON content type
+crow::response jsonResponse(const JsonWriter& json, int code = 200) {
+    crow::response res(code, json.str());
+    res.set_header("Content-Type", "application/json");
+    return res;
 }
 
-// Helper function to convert RideType to string
-std::string rideTypeToString(RideType type) {
-    switch (type) {
-        case RideType::BIKE: return "bike";
-        case RideType::CARPOOL: return "carpool";
-        case RideType::RICKSHAW: return "rickshaw";
-        default: return "carpool";
+// Conditional GET: true when If-None-Match already names the current ETag
+bool isNotModified(const crow::request& req, const std::string& etag) {
+    const std::string& header = req.get_header_value("If-None-Match");
+    return !header.empty() && (header == "*" || header.find(etag) != std::string::npos);
+}
+
+// Parse a non-negative integer query parameter, falling back on missing or bad input
+int intParam(const crow::request& req, const char* name, int fallback) {
+    const char* value = req.url_params.get(name);
+    if (!value || !*value) return fallback;
+    char* end = nullptr;
+    long parsed = std::strtol(value, &end, 10);
+    if (*end != '\0' || parsed < 0 || parsed > INT32_MAX) return fallback;
+    return static_cast<int>(parsed);
+}
+
+std::string stringParam(const crow::request& req, const char* name) {
+    const char* value = req.url_params.get(name);
+    return value ? std::string(value) : std::string();
+}
+
+// Optional departure fields of an offer or request body: departAt in unix
+// seconds and windowMinutes either side of it. False when they are out of range.
+bool readDeparture(const crow::json::rvalue& data, int64_t& departAt, int& departWindow) {
+    departAt = data.has("departAt") ? data["departAt"].i() : 0;
+    int64_t minutes = data.has("windowMinutes") ? data["windowMinutes"].i() : DEFAULT_DEPART_WINDOW / 60;
+    if (departAt < 0 || departAt > UINT32_MAX || minutes < 0 || minutes * 60 > MAX_DEPART_WINDOW) return false;
+    departWindow = static_cast<int>(minutes * 60);
+    return true;
+}
+
+// no-cache makes browsers revalidate with If-None-Match on every poll
+void setETag(crow::response& res, const std::string& etag) {
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "no-cache");
+}
+
+crow::response notModified(const std::string& etag) {
+    crow::response res(304);
+    setETag(res, etag);
+    return res;
+}
+
+// Runs a handler body on a worker pool and completes `res` from there, so
+// the Crow I/O thread is free while SQLite or curl blocks. A sampled trace
+// moves with the work and ends when the body returns. A full queue refuses
+// the request with 503 instead of letting it wait. A body that throws (e.g.
+// .s() on a missing JSON key) is answered with 500, as Crow does for
+// synchronous handlers; the response is always ended.
+template <typename Submit, typename Handler>
+void respondAsyncWith(Submit&& submit, crow::response& res, Handler&& handler) {
+    auto trace = std::make_shared<Tracer::Context>(Tracer::detach());
+    bool queued = submit([&res, trace, handler = std::forward<Handler>(handler)]() mutable {
+        Tracer::attach(std::move(*trace));
+        crow::response result;
+        try {
+            result = handler();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Handler threw: " << e.what());
+            result = crow::response(500, "Internal server error");
+        } catch (...) {
+            LOG_ERROR("Handler threw an unknown exception");
+            result = crow::response(500, "Internal server error");
+        }
+        Tracer::instance().endRequest();
+        res.code = result.code;
+        res.body = std::move(result.body);
+        res.headers = std::move(result.headers);
+        res.end();
+    });
+    if (!queued) {
+        Tracer::attach(std::move(*trace)); // after_handle closes it on this thread
+        res.code = 503;
+        res.set_header("Retry-After", "1");
+        res.body = "Server busy, retry shortly";
+        res.end();
     }
 }
 
+template <typename Handler>
+void respondAsync(DatabaseManager& db, crow::response& res, Handler&& handler) {
+    respondAsyncWith([&db](std::function<void()> task) { return db.post(std::move(task)); },
+                     res, std::forward<Handler>(handler));
+}
+
+template <typename Handler>
+void respondAsync(Executor& pool, crow::response& res, Handler&& handler) {
+    respondAsyncWith([&pool](std::function<void()> task) { return pool.submit(std::move(task)); },
+                     res, std::forward<Handler>(handler));
+}
+
 int main() {
+    // UNIRIDE_LOG_LEVEL=trace|debug|info|warn|error|off (default info)
+    LogLevel logLevel = LogLevel::Info;
+    if (const char* envLevel = std::getenv("UNIRIDE_LOG_LEVEL")) {
+        if (!Logger::parseLevel(envLevel, logLevel)) {
+            std::cerr << "Unknown UNIRIDE_LOG_LEVEL '" << envLevel << "', using info" << std::endl;
+        }
+    }
+    Logger::setLevel(logLevel);
+    Logger::instance().start();
+
+    // UNIRIDE_TRACE_SAMPLE=0.01 traces one request in 100 to UNIRIDE_TRACE_FILE
+    if (const char* sample = std::getenv("UNIRIDE_TRACE_SAMPLE")) {
+        const char* traceFile = std::getenv("UNIRIDE_TRACE_FILE");
+        Tracer::instance().open(traceFile ? traceFile : "uniride-trace.json", std::atof(sample));
+    }
+
+    // Blocking work runs on these pools, never on Crow's I/O threads.
+    // UNIRIDE_DB_THREADS / UNIRIDE_AUTH_THREADS size them (default 4 / 8).
+    auto envCount = [](const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        long parsed = value ? std::atol(value) : 0;
+        return parsed > 0 ? static_cast<size_t>(parsed) : fallback;
+    };
+    curl_global_init(CURL_GLOBAL_DEFAULT); // not thread-safe; must precede the auth pool
+    Executor dbPool("db", envCount("UNIRIDE_DB_THREADS", 4), envCount("UNIRIDE_DB_QUEUE", 1024));
+    Executor authPool("auth", envCount("UNIRIDE_AUTH_THREADS", 8), envCount("UNIRIDE_AUTH_QUEUE", 256));
+
+    // Admission control: per-user and per-IP request rates (UNIRIDE_USER_RPS /
+    // UNIRIDE_USER_BURST, UNIRIDE_IP_RPS / UNIRIDE_IP_BURST), in-flight caps per
+    // route class (UNIRIDE_MAX_INFLIGHT_AUTH / _WRITE / _POLL) and the DB queue
+    // depth at which polls are shed (UNIRIDE_SHED_DB_QUEUE)
+    AdmissionControl::Limits admissionLimits;
+    admissionLimits.userRate = static_cast<uint32_t>(envCount("UNIRIDE_USER_RPS", admissionLimits.userRate));
+    admissionLimits.userBurst = static_cast<uint32_t>(envCount("UNIRIDE_USER_BURST", admissionLimits.userBurst));
+    admissionLimits.ipRate = static_cast<uint32_t>(envCount("UNIRIDE_IP_RPS", admissionLimits.ipRate));
+    admissionLimits.ipBurst = static_cast<uint32_t>(envCount("UNIRIDE_IP_BURST", admissionLimits.ipBurst));
+    admissionLimits.maxInFlight[0] = envCount("UNIRIDE_MAX_INFLIGHT_AUTH", admissionLimits.maxInFlight[0]);
+    admissionLimits.maxInFlight[1] = envCount("UNIRIDE_MAX_INFLIGHT_WRITE", admissionLimits.maxInFlight[1]);
+    admissionLimits.maxInFlight[2] = envCount("UNIRIDE_MAX_INFLIGHT_POLL", admissionLimits.maxInFlight[2]);
+    admissionLimits.shedPollsAtDbQueue = envCount("UNIRIDE_SHED_DB_QUEUE", admissionLimits.shedPollsAtDbQueue);
+    AdmissionControl admission(admissionLimits);
+    admission.setDbPool(&dbPool);
+
     // Setup CORS-enabled app
-    crow::App<crow::CORSHandler> app;
+    crow::App<crow::CORSHandler, MetricsMiddleware, TracingMiddleware, AdmissionMiddleware> app;
     
     // Configure CORS BEFORE routes
     auto& cors = app.get_middleware<crow::CORSHandler>();
@@ -40,13 +186,23 @@ int main() {
         .allow_credentials();
 
     // Initialize database
-    auto dbManagerPtr = std::make_shared<DatabaseManager>("rideshare.db");
+    SqlProfiler sqlProfiler;
+    // UNIRIDE_DB picks another database file, e.g. a scratch one for load tests
+    const char* dbPath = std::getenv("UNIRIDE_DB");
+    auto dbManagerPtr = std::make_shared<DatabaseManager>(dbPath && *dbPath ? dbPath : "rideshare.db");
+    dbManagerPtr->setSqlProfiler(&sqlProfiler);
+    dbManagerPtr->setExecutor(&dbPool);
+    if (const char* archive = std::getenv("UNIRIDE_ARCHIVE_DB")) dbManagerPtr->setArchivePath(archive);
     if (!dbManagerPtr->initialize()) {
         std::cerr << "Failed to initialize database!" << std::endl;
         return -1;
     }
 
     DatabaseManager& dbManager = *dbManagerPtr;
+    RideFragmentCache rideCache;
+    dbManager.setRideCache(&rideCache);
+    VersionRegistry versions;
+    dbManager.setVersionRegistry(&versions);
     AuthSystem authSystem(dbManagerPtr);
     RideSystem rideSystem;
     rideSystem.setDatabaseManager(&dbManager);
@@ -56,641 +212,919 @@ int main() {
     }
     
     dbManager.setLocationGraph(&rideSystem.getLocationGraph());
+    dbManager.setMatchingEngine(&rideSystem.getMatchingEngine()); // one ride index for both matchers
     RequestQueue requestQueue(&rideSystem, &dbManager);
     auto chatFeature = std::make_unique<ChatFeature>();
+    chatFeature->setVersionRegistry(&versions);
+
+    Metrics metrics;
+    app.get_middleware<MetricsMiddleware>().metrics = &metrics;
+    // One /metrics series per route served below; any other path counts as "other"
+    for (const char* route : {
+        "GET /", "GET /metrics", "GET /debug/sql", "POST /auth/google/verify", "POST /user/preferences",
+        "GET /user/preferences/<string>", "GET /ride/all", "POST /ride/offer", "POST /request/create",
+        "POST /ride/request", "POST /ride/respond", "GET /ride/<int>/requests", "POST /chat/send",
+        "GET /chat/ride/<int>", "GET /user/<string>/gender", "GET /user/<string>/accepted-requests",
+        "GET /user/<string>/rides", "GET /ride/<int>/accepted", "GET /ride/<int>/participants",
+        "POST /ride/<int>/start", "POST /ride/<int>/end"}) {
+        metrics.registerRoute(route);
+    }
+    app.get_middleware<AdmissionMiddleware>().admission = &admission;
+    app.get_middleware<AdmissionMiddleware>().auth = &authSystem;
+    // Table counts are sampled by the "sample_counts" maintenance job below so
+    // a scrape never runs SQL on the I/O thread
+    std::atomic<int> liveRides{0};
+    std::atomic<int> pendingJoinRequests{0};
+    metrics.registerGauge("uniride_live_rides", "Rides that are open, full or started.",
+                          [&liveRides]() { return double(liveRides.load(std::memory_order_relaxed)); });
+    metrics.registerGauge("uniride_open_ride_table_rows", "Open rides held in the in-memory matching table.",
+                          [&rideSystem]() { return double(rideSystem.getOpenRideTable().size()); });
+    metrics.registerGauge("uniride_pending_join_requests", "Join requests waiting for the ride lead.",
+                          [&pendingJoinRequests]() { return double(pendingJoinRequests.load(std::memory_order_relaxed)); });
+    metrics.registerGauge("uniride_request_queue_depth", "Requests waiting in the in-memory RequestQueue.",
+                          [&requestQueue]() { return double(requestQueue.pendingCount()); });
+    metrics.registerGauge("uniride_chat_channels", "Ride chats held in memory.",
+                          [&chatFeature]() { return double(chatFeature->channelCount()); });
+    metrics.registerGauge("uniride_sessions", "Active session tokens.",
+                          [&authSystem]() { return double(authSystem.sessionCount()); });
+    metrics.registerGauge("uniride_db_queue_depth", "Handlers waiting for a DB executor thread.",
+                          [&dbPool]() { return double(dbPool.queueDepth()); });
+    metrics.registerGauge("uniride_auth_queue_depth", "Logins waiting for an auth executor thread.",
+                          [&authPool]() { return double(authPool.queueDepth()); });
+    metrics.registerGauge("uniride_rate_limited_total", "Requests refused with 429 by the per-user or per-IP limits.",
+                          [&admission]() { return double(admission.rateLimited()); });
+    metrics.registerGauge("uniride_shed_total", "Requests refused with 503 by in-flight caps or DB queue shedding.",
+                          [&admission]() { return double(admission.overloaded()); });
+    metrics.registerGauge("uniride_inflight_polls", "Admitted GET requests not yet answered.",
+                          [&admission]() { return double(admission.inFlightCount(AdmissionControl::RouteClass::POLL)); });
+
+    // Background expiry and cleanup. Every slice is posted to the DB pool like
+    // a handler; a full queue skips the slice until the next run. TTLs are
+    // minutes: UNIRIDE_RIDE_TTL_MINUTES past the departure window (or since
+    // creation when unscheduled), UNIRIDE_JOIN_REQUEST_TTL_MINUTES and
+    // UNIRIDE_REQUEST_TTL_MINUTES since creation.
+    const int64_t rideTTL = int64_t(envCount("UNIRIDE_RIDE_TTL_MINUTES", 120)) * 60;
+    const int64_t joinRequestTTL = int64_t(envCount("UNIRIDE_JOIN_REQUEST_TTL_MINUTES", 60)) * 60;
+    const int64_t requestTTL = int64_t(envCount("UNIRIDE_REQUEST_TTL_MINUTES", 30)) * 60;
+    auto onDb = [&dbManager](auto work) {
+        using Result = decltype(work(dbManager));
+        try {
+            return dbManager.async(std::move(work)).get();
+        } catch (const std::exception& e) {
+            LOG_WARN("Maintenance slice skipped: " << e.what());
+            return Result{};
+        }
+    };
+    MaintenanceScheduler maintenance;
+    maintenance.every("expire_rides", std::chrono::minutes(1), 64, [&, rideTTL](size_t batch) {
+        int64_t cutoff = std::time(nullptr) - rideTTL;
+        auto expired = onDb([=](DatabaseManager& db) { return db.expireStaleRides(cutoff, int(batch)); });
+        chatFeature->evictRides(expired);
+        return expired.size();
+    });
+    maintenance.every("expire_join_requests", std::chrono::minutes(1), 64, [&, joinRequestTTL](size_t batch) {
+        int64_t cutoff = std::time(nullptr) - joinRequestTTL;
+        return size_t(onDb([=](DatabaseManager& db) { return db.expirePendingJoinRequests(cutoff, int(batch)); }));
+    });
+    maintenance.every("expire_requests", std::chrono::minutes(5), 256, [&, requestTTL](size_t batch) {
+        int64_t cutoff = std::time(nullptr) - requestTTL;
+        return size_t(onDb([=](DatabaseManager& db) { return db.expireRequests(cutoff, int(batch)); }));
+    });
+    // Completed rides and closed requests move to the archive database
+    maintenance.every("archive_rides", std::chrono::minutes(1), 64, [&](size_t batch) {
+        return size_t(onDb([=](DatabaseManager& db) { return db.archiveCompletedRides(int(batch)); }));
+    });
+    maintenance.every("archive_requests", std::chrono::minutes(5), 256, [&](size_t batch) {
+        return size_t(onDb([=](DatabaseManager& db) { return db.archiveClosedRequests(int(batch)); }));
+    });
+    // Chats of rides ended by their lead; checked `batch` rides per DB task
+    maintenance.every("evict_chats", std::chrono::minutes(5), 64, [&](size_t batch) {
+        std::vector<int> channels = chatFeature->channelIDs();
+        size_t evicted = 0;
+        for (size_t first = 0; first < channels.size(); first += batch) {
+            std::vector<int> slice(channels.begin() + first, channels.begin() + std::min(channels.size(), first + batch));
+            auto finished = onDb([slice](DatabaseManager& db) { return db.finishedRideIDs(slice); });
+            evicted += chatFeature->evictRides(finished);
+        }
+        return evicted;
+    });
+    maintenance.every("sample_counts", std::chrono::seconds(15), 1, [&](size_t) {
+        // A skipped slice keeps the previous sample
+        auto counts = onDb([](DatabaseManager& db) {
+            return std::optional<std::pair<int, int>>({db.countLiveRides(), db.countPendingJoinRequests()});
+        });
+        if (counts) {
+            liveRides.store(counts->first, std::memory_order_relaxed);
+            pendingJoinRequests.store(counts->second, std::memory_order_relaxed);
+        }
+        return size_t(0);
+    });
+    metrics.registerGauge("uniride_maintenance_items", "Rows and chats handled by background maintenance jobs.",
+                          [&maintenance]() {
+                              uint64_t items = 0;
+                              for (const auto& job : maintenance.stats()) items += job.items;
+                              return double(items);
+                          });
 
     CROW_ROUTE(app, "/")
     ([]() {
         return "UniRide API is running successfully!";
     });
 
+    CROW_ROUTE(app, "/metrics").methods("GET"_method)
+    ([&metrics]() {
+        crow::response res(metrics.renderPrometheus());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
+    // Per-statement SQLite timings, slowest total first; ?reset=1 clears them.
+    // Loopback only since the SQL text reveals the schema.
+    CROW_ROUTE(app, "/debug/sql").methods("GET"_method)
+    ([&sqlProfiler](const crow::request &req) {
+        if (req.remote_ip_address != "127.0.0.1" && req.remote_ip_address != "::1") {
+            return crow::response(403, "Forbidden");
+        }
+        thread_local JsonWriter json;
+        json.clear();
+        sqlProfiler.writeJson(json);
+        if (req.url_params.get("reset")) sqlProfiler.reset();
+        return jsonResponse(json);
+    });
+
     // FIXED: Google Auth endpoint with proper JSON handling
     CROW_ROUTE(app, "/auth/google/verify").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) {
-            crow::json::wvalue err;
-            err["success"] = false;
-            err["error"] = "Invalid JSON";
-            return crow::response(400, err);
-        }
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(authPool, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) {
+                crow::json::wvalue err;
+                err["success"] = false;
+                err["error"] = "Invalid JSON";
+                return crow::response(400, err);
+            }
 
-        if (!data.has("idToken") || !data.has("enrollmentId")) {
-            crow::json::wvalue err;
-            err["success"] = false;
-            err["error"] = "Missing idToken or enrollmentId";
-            return crow::response(400, err);
-        }
+            if (!data.has("idToken") || !data.has("enrollmentId")) {
+                crow::json::wvalue err;
+                err["success"] = false;
+                err["error"] = "Missing idToken or enrollmentId";
+                return crow::response(400, err);
+            }
 
-        std::string idToken = data["idToken"].s();
-        std::string enrollmentId = data["enrollmentId"].s();
+            std::string idToken = data["idToken"].s();
+            std::string enrollmentId = data["enrollmentId"].s();
 
-        User user = authSystem.handleGoogleAuth(idToken, enrollmentId);
+            User user = authSystem.handleGoogleAuth(idToken, enrollmentId);
         
-        if (user.userID.empty()) {
-            crow::json::wvalue err;
-            err["success"] = false;
-            err["error"] = "Invalid Enrollment ID";
-            return crow::response(401, err);
-        }
+            if (user.userID.empty()) {
+                crow::json::wvalue err;
+                err["success"] = false;
+                err["error"] = "Invalid Enrollment ID";
+                return crow::response(401, err);
+            }
 
-        std::string sessionToken = authSystem.storeSessionToken(user.userID);
+            std::string sessionToken = authSystem.storeSessionToken(user.userID);
 
-        // DEBUG: Log what we're sending
-        std::cout << "DEBUG: Auth response - userID: " << user.userID << ", gender: '" << user.gender << "'" << std::endl;
+            LOG_DEBUG("Auth response - userID: " << user.userID << ", gender: '" << user.gender << "'");
         
-        crow::json::wvalue res;
-        res["success"] = true;
-        res["user"]["id"] = user.userID;
-        res["user"]["name"] = user.name;
-        res["user"]["email"] = user.email;
-        res["user"]["gender"] = user.gender;
-        res["user"]["canSeeFemalesOnly"] = (user.gender == "female");
-        res["sessionToken"] = sessionToken;
-        res["expiresIn"] = 86400;
+            crow::json::wvalue res;
+            res["success"] = true;
+            res["user"]["id"] = user.userID;
+            res["user"]["name"] = user.name;
+            res["user"]["email"] = user.email;
+            res["user"]["gender"] = user.gender;
+            res["user"]["canSeeFemalesOnly"] = (user.gender == "female");
+            res["sessionToken"] = sessionToken;
+            res["expiresIn"] = 86400;
 
-        return crow::response(200, res);
+            return crow::response(200, res);
+        });
     });
 
     // SET USER PREFERENCES
     CROW_ROUTE(app, "/user/preferences").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
-        std::string genderPref = data.has("genderPreference") ? data["genderPreference"].s() : std::string("any");
-        int vehicleType = data["vehicleType"].i();
+            std::string userID = data["userID"].s();
+            std::string genderPref = data.has("genderPreference") ? data["genderPreference"].s() : std::string("any");
+            int vehicleType = data["vehicleType"].i();
         
-        bool success = dbManager.updateUserPreferences(userID, genderPref, vehicleType);
+            bool success = dbManager.updateUserPreferences(userID, genderPref, vehicleType);
         
-        crow::json::wvalue res;
-        res["success"] = success;
-        res["message"] = success ? "Preferences updated" : "Failed to update";
-        return crow::response(res);
+            crow::json::wvalue res;
+            res["success"] = success;
+            res["message"] = success ? "Preferences updated" : "Failed to update";
+            return crow::response(res);
+        });
     });
 
     // GET USER PREFERENCES
     CROW_ROUTE(app, "/user/preferences/<string>").methods("GET"_method)
-    ([&](const std::string& userID) {
-        std::string genderPref;
-        int vehicleType;
-        
-        bool success = dbManager.getUserPreferences(userID, genderPref, vehicleType);
-        
-        crow::json::wvalue res;
-        if (success) {
-            res["genderPreference"] = genderPref;
-            res["vehicleType"] = vehicleType;
-        } else {
-            res["error"] = "Not found";
-        }
-        return crow::response(res);
+    ([&](crow::response &res, const std::string& userID) {
+        respondAsync(dbManager, res, [&, userID]() -> crow::response {
+            std::string genderPref;
+            int vehicleType;
+        
+            bool success = dbManager.getUserPreferences(userID, genderPref, vehicleType);
+        
+            crow::json::wvalue res;
+            if (success) {
+                res["genderPreference"] = genderPref;
+                res["vehicleType"] = vehicleType;
+            } else {
+                res["error"] = "Not found";
+            }
+            return crow::response(res);
+        });
     });
 
-    // Helper function to convert RideStatus to string
-    auto rideStatusToString = [](RideStatus status) -> std::string {
-        switch (status) {
-            case RideStatus::OPEN: return "open";
-            case RideStatus::FULL: return "full";
-            case RideStatus::STARTED: return "started";
-            case RideStatus::COMPLETED: return "completed";
-            default: return "open";
-        }
-    };
-
     // GET ALL RIDES
+    // Without query parameters this returns every ride (cached fragments).
+    // With any of owner, participant, status, type, from, cursor or limit it
+    // returns one keyset page ordered by rideID plus a nextCursor.
     CROW_ROUTE(app, "/ride/all").methods("GET"_method)
-    ([&]() {
-        auto rides = dbManager.getAllRides();
-        crow::json::wvalue res;
-        res["rides"] = crow::json::wvalue::list();
-        
-        for (size_t i = 0; i < rides.size(); ++i) {
-            User leadUser = dbManager.getUserByID(rides[i].ownerID);
-            res["rides"][i]["rideID"] = rides[i].rideID;
-            res["rides"][i]["leadUserID"] = rides[i].ownerID;
-            res["rides"][i]["leadUserName"] = leadUser.name;
-            res["rides"][i]["from"] = rides[i].from;
-            res["rides"][i]["to"] = rides[i].to;
-            res["rides"][i]["time"] = rides[i].time;
-            res["rides"][i]["rideType"] = rideTypeToString(rides[i].rideType);
-            res["rides"][i]["currentCapacity"] = rides[i].currentCapacity;
-            res["rides"][i]["maxCapacity"] = rides[i].maxCapacity;
-            res["rides"][i]["availableSlots"] = rides[i].getAvailableSlots();
-            res["rides"][i]["femalesOnly"] = rides[i].femalesOnly;
-            res["rides"][i]["status"] = rideStatusToString(rides[i].status);
-        }
-        
-        return crow::response(res);
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            static const char* listParams[] = {"owner", "participant", "status", "type", "from", "cursor", "limit"};
+            bool paged = false;
+            for (const char* param : listParams) {
+                if (req.url_params.get(param)) paged = true;
+            }
+
+            if (paged) {
+                RideFilter filter;
+                filter.ownerID = stringParam(req, "owner");
+                filter.participantID = stringParam(req, "participant");
+                filter.status = stringParam(req, "status");
+                filter.fromArea = stringParam(req, "from");
+                std::string type = stringParam(req, "type");
+                if (!type.empty()) {
+                    if (type != "bike" && type != "carpool" && type != "rickshaw") {
+                        return crow::response(400, "Unknown ride type");
+                    }
+                    filter.rideType = static_cast<int>(stringToRideType(type));
+                }
+                if (!filter.status.empty() && filter.status != "open" && filter.status != "full" &&
+                    filter.status != "started" && filter.status != "completed") {
+                    return crow::response(400, "Unknown ride status");
+                }
+                int cursor = intParam(req, "cursor", 0);
+                int limit = std::min(std::max(intParam(req, "limit", 50), 1), 200);
+
+                // Rows go straight from the cursor into the writer; one extra
+                // row tells whether another page exists
+                RideCursor rides = dbManager.scanRides(filter, cursor, limit + 1);
+
+                TRACE_SPAN("rides.serializePage", "serialize");
+                thread_local JsonWriter json;
+                json.clear();
+                json.beginObject().key("rides").beginArray();
+                int written = 0;
+                int lastID = 0;
+                bool hasMore = false;
+                while (rides.next()) {
+                    if (written == limit) {
+                        hasMore = true;
+                        break;
+                    }
+                    RideView ride = rides.ride();
+                    RideFragmentCache::writeRide(json, ride, rides.leadName());
+                    lastID = ride.rideID;
+                    ++written;
+                }
+                json.endArray().key("nextCursor");
+                if (hasMore) json.value(lastID);
+                else json.valueNull();
+                json.endObject();
+                return jsonResponse(json);
+            }
+
+            std::string etag = versions.etag("rides", versions.rideSetVersion(), true);
+            if (isNotModified(req, etag)) return notModified(etag);
+
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("rides").beginArray();
+            rideCache.appendRides(json, dbManager);
+            json.endArray().endObject();
+            auto res = jsonResponse(json);
+            setETag(res, etag);
+            return res;
+        });
     });
 
     // CREATE RIDE OFFER
     CROW_ROUTE(app, "/ride/offer").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
+            std::string userID = data["userID"].s();
         
-        // Check if user already has an active ride
-        auto activeRides = dbManager.getActiveRidesForUser(userID);
-        if (!activeRides.empty()) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["error"] = "You already have an active ride. Please end your current ride before creating a new one.";
-            return crow::response(400, res);
-        }
+            // Check if user already has an active ride
+            auto activeRides = dbManager.getActiveRidesForUser(userID);
+            if (!activeRides.empty()) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["error"] = "You already have an active ride. Please end your current ride before creating a new one.";
+                return crow::response(400, res);
+            }
 
-        RideType rideType = stringToRideType(data["rideType"].s());
-        bool femalesOnly = data.has("femalesOnly") ? data["femalesOnly"].b() : false;
+            RideType rideType = stringToRideType(data["rideType"].s());
+            bool femalesOnly = data.has("femalesOnly") ? data["femalesOnly"].b() : false;
         
-        if (rideType == RideType::RICKSHAW) {
-            return crow::response(400, "Rickshaw rides cannot have owners");
-        }
+            if (rideType == RideType::RICKSHAW) {
+                return crow::response(400, "Rickshaw rides cannot have owners");
+            }
         
-        Ride ride(userID, data["from"].s(), data["to"].s(), 
-                  "now", "offer", rideType, femalesOnly);
-
-        // Interpret `seats` from the frontend as passenger seats (excluding owner)
-        // when an owner is present for bike/carpool. Internally the code stores
-        // maxCapacity as the total number of people. To keep existing logic
-        // (where currentCapacity starts at 1 for an owner), add 1 to the
-        // frontend-provided passenger seats when an owner exists. If there is
-        // no owner (e.g., rickshaw-like flows created without an owner), treat
-        // the provided seats as the total capacity and ensure the creator is
-        // counted in currentCapacity/participants when appropriate.
-        if (data.has("seats")) {
-            int seatsFromFrontend = data["seats"].i();
-
-            if (!ride.ownerID.empty() && (ride.rideType == RideType::BIKE || ride.rideType == RideType::CARPOOL)) {
-                // Frontend gave passenger seats excluding owner; store total people count
-                ride.maxCapacity = seatsFromFrontend + 1;
-                // Ensure owner is counted as current participant
-                ride.currentCapacity = 1;
-                if (std::find(ride.participants.begin(), ride.participants.end(), ride.ownerID) == ride.participants.end() && !ride.ownerID.empty()) {
-                    ride.participants.push_back(ride.ownerID);
-                }
-            } else {
-                // No owner or other ride types: treat seats as total capacity.
-                ride.maxCapacity = seatsFromFrontend;
-                // If creator exists, ensure they are counted
-                if (!ride.ownerID.empty()) {
+            // Without a departAt the ride leaves now, within the default window
+            int64_t departAt;
+            int departWindow;
+            if (!readDeparture(data, departAt, departWindow)) {
+                return crow::response(400, "Invalid departAt or windowMinutes");
+            }
+            Ride ride(userID, data["from"].s(), data["to"].s(), 
+                      departAt ? "scheduled" : "now", "offer", rideType, femalesOnly);
+            ride.departAt = departAt ? departAt : static_cast<int64_t>(std::time(nullptr));
+            ride.departWindow = departWindow;
+
+            // Interpret `seats` from the frontend as passenger seats (excluding owner)
+            // when an owner is present for bike/carpool. Internally the code stores
+            // maxCapacity as the total number of people. To keep existing logic
+            // (where currentCapacity starts at 1 for an owner), add 1 to the
+            // frontend-provided passenger seats when an owner exists. If there is
+            // no owner (e.g., rickshaw-like flows created without an owner), treat
+            // the provided seats as the total capacity and ensure the creator is
+            // counted in currentCapacity/participants when appropriate.
+            if (data.has("seats")) {
+                int seatsFromFrontend = data["seats"].i();
+
+                if (!ride.ownerID.empty() && (ride.rideType == RideType::BIKE || ride.rideType == RideType::CARPOOL)) {
+                    // Frontend gave passenger seats excluding owner; store total people count
+                    ride.maxCapacity = seatsFromFrontend + 1;
+                    // Ensure owner is counted as current participant
                     ride.currentCapacity = 1;
-                    if (std::find(ride.participants.begin(), ride.participants.end(), ride.ownerID) == ride.participants.end()) {
+                    if (std::find(ride.participants.begin(), ride.participants.end(), ride.ownerID) == ride.participants.end() && !ride.ownerID.empty()) {
                         ride.participants.push_back(ride.ownerID);
                     }
+                } else {
+                    // No owner or other ride types: treat seats as total capacity.
+                    ride.maxCapacity = seatsFromFrontend;
+                    // If creator exists, ensure they are counted
+                    if (!ride.ownerID.empty()) {
+                        ride.currentCapacity = 1;
+                        if (std::find(ride.participants.begin(), ride.participants.end(), ride.ownerID) == ride.participants.end()) {
+                            ride.participants.push_back(ride.ownerID);
+                        }
+                    }
                 }
             }
-        }
         
-        int rideID = dbManager.insertRide(ride);
-        if (rideID == -1) {
-            return crow::response(500, "Failed to save ride");
-        }
+            int rideID = dbManager.insertRide(ride);
+            if (rideID == -1) {
+                return crow::response(500, "Failed to save ride");
+            }
         
-        chatFeature->SetRideLead(rideID, data["userID"].s());
+            chatFeature->SetRideLead(rideID, data["userID"].s());
         
-        crow::json::wvalue res;
-        res["message"] = "Ride created";
-        res["rideType"] = rideTypeToString(rideType);
-        res["maxCapacity"] = ride.maxCapacity;
-        res["rideID"] = ride.rideID;
+            crow::json::wvalue res;
+            res["message"] = "Ride created";
+            res["rideType"] = rideTypeToString(rideType);
+            res["maxCapacity"] = ride.maxCapacity;
+            res["rideID"] = ride.rideID;
         
-        return crow::response(res);
+            return crow::response(res);
+        });
     });
 
     // CREATE REQUEST
     CROW_ROUTE(app, "/request/create").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
+            std::string userID = data["userID"].s();
         
-        // Check if user already has an active ride
-        auto activeRides = dbManager.getActiveRidesForUser(userID);
-        if (!activeRides.empty()) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["error"] = "You already have an active ride. Please end your current ride before creating a new one.";
-            return crow::response(400, res);
-        }
+            // Check if user already has an active ride
+            auto activeRides = dbManager.getActiveRidesForUser(userID);
+            if (!activeRides.empty()) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["error"] = "You already have an active ride. Please end your current ride before creating a new one.";
+                return crow::response(400, res);
+            }
 
-        RideType rideType = stringToRideType(data["rideType"].s());
-        
-        // Extract femalesOnly from request
-        bool femalesOnly = data.has("femalesOnly") ? data["femalesOnly"].b() : false;
+            RideType rideType = stringToRideType(data["rideType"].s());
         
-        User user = dbManager.getUserByID(userID);
-        
-        // DEBUG: Log request details
-        std::cout << "DEBUG: Request - userID: " << userID << ", femalesOnly: " << femalesOnly 
-                  << ", user.gender: '" << user.gender << "'" << std::endl;
+            // Extract femalesOnly from request
+            bool femalesOnly = data.has("femalesOnly") ? data["femalesOnly"].b() : false;
+
+            // Riders without a departAt match rides at any time
+            int64_t departAt;
+            int departWindow;
+            if (!readDeparture(data, departAt, departWindow)) {
+                return crow::response(400, "Invalid departAt or windowMinutes");
+            }
         
-        // Pass femalesOnly to findMatchingRides
-        auto matches = dbManager.findMatchingRides(
-            data["from"].s(), 
-            data["to"].s(), 
-            rideType, 
-            userID, 
-            user.gender,
-            femalesOnly
-        );
+            // Matches, names and the display strings live in this thread's
+            // arena and are released together once the response is built
+            RequestArena& arena = RequestArena::local();
+            RequestArena::Scope arenaScope(arena);
+            std::string userGender(dbManager.getUserGender(userID, arena));
         
-        crow::json::wvalue res;
-        res["rideType"] = rideTypeToString(rideType);
+            LOG_DEBUG("Request - userID: " << userID << ", femalesOnly: " << femalesOnly
+                      << ", user.gender: '" << userGender << "'");
         
-        if (!matches.empty()) {
-            res["message"] = "Found existing matches";
-            res["matches"] = crow::json::wvalue::list();
-            
-            for (size_t i = 0; i < matches.size(); ++i) {
-                User leadUser = dbManager.getUserByID(matches[i].ownerID);
-                res["matches"][i]["rideID"] = matches[i].rideID;
-                res["matches"][i]["leadUserID"] = matches[i].ownerID;
-                res["matches"][i]["leadUserName"] = leadUser.name;
-                std::string display = leadUser.name + " - " + rideTypeToString(matches[i].rideType) + " - " + std::to_string(matches[i].getAvailableSlots()) + " seats";
-                res["matches"][i]["leadDisplay"] = display;
-                res["matches"][i]["from"] = matches[i].from;
-                res["matches"][i]["to"] = matches[i].to;
-                res["matches"][i]["time"] = matches[i].time;
-                res["matches"][i]["rideType"] = rideTypeToString(matches[i].rideType);
-                res["matches"][i]["availableSlots"] = matches[i].getAvailableSlots();
-            }
-        } else {
-            // Pass femalesOnly when recording request
-            dbManager.insertRequest(
-                data["userID"].s(), 
+            // Pass femalesOnly to findMatchingRides
+            auto matches = dbManager.findMatchingRideViews(
                 data["from"].s(), 
                 data["to"].s(), 
                 rideType, 
-                femalesOnly
+                userID, 
+                userGender,
+                femalesOnly,
+                arena,
+                departAt,
+                departWindow
             );
-
-            bool isSearchOnly = data.has("searchOnly") ? (data["searchOnly"].b()) : false;
-
-            if (!isSearchOnly) {
-                // Create ride with femalesOnly preference
-                Ride newRide(
+        
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().field("rideType", rideTypeToString(rideType));
+        
+            if (!matches.empty()) {
+                TRACE_SPAN("request.serializeMatches", "serialize");
+                json.field("message", "Found existing matches");
+                json.key("matches").beginArray();
+            
+                for (const auto& match : matches) {
+                    std::string_view leadName = dbManager.getUserName(match.ownerID, arena);
+                    std::pmr::string display(leadName, arena.resource());
+                    display.append(" - ").append(rideTypeToString(match.rideType)).append(" - ")
+                        .append(std::to_string(match.getAvailableSlots())).append(" seats");
+                    json.beginObject()
+                        .field("rideID", match.rideID)
+                        .field("leadUserID", match.ownerID)
+                        .field("leadUserName", leadName)
+                        .field("leadDisplay", std::string_view(display))
+                        .field("from", match.from)
+                        .field("to", match.to)
+                        .field("time", match.time)
+                        .field("departAt", match.departAt)
+                        .field("windowMinutes", match.departWindow / 60)
+                        .field("rideType", rideTypeToString(match.rideType))
+                        .field("availableSlots", match.getAvailableSlots())
+                        .endObject();
+                }
+                json.endArray();
+            } else {
+                // Pass femalesOnly when recording request
+                dbManager.insertRequest(
                     data["userID"].s(), 
                     data["from"].s(), 
                     data["to"].s(), 
-                    "now", 
-                    "request", 
                     rideType, 
                     femalesOnly
                 );
-                int rideID = dbManager.insertRide(newRide);
-                if (rideID != -1) {
-                    chatFeature->SetRideLead(rideID, data["userID"].s());
-                }
 
-                User leadUser = dbManager.getUserByID(data["userID"].s());
-                res["message"] = "You are now the lead";
-                res["rideID"] = rideID;
-                res["leadUserID"] = data["userID"].s();
-                res["leadUserName"] = leadUser.name;
-                res["matches"] = crow::json::wvalue::list();
-            } else {
-                res["message"] = "No matching requests found";
-                res["matches"] = crow::json::wvalue::list();
+                bool isSearchOnly = data.has("searchOnly") ? (data["searchOnly"].b()) : false;
+
+                if (!isSearchOnly) {
+                    // Create ride with femalesOnly preference, leaving when the
+                    // rider asked to (now, within the default window, if unset)
+                    Ride newRide(
+                        data["userID"].s(), 
+                        data["from"].s(), 
+                        data["to"].s(), 
+                        departAt ? "scheduled" : "now", 
+                        "request", 
+                        rideType, 
+                        femalesOnly
+                    );
+                    newRide.departAt = departAt ? departAt : static_cast<int64_t>(std::time(nullptr));
+                    newRide.departWindow = departWindow;
+                    int rideID = dbManager.insertRide(newRide);
+                    if (rideID != -1) {
+                        chatFeature->SetRideLead(rideID, data["userID"].s());
+                    }
+
+                    json.field("message", "You are now the lead")
+                        .field("rideID", rideID)
+                        .field("leadUserID", userID)
+                        .field("leadUserName", dbManager.getUserName(userID, arena));
+                    json.key("matches").beginArray().endArray();
+                } else {
+                    json.field("message", "No matching requests found");
+                    json.key("matches").beginArray().endArray();
+                }
             }
-        }
         
-        return crow::response(res);
+            json.endObject();
+            return jsonResponse(json);
+        });
     });
 
     // SEND JOIN REQUEST
     CROW_ROUTE(app, "/ride/request").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
-        int rideID = data["rideID"].i();
+            std::string userID = data["userID"].s();
+            int rideID = data["rideID"].i();
         
-        // Check if ride exists and is not started or completed
-        Ride ride = dbManager.getRideByID(rideID);
-        if (ride.rideID == 0) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["message"] = "Ride not found";
-            return crow::response(404, res);
-        }
+            // Check if ride exists and is not started or completed
+            Ride ride = dbManager.getRideByID(rideID);
+            if (ride.rideID == 0) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["message"] = "Ride not found";
+                return crow::response(404, res);
+            }
         
-        if (ride.status == RideStatus::STARTED || ride.status == RideStatus::COMPLETED) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["message"] = "Cannot join a ride that has already started or been completed";
-            return crow::response(400, res);
-        }
+            if (ride.status == RideStatus::STARTED || ride.status == RideStatus::COMPLETED ||
+                ride.status == RideStatus::EXPIRED) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["message"] = "Cannot join a ride that has already started, been completed or expired";
+                return crow::response(400, res);
+            }
         
-        if (dbManager.hasActiveRequest(userID)) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["message"] = "You already have a pending request";
-            return crow::response(res);
-        }
+            if (dbManager.hasActiveRequest(userID)) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["message"] = "You already have a pending request";
+                return crow::response(res);
+            }
         
-        bool success = dbManager.insertJoinRequest(rideID, userID);
+            bool success = dbManager.insertJoinRequest(rideID, userID);
         
-        crow::json::wvalue res;
-        res["success"] = success;
-        res["message"] = success ? "Request sent" : "Failed";
-        return crow::response(res);
+            crow::json::wvalue res;
+            res["success"] = success;
+            res["message"] = success ? "Request sent" : "Failed";
+            return crow::response(res);
+        });
     });
 
     // APPROVE/REJECT REQUEST
     CROW_ROUTE(app, "/ride/respond").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        int rideID = data["rideID"].i();
-        std::string userID = data["userID"].s();
-        bool accept = data["accept"].b();
+            int rideID = data["rideID"].i();
+            std::string userID = data["userID"].s();
+            bool accept = data["accept"].b();
         
-        std::string status = accept ? "accepted" : "rejected";
-        bool success = dbManager.updateJoinRequestStatus(rideID, userID, status);
+            std::string status = accept ? "accepted" : "rejected";
+            bool success = dbManager.updateJoinRequestStatus(rideID, userID, status);
         
-        if (success && accept) {
-            // Ensure chat lead is set for this ride (in case it wasn't set before)
-            Ride ride = dbManager.getRideByID(rideID);
-            if (!ride.ownerID.empty()) {
-                chatFeature->SetRideLead(rideID, ride.ownerID);
-            }
+            if (success && accept) {
+                // Ensure chat lead is set for this ride (in case it wasn't set before)
+                Ride ride = dbManager.getRideByID(rideID);
+                if (!ride.ownerID.empty()) {
+                    chatFeature->SetRideLead(rideID, ride.ownerID);
+                }
             
-            auto rides = dbManager.getAllRides();
-            for (const auto& rideItem : rides) {
-                if (rideItem.rideID == rideID) {
-                    int newCapacity = rideItem.currentCapacity + 1;
+                if (ride.rideID == rideID) {
+                    int newCapacity = ride.currentCapacity + 1;
                     dbManager.updateRideCapacityByID(rideID, newCapacity);
-                    if (newCapacity >= rideItem.maxCapacity) {
+                    if (newCapacity >= ride.maxCapacity) {
                         dbManager.updateRideStatus(rideID, "full");
                     }
-                    break;
                 }
             }
-        }
         
-        crow::json::wvalue res;
-        res["success"] = success;
-        res["message"] = success ? (accept ? "Approved" : "Rejected") : "Failed";
-        return crow::response(res);
+            crow::json::wvalue res;
+            res["success"] = success;
+            res["message"] = success ? (accept ? "Approved" : "Rejected") : "Failed";
+            return crow::response(res);
+        });
     });
 
     // GET RIDE REQUESTS
     CROW_ROUTE(app, "/ride/<int>/requests").methods("GET"_method)
-    ([&](int rideID) {
-        auto requests = dbManager.getPendingRequests(rideID);
-        crow::json::wvalue res;
-        res["requests"] = crow::json::wvalue::list();
-        
-        for (size_t i = 0; i < requests.size(); ++i) {
-            res["requests"][i]["userID"] = requests[i].first;
-            // Include the requester's username alongside their ID
-            User reqUser = dbManager.getUserByID(requests[i].first);
-            res["requests"][i]["userName"] = reqUser.name;
-            res["requests"][i]["timestamp"] = requests[i].second;
-        }
+    ([&](const crow::request &req, crow::response &res, int rideID) {
+        respondAsync(dbManager, res, [&, rideID]() -> crow::response {
+            std::string etag = versions.etag("ride", versions.rideVersion(rideID), true);
+            if (isNotModified(req, etag)) return notModified(etag);
+
+            // Requester names come from the same query, one row at a time
+            JoinRequestCursor requests = dbManager.scanPendingRequests(rideID);
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("requests").beginArray();
         
-        return crow::response(res);
+            while (requests.next()) {
+                json.beginObject()
+                    .field("userID", requests.userID())
+                    .field("userName", requests.userName())
+                    .field("timestamp", requests.timestamp())
+                    .endObject();
+            }
+        
+            json.endArray().endObject();
+            auto res = jsonResponse(json);
+            setETag(res, etag);
+            return res;
+        });
     });
 
     // CHAT SEND
     CROW_ROUTE(app, "/chat/send").methods("POST"_method)
-    ([&](const crow::request &req) {
-        auto data = crow::json::load(req.body);
-        if (!data) return crow::response(400, "Invalid JSON");
-
-        std::string sender = data["sender"].s();
-        std::string recipient = data["recipient"].s();
-        std::string text = data["text"].s();
-        int rideID = data["rideID"].i();
-
-        // Check if ride is completed - disable chat
-        Ride ride = dbManager.getRideByID(rideID);
-        if (ride.status == RideStatus::COMPLETED) {
-            crow::json::wvalue res;
-            res["success"] = false;
-            res["error"] = "Cannot send messages for a completed ride";
-            return crow::response(400, res);
-        }
+    ([&](const crow::request &req, crow::response &res) {
+        respondAsync(dbManager, res, [&]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
+
+            std::string sender = data["sender"].s();
+            std::string recipient = data["recipient"].s();
+            std::string text = data["text"].s();
+            int rideID = data["rideID"].i();
+
+            // Check if ride is completed or expired - disable chat
+            Ride ride = dbManager.getRideByID(rideID);
+            if (ride.status == RideStatus::COMPLETED || ride.status == RideStatus::EXPIRED) {
+                crow::json::wvalue res;
+                res["success"] = false;
+                res["error"] = "Cannot send messages for a completed ride";
+                return crow::response(400, res);
+            }
 
-        dbManager.insertMessage(sender, text);
+            dbManager.insertMessage(sender, text);
 
-        std::string err;
-        bool ok = chatFeature->AddMessage(sender, recipient, text, rideID, err);
-        crow::json::wvalue res;
-        res["success"] = ok;
-        res["error"] = err;
-        return crow::response(res);
+            std::string err;
+            bool ok = chatFeature->AddMessage(sender, recipient, text, rideID, err);
+            crow::json::wvalue res;
+            res["success"] = ok;
+            res["error"] = err;
+            return crow::response(res);
+        });
     });
 
     // CHAT GET BY RIDE
     CROW_ROUTE(app, "/chat/ride/<int>").methods("GET"_method)
-    ([&](int rideID) {
-        return crow::response(chatFeature->getRideMessagesJson(rideID));
+    ([&](const crow::request &req, int rideID) {
+        std::string etag = versions.etag("chat", versions.chatVersion(rideID));
+        if (isNotModified(req, etag)) return notModified(etag);
+
+        thread_local JsonWriter json;
+        json.clear();
+        chatFeature->writeRideMessagesJson(rideID, json);
+        auto res = jsonResponse(json);
+        setETag(res, etag);
+        return res;
     });
 
     // GET ACCEPTED REQUESTS FOR USER (for notifications)
     // DEBUG: Check user gender
     CROW_ROUTE(app, "/user/<string>/gender").methods("GET"_method)
-    ([&](const std::string& userID) {
-        User user = dbManager.getUserByID(userID);
-        crow::json::wvalue res;
-        res["userID"] = userID;
-        res["gender"] = user.gender;
-        res["canSeeFemalesOnly"] = (user.gender == "female");
-        return crow::response(res);
+    ([&](crow::response &res, const std::string& userID) {
+        respondAsync(dbManager, res, [&, userID]() -> crow::response {
+            User user = dbManager.getUserByID(userID);
+            crow::json::wvalue res;
+            res["userID"] = userID;
+            res["gender"] = user.gender;
+            res["canSeeFemalesOnly"] = (user.gender == "female");
+            return crow::response(res);
+        });
     });
 
     CROW_ROUTE(app, "/user/<string>/accepted-requests").methods("GET"_method)
-    ([&](const std::string& userID) {
-        auto accepted = dbManager.getAcceptedRequestsForUser(userID);
-        crow::json::wvalue res;
-        res["acceptedRequests"] = crow::json::wvalue::list();
-        
-        for (size_t i = 0; i < accepted.size(); ++i) {
-            int rideID = accepted[i].first;
-            std::string leadUserID = accepted[i].second;
+    ([&](const crow::request &req, crow::response &res, const std::string& userID) {
+        respondAsync(dbManager, res, [&, userID]() -> crow::response {
+            std::string etag = versions.etag("user", versions.userVersion(userID), true);
+            if (isNotModified(req, etag)) return notModified(etag);
+
+            auto accepted = dbManager.getAcceptedRequestsForUser(userID);
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("acceptedRequests").beginArray();
+        
+            for (const auto& item : accepted) {
+                int rideID = item.first;
+                const std::string& leadUserID = item.second;
             
-            // Get ride details
-            auto allRides = dbManager.getAllRides();
-            for (const auto& ride : allRides) {
-                if (ride.rideID == rideID) {
-                    User leadUser = dbManager.getUserByID(leadUserID);
-                    res["acceptedRequests"][i]["rideID"] = rideID;
-                    res["acceptedRequests"][i]["from"] = ride.from;
-                    res["acceptedRequests"][i]["to"] = ride.to;
-                    res["acceptedRequests"][i]["rideType"] = rideTypeToString(ride.rideType);
-                    res["acceptedRequests"][i]["leadUserID"] = leadUserID;
-                    res["acceptedRequests"][i]["leadUserName"] = leadUser.name;
-                    break;
-                }
+                // Get ride details
+                Ride ride = dbManager.getRideByID(rideID);
+                if (ride.rideID != rideID) continue;
+                User leadUser = dbManager.getUserByID(leadUserID);
+                json.beginObject()
+                    .field("rideID", rideID)
+                    .field("from", ride.from)
+                    .field("to", ride.to)
+                    .field("rideType", rideTypeToString(ride.rideType))
+                    .field("leadUserID", leadUserID)
+                    .field("leadUserName", leadUser.name)
+                    .endObject();
             }
-        }
         
-        return crow::response(res);
+            json.endArray().endObject();
+            auto res = jsonResponse(json);
+            setETag(res, etag);
+            return res;
+        });
+    });
+
+    // GET RIDE HISTORY FOR USER (owned or joined), newest first, paginated
+    CROW_ROUTE(app, "/user/<string>/rides").methods("GET"_method)
+    ([&](const crow::request &req, crow::response &res, const std::string& userID) {
+        respondAsync(dbManager, res, [&, userID]() -> crow::response {
+            std::string status = stringParam(req, "status");
+            if (!status.empty() && status != "open" && status != "full" &&
+                status != "started" && status != "completed") {
+                return crow::response(400, "Unknown ride status");
+            }
+            int cursor = intParam(req, "cursor", 0);
+            int limit = std::min(std::max(intParam(req, "limit", 20), 1), 100);
+
+            auto rides = dbManager.getUserRides(userID, status, cursor, limit + 1);
+            bool hasMore = static_cast<int>(rides.size()) > limit;
+            if (hasMore) rides.pop_back();
+
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("rides").beginArray();
+            for (const auto& item : rides) {
+                RideFragmentCache::writeRide(json, item.first, item.second);
+            }
+            json.endArray().key("nextCursor");
+            if (hasMore) json.value(rides.back().first.rideID);
+            else json.valueNull();
+            json.endObject();
+            return jsonResponse(json);
+        });
     });
 
     // GET ACCEPTED PASSENGERS FOR RIDE (for ride leads)
     CROW_ROUTE(app, "/ride/<int>/accepted").methods("GET"_method)
-    ([&](int rideID) {
-        auto passengers = dbManager.getAcceptedPassengers(rideID);
-        crow::json::wvalue res;
-        res["accepted"] = crow::json::wvalue::list();
-        
-        for (size_t i = 0; i < passengers.size(); ++i) {
-            res["accepted"][i]["userID"] = passengers[i].first;
-            res["accepted"][i]["userName"] = passengers[i].second;
-        }
+    ([&](const crow::request &req, crow::response &res, int rideID) {
+        respondAsync(dbManager, res, [&, rideID]() -> crow::response {
+            std::string etag = versions.etag("ride", versions.rideVersion(rideID), true);
+            if (isNotModified(req, etag)) return notModified(etag);
+
+            // Completed and expired rides may have moved to the archive;
+            // only a ride with no live row is read from there
+            bool archived = dbManager.getRideByID(rideID).rideID == 0;
+            JoinRequestCursor passengers = dbManager.scanAcceptedPassengers(rideID, archived);
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("accepted").beginArray();
+            while (passengers.next()) {
+                json.beginObject()
+                    .field("userID", passengers.userID())
+                    .field("userName", passengers.userName())
+                    .endObject();
+            }
         
-        return crow::response(res);
+            json.endArray().endObject();
+            auto res = jsonResponse(json);
+            setETag(res, etag);
+            return res;
+        });
     });
 
     // GET RIDE PARTICIPANTS (lead + accepted passengers) for chat
     CROW_ROUTE(app, "/ride/<int>/participants").methods("GET"_method)
-    ([&](int rideID) {
-        Ride ride = dbManager.getRideByID(rideID);
-        auto passengers = dbManager.getAcceptedPassengers(rideID);
-        crow::json::wvalue res;
-        res["participants"] = crow::json::wvalue::list();
-        
-        // Add ride lead
-        if (!ride.ownerID.empty()) {
-            User leadUser = dbManager.getUserByID(ride.ownerID);
-            res["participants"][0]["userID"] = ride.ownerID;
-            res["participants"][0]["userName"] = leadUser.name;
-            res["participants"][0]["isLead"] = true;
-        }
+    ([&](crow::response &res, int rideID) {
+        respondAsync(dbManager, res, [&, rideID]() -> crow::response {
+            Ride ride = dbManager.getRideByID(rideID);
+            bool archived = ride.rideID == 0;
+            if (archived) ride = dbManager.getArchivedRide(rideID);
+            thread_local JsonWriter json;
+            json.clear();
+            json.beginObject().key("participants").beginArray();
         
-        // Add accepted passengers
-        for (size_t i = 0; i < passengers.size(); ++i) {
-            res["participants"][i + 1]["userID"] = passengers[i].first;
-            res["participants"][i + 1]["userName"] = passengers[i].second;
-            res["participants"][i + 1]["isLead"] = false;
-        }
+            // Add ride lead
+            if (!ride.ownerID.empty()) {
+                User leadUser = dbManager.getUserByID(ride.ownerID);
+                json.beginObject()
+                    .field("userID", ride.ownerID)
+                    .field("userName", leadUser.name)
+                    .field("isLead", true)
+                    .endObject();
+            }
         
-        return crow::response(res);
+            // Add accepted passengers
+            JoinRequestCursor passengers = dbManager.scanAcceptedPassengers(rideID, archived);
+            while (passengers.next()) {
+                json.beginObject()
+                    .field("userID", passengers.userID())
+                    .field("userName", passengers.userName())
+                    .field("isLead", false)
+                    .endObject();
+            }
+        
+            json.endArray().endObject();
+            return jsonResponse(json);
+        });
     });
 
     // START RIDE (only for lead)
     CROW_ROUTE(app, "/ride/<int>/start").methods("POST"_method)
     ([&](const crow::request &req, crow::response &res, int rideID) {
-        auto data = crow::json::load(req.body);
-        if (!data) {
-            res.code = 400;
-            res.body = "Invalid JSON";
-            res.end();
-            return;
-        }
+        respondAsync(dbManager, res, [&, rideID]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
-        Ride ride = dbManager.getRideByID(rideID);
-        
-        if (ride.rideID == 0) {
-            crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Ride not found";
-            res.code = 404;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        if (ride.ownerID != userID) {
-            crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Only the ride lead can start the ride";
-            res.code = 403;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        if (ride.status == RideStatus::STARTED) {
-            crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Ride is already started";
-            res.code = 400;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        if (ride.status == RideStatus::COMPLETED) {
+            std::string userID = data["userID"].s();
+            Ride ride = dbManager.getRideByID(rideID);
+            
             crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Cannot start a completed ride";
-            res.code = 400;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        bool success = dbManager.updateRideStatus(rideID, "started");
-        
-        crow::json::wvalue result;
-        result["success"] = success;
-        result["message"] = success ? "Ride started successfully" : "Failed to start ride";
-        res.body = result.dump();
-        res.end();
+            if (ride.rideID == 0) {
+                result["success"] = false;
+                result["error"] = "Ride not found";
+                return crow::response(404, result);
+            }
+            
+            if (ride.ownerID != userID) {
+                result["success"] = false;
+                result["error"] = "Only the ride lead can start the ride";
+                return crow::response(403, result);
+            }
+            
+            if (ride.status == RideStatus::STARTED) {
+                result["success"] = false;
+                result["error"] = "Ride is already started";
+                return crow::response(400, result);
+            }
+            
+            if (ride.status == RideStatus::COMPLETED) {
+                result["success"] = false;
+                result["error"] = "Cannot start a completed ride";
+                return crow::response(400, result);
+            }
+
+            if (ride.status == RideStatus::EXPIRED) {
+                result["success"] = false;
+                result["error"] = "Cannot start an expired ride";
+                return crow::response(400, result);
+            }
+            
+            bool success = dbManager.updateRideStatus(rideID, "started");
+            
+            result["success"] = success;
+            result["message"] = success ? "Ride started successfully" : "Failed to start ride";
+            return crow::response(result);
+        });
     });
 
     // END RIDE (only for lead)
     CROW_ROUTE(app, "/ride/<int>/end").methods("POST"_method)
     ([&](const crow::request &req, crow::response &res, int rideID) {
-        auto data = crow::json::load(req.body);
-        if (!data) {
-            res.code = 400;
-            res.body = "Invalid JSON";
-            res.end();
-            return;
-        }
+        respondAsync(dbManager, res, [&, rideID]() -> crow::response {
+            auto data = crow::json::load(req.body);
+            if (!data) return crow::response(400, "Invalid JSON");
 
-        std::string userID = data["userID"].s();
-        Ride ride = dbManager.getRideByID(rideID);
-        
-        if (ride.rideID == 0) {
-            crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Ride not found";
-            res.code = 404;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        if (ride.ownerID != userID) {
-            crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Only the ride lead can end the ride";
-            res.code = 403;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        if (ride.status == RideStatus::COMPLETED) {
+            std::string userID = data["userID"].s();
+            Ride ride = dbManager.getRideByID(rideID);
+            
             crow::json::wvalue result;
-            result["success"] = false;
-            result["error"] = "Ride is already completed";
-            res.code = 400;
-            res.body = result.dump();
-            res.end();
-            return;
-        }
-        
-        bool success = dbManager.updateRideStatus(rideID, "completed");
-        
-        crow::json::wvalue result;
-        result["success"] = success;
-        result["message"] = success ? "Ride ended successfully" : "Failed to end ride";
-        res.body = result.dump();
-        res.end();
+            if (ride.rideID == 0) {
+                result["success"] = false;
+                result["error"] = "Ride not found";
+                return crow::response(404, result);
+            }
+            
+            if (ride.ownerID != userID) {
+                result["success"] = false;
+                result["error"] = "Only the ride lead can end the ride";
+                return crow::response(403, result);
+            }
+            
+            if (ride.status == RideStatus::COMPLETED) {
+                result["success"] = false;
+                result["error"] = "Ride is already completed";
+                return crow::response(400, result);
+            }
+
+            if (ride.status == RideStatus::EXPIRED) {
+                result["success"] = false;
+                result["error"] = "Ride expired without starting";
+                return crow::response(400, result);
+            }
+            
+            bool success = dbManager.updateRideStatus(rideID, "completed");
+            
+            result["success"] = success;
+            result["message"] = success ? "Ride ended successfully" : "Failed to end ride";
+            return crow::response(result);
+        });
     });
 
+    maintenance.start();
     app.port(8080).multithreaded().run();
+    maintenance.stop(); // its slices run on the DB pool
+    authPool.shutdown();
+    dbPool.shutdown();
+    curl_global_cleanup();
+    Tracer::instance().close();
+    Logger::instance().stop();
 }
\ No newline at end of file
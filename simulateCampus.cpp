@@ -0,0 +1,474 @@
+// Deterministic discrete-event simulation of one campus day.
+//
+// Students arrive on a virtual clock (a morning inbound wave, spikes at
+// each class dismissal and a small background rate) and go through the
+// same DatabaseManager calls the HTTP handlers make: findMatchingRides,
+// then either a join request the lead answers after a delay, or a new ride
+// they lead until it departs. Nothing sleeps, so a whole day runs in
+// seconds, and the same seed always replays the same day.
+//
+// Usage: uniride_sim [--students N] [--seed N] [--policy first|fullest|emptiest]
+//                    [--areas areas.db] [--db :memory:]
+#include "DatabaseManager.h"
+#include "LocationGraph.h"
+#include "Logger.h"
+#include "MatchingEngine.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const char* CAMPUS = "NED Campus";
+const double DAY_START = 6 * 3600.0;
+const double DAY_END = 22 * 3600.0;
+const int HOURS = 16;
+
+struct Options {
+    int students = 3000;
+    unsigned seed = 42;
+    std::string policy = "first";
+    std::string areasPath = "areas.db";
+    std::string dbPath = ":memory:";
+    double responseMean = 90.0;   // seconds for a lead to answer a join request
+    double leadWaitMin = 300.0;   // a new lead waits this long (uniform) before leaving
+    double leadWaitMax = 900.0;
+    int maxAttempts = 3;          // searches before a student gives up and travels alone
+};
+
+struct Student {
+    std::string userID;
+    std::string gender;
+    size_t home;
+    RideType rideType;
+    bool femalesOnly;
+    bool onCampus = false;
+    bool busy = false;
+};
+
+struct Trip {
+    int student;
+    bool toCampus;
+    double arrival;
+    double matchedAt = -1.0;
+    int rideID = 0;
+    bool lead = false;
+    int attempts = 0;
+};
+
+struct SimRide {
+    int leadTrip = -1;
+    int seats = 0;
+    int occupied = 1;
+    bool departed = false;
+    std::vector<int> passengers;
+    std::vector<int> pending;
+};
+
+enum class EventType { Arrival, Response, Departure, Complete };
+
+struct Event {
+    double time;
+    uint64_t seq; // insertion order breaks ties, keeping runs deterministic
+    EventType type;
+    int trip;
+    int rideID;
+    bool operator>(const Event& other) const {
+        return time != other.time ? time > other.time : seq > other.seq;
+    }
+};
+
+struct HourStats {
+    long arrivals = 0;
+    long matched = 0;
+    long alone = 0;
+    std::vector<double> waits;
+    long seatsOffered = 0;
+    long seatsFilled = 0;
+    long departures = 0;
+    double cpuMillis = 0;
+};
+
+int hourOf(double t) {
+    return std::clamp(static_cast<int>((t - DAY_START) / 3600.0), 0, HOURS - 1);
+}
+
+double gaussian(double t, double mean, double sigma) {
+    double z = (t - mean) / sigma;
+    return std::exp(-0.5 * z * z) / (sigma * std::sqrt(2 * M_PI));
+}
+
+class Simulation {
+private:
+    const Options& opt;
+    DatabaseManager& db;
+    std::mt19937 rng;
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::vector<std::string> areas;
+    std::vector<Student> students;
+    std::vector<Trip> trips;
+    std::unordered_map<int, SimRide> rides;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    uint64_t nextSeq = 0;
+    HourStats hours[HOURS];
+    int64_t dayEpoch = std::time(nullptr) / 86400 * 86400; // unix time of simulated midnight
+
+    void schedule(double time, EventType type, int trip, int rideID = 0) {
+        events.push({time, nextSeq++, type, trip, rideID});
+    }
+
+    // Arrivals per second heading to (inbound) and from (outbound) campus
+    double inboundRate(double t) const {
+        return opt.students * (0.85 * gaussian(t, 8 * 3600.0, 2700.0) + 0.05 / 57600.0);
+    }
+    double outboundRate(double t) const {
+        static const double dismissals[][2] = {{11.5, 0.15}, {13.5, 0.3}, {15.5, 0.3}, {17.5, 0.15}};
+        double rate = 0.05 / 57600.0;
+        for (const auto& d : dismissals) rate += d[1] * gaussian(t, d[0] * 3600.0, 900.0);
+        return opt.students * rate;
+    }
+
+    // A free student on the right side of the campus gate, or -1
+    int pickStudent(bool toCampus) {
+        std::uniform_int_distribution<int> any(0, static_cast<int>(students.size()) - 1);
+        for (int attempt = 0; attempt < 32; ++attempt) {
+            int s = any(rng);
+            if (!students[s].busy && students[s].onCampus != toCampus) return s;
+        }
+        return -1;
+    }
+
+    const Ride* choose(const std::vector<Ride>& matches) const {
+        if (matches.empty()) return nullptr;
+        if (opt.policy == "fullest") {
+            return &*std::min_element(matches.begin(), matches.end(), [](const Ride& a, const Ride& b) {
+                return a.getAvailableSlots() < b.getAvailableSlots();
+            });
+        }
+        if (opt.policy == "emptiest") {
+            return &*std::max_element(matches.begin(), matches.end(), [](const Ride& a, const Ride& b) {
+                return a.getAvailableSlots() < b.getAvailableSlots();
+            });
+        }
+        return &matches.front(); // what the client shows first
+    }
+
+    void search(int tripIndex, double now) {
+        Trip& trip = trips[tripIndex];
+        Student& student = students[trip.student];
+        const std::string& home = areas[student.home];
+        const std::string& from = trip.toCampus ? home : CAMPUS;
+        const std::string& to = trip.toCampus ? CAMPUS : home;
+        trip.attempts++;
+
+        auto matches = db.findMatchingRides(from, to, student.rideType, student.userID, student.gender,
+                                            student.femalesOnly);
+        // Only rides this run created; a --db file may hold older open rides
+        matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                     [this](const Ride& r) { return rides.count(r.rideID) == 0; }),
+                      matches.end());
+        if (const Ride* ride = choose(matches)) {
+            db.insertJoinRequest(ride->rideID, student.userID);
+            rides[ride->rideID].pending.push_back(tripIndex);
+            std::exponential_distribution<double> response(1.0 / opt.responseMean);
+            schedule(now + response(rng), EventType::Response, tripIndex, ride->rideID);
+            return;
+        }
+
+        // No match: become the lead of a new ride, as /request/create does
+        // Riders give no departAt, so the ride leaves now within the default window
+        Ride newRide(student.userID, from, to, "now", "request", student.rideType, student.femalesOnly);
+        newRide.departAt = dayEpoch + static_cast<int64_t>(now);
+        newRide.departWindow = DEFAULT_DEPART_WINDOW;
+        int rideID = db.insertRide(newRide);
+        if (rideID == -1) return;
+        trip.lead = true;
+        trip.rideID = rideID;
+        SimRide& simRide = rides[rideID];
+        simRide.leadTrip = tripIndex;
+        simRide.seats = newRide.maxCapacity;
+        std::uniform_real_distribution<double> wait(opt.leadWaitMin, opt.leadWaitMax);
+        schedule(now + wait(rng), EventType::Departure, tripIndex, rideID);
+    }
+
+    void retryOrGiveUp(int tripIndex, double now) {
+        Trip& trip = trips[tripIndex];
+        if (trip.attempts < opt.maxAttempts) {
+            schedule(now + 30.0, EventType::Arrival, tripIndex);
+        } else {
+            hours[hourOf(trip.arrival)].alone++;
+            schedule(now + 1800.0, EventType::Complete, tripIndex);
+        }
+    }
+
+    void respond(int tripIndex, int rideID, double now) {
+        auto found = rides.find(rideID);
+        if (found == rides.end()) return;
+        SimRide& ride = found->second;
+        auto it = std::find(ride.pending.begin(), ride.pending.end(), tripIndex);
+        if (it == ride.pending.end()) return; // already rejected at departure
+        ride.pending.erase(it);
+
+        Trip& trip = trips[tripIndex];
+        const std::string& userID = students[trip.student].userID;
+        if (ride.departed || ride.occupied >= ride.seats) {
+            db.updateJoinRequestStatus(rideID, userID, "rejected");
+            retryOrGiveUp(tripIndex, now);
+            return;
+        }
+
+        // Same sequence as /ride/respond
+        db.updateJoinRequestStatus(rideID, userID, "accepted");
+        ride.occupied++;
+        db.updateRideCapacityByID(rideID, ride.occupied);
+        if (ride.occupied >= ride.seats) db.updateRideStatus(rideID, "full");
+        ride.passengers.push_back(tripIndex);
+        trip.rideID = rideID;
+        trip.matchedAt = now;
+        Trip& lead = trips[ride.leadTrip];
+        if (lead.matchedAt < 0) lead.matchedAt = now;
+    }
+
+    void depart(int rideID, double now) {
+        SimRide& ride = rides[rideID];
+        ride.departed = true;
+        db.updateRideStatus(rideID, "started");
+
+        HourStats& hour = hours[hourOf(now)];
+        hour.departures++;
+        hour.seatsOffered += ride.seats;
+        hour.seatsFilled += ride.occupied;
+
+        for (int pendingTrip : ride.pending) {
+            db.updateJoinRequestStatus(rideID, students[trips[pendingTrip].student].userID, "rejected");
+            retryOrGiveUp(pendingTrip, now);
+        }
+        ride.pending.clear();
+
+        std::vector<int> riders = ride.passengers;
+        riders.push_back(ride.leadTrip);
+        for (int riderTrip : riders) {
+            const Trip& trip = trips[riderTrip];
+            HourStats& arrivalHour = hours[hourOf(trip.arrival)];
+            if (trip.matchedAt >= 0) {
+                arrivalHour.matched++;
+                arrivalHour.waits.push_back(trip.matchedAt - trip.arrival);
+            } else {
+                arrivalHour.alone++;
+            }
+        }
+        std::uniform_real_distribution<double> travel(1200.0, 2700.0);
+        schedule(now + travel(rng), EventType::Complete, ride.leadTrip, rideID);
+    }
+
+    void complete(int tripIndex, int rideID, double now) {
+        (void)now;
+        std::vector<int> riders{tripIndex};
+        if (rideID != 0) {
+            db.updateRideStatus(rideID, "completed");
+            const SimRide& ride = rides[rideID];
+            riders.insert(riders.end(), ride.passengers.begin(), ride.passengers.end());
+            rides.erase(rideID);
+        }
+        for (int riderTrip : riders) {
+            Student& student = students[trips[riderTrip].student];
+            student.onCampus = trips[riderTrip].toCampus;
+            student.busy = false;
+        }
+    }
+
+    // Non-homogeneous Poisson arrivals by thinning against a constant bound
+    void scheduleArrivals() {
+        double peak = 0;
+        for (double t = DAY_START; t < DAY_END; t += 60.0) peak = std::max(peak, inboundRate(t) + outboundRate(t));
+        peak *= 1.05;
+        std::exponential_distribution<double> gap(peak);
+        for (double t = DAY_START + gap(rng); t < DAY_END; t += gap(rng)) {
+            double in = inboundRate(t), out = outboundRate(t);
+            if (unit(rng) * peak >= in + out) continue;
+            bool toCampus = unit(rng) * (in + out) < in;
+            schedule(t, EventType::Arrival, -1, toCampus ? 1 : 0);
+        }
+    }
+
+public:
+    Simulation(const Options& options, DatabaseManager& database)
+        : opt(options), db(database), rng(options.seed) {}
+
+    bool setup(std::vector<std::string> areaNames) {
+        areas = std::move(areaNames);
+        if (areas.empty()) return false;
+
+        // Rank-weighted home areas so a few neighbourhoods dominate
+        std::vector<double> weights(areas.size());
+        std::vector<size_t> rank(areas.size());
+        for (size_t i = 0; i < rank.size(); ++i) rank[i] = i;
+        std::shuffle(rank.begin(), rank.end(), rng);
+        for (size_t i = 0; i < areas.size(); ++i) weights[i] = 1.0 / (1.0 + rank[i]);
+        std::discrete_distribution<size_t> homeDist(weights.begin(), weights.end());
+        std::discrete_distribution<int> typeDist({30, 50, 20});
+
+        for (int i = 0; i < opt.students; ++i) {
+            Student s;
+            s.userID = "sim" + std::to_string(i);
+            s.gender = unit(rng) < 0.4 ? "female" : "male";
+            s.home = homeDist(rng);
+            s.rideType = static_cast<RideType>(typeDist(rng));
+            s.femalesOnly = s.gender == "female" && unit(rng) < 0.3;
+            User user(s.userID, "Sim Student " + std::to_string(i), s.userID + "@cloud.neduet.edu.pk", s.gender);
+            if (!db.insertUser(user)) return false;
+            students.push_back(s);
+        }
+        scheduleArrivals();
+        return true;
+    }
+
+    void run() {
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            std::clock_t cpuStart = std::clock();
+
+            switch (event.type) {
+                case EventType::Arrival: {
+                    int tripIndex = event.trip;
+                    if (tripIndex < 0) {
+                        bool toCampus = event.rideID == 1;
+                        int s = pickStudent(toCampus);
+                        if (s < 0) break;
+                        students[s].busy = true;
+                        tripIndex = static_cast<int>(trips.size());
+                        trips.push_back(Trip{s, toCampus, event.time});
+                        hours[hourOf(event.time)].arrivals++;
+                    }
+                    search(tripIndex, event.time);
+                    break;
+                }
+                case EventType::Response: respond(event.trip, event.rideID, event.time); break;
+                case EventType::Departure: depart(event.rideID, event.time); break;
+                case EventType::Complete: complete(event.trip, event.rideID, event.time); break;
+            }
+
+            hours[hourOf(event.time)].cpuMillis += 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        }
+    }
+
+    void report(std::ostream& out, double wallSeconds) {
+        auto percentile = [](std::vector<double>& values, double p) {
+            if (values.empty()) return 0.0;
+            size_t index = static_cast<size_t>(p * (values.size() - 1));
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            return values[index];
+        };
+
+        HourStats total;
+        char line[160];
+        out << "hour   arrivals  match%  wait_p50_s  wait_p95_s  seat_util%  departures  cpu_ms\n";
+        for (int h = 0; h < HOURS; ++h) {
+            HourStats& s = hours[h];
+            long resolved = s.matched + s.alone;
+            std::snprintf(line, sizeof(line), "%02d:00  %8ld  %6.1f  %10.0f  %10.0f  %10.1f  %10ld  %6.0f\n",
+                          6 + h, s.arrivals, resolved ? 100.0 * s.matched / resolved : 0.0,
+                          percentile(s.waits, 0.5), percentile(s.waits, 0.95),
+                          s.seatsOffered ? 100.0 * s.seatsFilled / s.seatsOffered : 0.0, s.departures, s.cpuMillis);
+            out << line;
+            total.arrivals += s.arrivals;
+            total.matched += s.matched;
+            total.alone += s.alone;
+            total.waits.insert(total.waits.end(), s.waits.begin(), s.waits.end());
+            total.seatsOffered += s.seatsOffered;
+            total.seatsFilled += s.seatsFilled;
+            total.departures += s.departures;
+            total.cpuMillis += s.cpuMillis;
+        }
+        long resolved = total.matched + total.alone;
+        std::snprintf(line, sizeof(line), "day    %8ld  %6.1f  %10.0f  %10.0f  %10.1f  %10ld  %6.0f\n",
+                      total.arrivals, resolved ? 100.0 * total.matched / resolved : 0.0,
+                      percentile(total.waits, 0.5), percentile(total.waits, 0.95),
+                      total.seatsOffered ? 100.0 * total.seatsFilled / total.seatsOffered : 0.0, total.departures,
+                      total.cpuMillis);
+        out << line;
+        out << "policy " << opt.policy << ", seed " << opt.seed << ", " << students.size() << " students, "
+            << db.queryCount() << " SQL statements, wall " << wallSeconds << " s" << std::endl;
+    }
+};
+
+std::vector<std::string> loadAreas(const std::string& path) {
+    std::vector<std::string> names;
+    sqlite3* areasDb = nullptr;
+    if (sqlite3_open_v2(path.c_str(), &areasDb, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        sqlite3_close(areasDb);
+        return names;
+    }
+    sqlite3_stmt* stmt = nullptr;
+    const char* sql = "SELECT area1 FROM edges UNION SELECT area2 FROM edges ORDER BY 1;";
+    if (sqlite3_prepare_v2(areasDb, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            if (name != CAMPUS) names.push_back(name);
+        }
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(areasDb);
+    return names;
+}
+
+bool parseArgs(int argc, char** argv, Options& opt) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i], value = argv[i + 1];
+        try {
+            if (arg == "--students") opt.students = std::stoi(value);
+            else if (arg == "--seed") opt.seed = static_cast<unsigned>(std::stoul(value));
+            else if (arg == "--policy") opt.policy = value;
+            else if (arg == "--areas") opt.areasPath = value;
+            else if (arg == "--db") opt.dbPath = value;
+            else return false;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    bool knownPolicy = opt.policy == "first" || opt.policy == "fullest" || opt.policy == "emptiest";
+    return argc % 2 == 1 && opt.students > 0 && knownPolicy;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " [--students N] [--seed N] [--policy first|fullest|emptiest]"
+                  << " [--areas areas.db] [--db :memory:]" << std::endl;
+        return 1;
+    }
+    Logger::setLevel(LogLevel::Warn);
+
+    std::vector<std::string> areaNames = loadAreas(opt.areasPath);
+    if (areaNames.empty()) {
+        std::cerr << "No areas in " << opt.areasPath << " (run buildGraph or uniride_datagen first)" << std::endl;
+        return 1;
+    }
+
+    LocationGraph graph;
+    DatabaseManager db(opt.dbPath);
+    if (!graph.loadFromDatabase(opt.areasPath) || !db.initialize()) return 1;
+    db.setLocationGraph(&graph);
+    OpenRideTable openRides(graph);
+    MatchingEngine matcher(openRides);
+    db.setMatchingEngine(&matcher); // same matching path as the server
+
+    auto start = std::chrono::steady_clock::now();
+    Simulation sim(opt, db);
+    if (!sim.setup(std::move(areaNames))) return 1;
+    sim.run();
+    sim.report(std::cout, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    return 0;
+}